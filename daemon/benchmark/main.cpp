@@ -0,0 +1,46 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <benchmark/benchmark.h>
+
+// logger.h has no levels, daemon code logs straight to std::cout. Results go to
+// their own stream on stdout, std::cout is muted while benchmarks run. Errors
+// still appear on std::cerr.
+int main(int argc, char** argv) {
+	benchmark::Initialize(&argc, argv);
+	if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+		return 1;
+	}
+	std::streambuf* stdoutBuffer = std::cout.rdbuf();
+	std::ostream results(stdoutBuffer);
+	benchmark::BenchmarkReporter* reporter = benchmark::CreateDefaultDisplayReporter();
+	reporter->SetOutputStream(&results);
+	std::cout.rdbuf(NULL);
+	benchmark::RunSpecifiedBenchmarks(reporter);
+	std::cout.rdbuf(stdoutBuffer);
+	std::cout.clear();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <benchmark/benchmark.h>
+#include <ProcFile.h>
+#include "ProcStat.h"
+
+using namespace std;
+
+// Former SensorProviderSystem implementation, kept as reference
+static void BM_CpuStatIfstream(benchmark::State& state) {
+	for (auto _ : state) {
+		uint64_t totalTime = 0;
+		uint64_t workTime = 0;
+		string line;
+		ifstream myfile("/proc/stat");
+		getline(myfile, line);
+		std::istringstream stream(line);
+		stream.ignore(3, ' ');
+		for (uint8_t i = 0; i < 10; ++i) {
+			uint64_t n;
+			stream >> n;
+			if (!stream) {
+				break;
+			}
+			if (i < 3) {
+				workTime += n;
+			}
+			totalTime += n;
+		}
+		benchmark::DoNotOptimize(workTime);
+		benchmark::DoNotOptimize(totalTime);
+	}
+}
+BENCHMARK(BM_CpuStatIfstream);
+
+// Parses the aggregate line, all cpu<n> lines, ctxt and processes
+static void BM_CpuStatProcStat(benchmark::State& state) {
+	ProcStat* stat = new ProcStat(sysconf(_SC_NPROCESSORS_CONF));
+	stat->acquire();
+	uint32_t seenGeneration = 0;
+	for (auto _ : state) {
+		// Every update reads, as the benchmark is the only consumer
+		stat->update(seenGeneration);
+		uint64_t delta[ProcStat::FIELD_COUNT];
+		uint64_t total;
+		benchmark::DoNotOptimize(stat->getCpuDelta(0, delta, total));
+	}
+	stat->release();
+}
+BENCHMARK(BM_CpuStatProcStat);
+
+static void BM_MemInfoIfstream(benchmark::State& state) {
+	for (auto _ : state) {
+		uint64_t freeMem = 0;
+		string line;
+		ifstream myfile("/proc/meminfo");
+		while (getline(myfile, line)) {
+			std::istringstream stream(line);
+			string prefix;
+			stream >> prefix;
+			if (prefix == "MemAvailable:") {
+				stream >> freeMem;
+			}
+		}
+		benchmark::DoNotOptimize(freeMem);
+	}
+}
+BENCHMARK(BM_MemInfoIfstream);
+
+static void BM_MemInfoProcFile(benchmark::State& state) {
+	ProcFile file("/proc/meminfo");
+	for (auto _ : state) {
+		uint64_t freeMem = 0;
+		file.read();
+		const char* p = file.data();
+		if (procFindLine(p, file.end(), "MemAvailable:")) {
+			procScanUint64(p, file.end(), freeMem);
+		}
+		benchmark::DoNotOptimize(freeMem);
+	}
+}
+BENCHMARK(BM_MemInfoProcFile);
@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <benchmark/benchmark.h>
+#include <RawSensorProvider.h>
+#include <SensorBean.h>
+#include "daemon/src/Config.h"
+#include "daemon/src/JSONSensorsParser.h"
+#include "daemon/src/SensorSet.h"
+#include "daemon/src/ini_manage.h"
+#include "daemon/src/json.h"
+
+using namespace std;
+
+#define SENSOR_GROUPS		10
+#define MAX_MESSAGE_SIZE	4096
+
+// Synthetic sensors: alternating double and U32 values, spread over groups
+static string buildDescription(int count) {
+	ostringstream description;
+	description << "[";
+	for (int i = 0; i < count; ++i) {
+		description << (i > 0 ? "," : "") << "{\"name\":\"Sensor " << i << "\",\"dataType\":\"" << (i % 2 == 0 ? "double" : "U32")
+			<< "\",\"unit\":\"W\",\"group\":\"Group " << i % SENSOR_GROUPS << "\"}";
+	}
+	description << "]";
+	return description.str();
+}
+
+static string buildData(int count) {
+	ostringstream data;
+	data << "[";
+	for (int i = 0; i < count; ++i) {
+		data << (i > 0 ? "," : "");
+		if (i % 2 == 0) {
+			data << i << ".5";
+		} else {
+			data << i;
+		}
+	}
+	data << "]";
+	return data.str();
+}
+
+class MockJSONSensorProvider: public IJSONSensorProvider {
+public:
+	explicit MockJSONSensorProvider(int count) : mDescription(buildDescription(count)), mData(buildData(count)) {
+	}
+
+	const char* getSensorsDescription(void) {
+		return mDescription.c_str();
+	}
+
+	const char* getSensorsData(void) {
+		return mData.c_str();
+	}
+
+private:
+	string mDescription;
+	string mData;
+};
+
+class MockRawSensorProvider: public RawSensorProvider {
+public:
+	explicit MockRawSensorProvider(int count) : mDescription(buildDescription(count)), mCount(count), mSeq(0) {
+	}
+
+	const char* getSensorsDescription(void) {
+		return mDescription.c_str();
+	}
+
+	size_t getRecordSize(void) {
+		return (mCount / 2 + mCount % 2) * 8 + (mCount / 2) * 4;
+	}
+
+	uint64_t readLatest(uint8_t* buffer) {
+		memset(buffer, 0, getRecordSize());
+		return ++mSeq;
+	}
+
+private:
+	string mDescription;
+	int mCount;
+	uint64_t mSeq;
+};
+
+static void BM_SensorSetGetMessageJSON(benchmark::State& state) {
+	SensorSet sensors;
+	sensors.addJSONSensorProvider(new MockJSONSensorProvider(state.range(0)), "Mock");
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(sensors.getMessage());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SensorSetGetMessageJSON)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_SensorSetGetMessageRaw(benchmark::State& state) {
+	SensorSet sensors;
+	sensors.addJSONSensorProvider(new MockRawSensorProvider(state.range(0)), "Mock");
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(sensors.getMessage());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SensorSetGetMessageRaw)->RangeMultiplier(10)->Range(10, 10000);
+
+// All pages of the description, as fetched by management after a change
+static void BM_SensorSetGetDescriptionPage(benchmark::State& state) {
+	SensorSet sensors;
+	sensors.addJSONSensorProvider(new MockJSONSensorProvider(state.range(0)), "Mock");
+	sensors.getMessage();
+	uint8_t buffer[MAX_MESSAGE_SIZE];
+	for (auto _ : state) {
+		uint8_t maxPages = 1;
+		for (uint8_t page = 1; page <= maxPages; ++page) {
+			benchmark::DoNotOptimize(sensors.getDescriptionPage(buffer, sizeof(buffer), page, &maxPages));
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SensorSetGetDescriptionPage)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_JSONSensorsParserUpdateSensors(benchmark::State& state) {
+	JSONSensorsParser parser(new MockJSONSensorProvider(state.range(0)), "Mock");
+	JSONSensorsParser::SensorsMap map = parser.getSensors();
+	for (auto _ : state) {
+		parser.updateSensors();
+	}
+	for (JSONSensorsParser::SensorsMap::iterator iterator = map.begin(); iterator != map.end(); ++iterator) {
+		delete iterator->second;
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_JSONSensorsParserUpdateSensors)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_JsonDeserializeData(benchmark::State& state) {
+	string data = buildData(state.range(0));
+	for (auto _ : state) {
+		json::Value value = json::Deserialize(data);
+		benchmark::DoNotOptimize(value.size());
+	}
+	state.SetBytesProcessed(state.iterations() * data.length());
+}
+BENCHMARK(BM_JsonDeserializeData)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_JsonDeserializeDescription(benchmark::State& state) {
+	string description = buildDescription(state.range(0));
+	for (auto _ : state) {
+		json::Value value = json::Deserialize(description);
+		benchmark::DoNotOptimize(value.size());
+	}
+	state.SetBytesProcessed(state.iterations() * description.length());
+}
+BENCHMARK(BM_JsonDeserializeDescription)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_SensorBeanSetDataString(benchmark::State& state) {
+	SensorBean sensor("Sensor", TYPE_STR, 32, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	string value("192.168.0.1");
+	for (auto _ : state) {
+		sensor.setData(value);
+	}
+}
+BENCHMARK(BM_SensorBeanSetDataString);
+
+static void BM_SensorBeanSetDataU32(benchmark::State& state) {
+	SensorBean sensor("Sensor", TYPE_U32, 4, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	uint32_t value = 0;
+	for (auto _ : state) {
+		sensor.setData(value++);
+	}
+}
+BENCHMARK(BM_SensorBeanSetDataU32);
+
+static void BM_SensorBeanSetDataU64(benchmark::State& state) {
+	SensorBean sensor("Sensor", TYPE_U64, 8, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	uint64_t value = 0;
+	for (auto _ : state) {
+		sensor.setData(value++);
+	}
+}
+BENCHMARK(BM_SensorBeanSetDataU64);
+
+static void BM_SensorBeanSetDataDouble(benchmark::State& state) {
+	SensorBean sensor("Sensor", TYPE_FLOAT, 8, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	double value = 0.0;
+	for (auto _ : state) {
+		sensor.setData(value);
+		value += 0.5;
+	}
+}
+BENCHMARK(BM_SensorBeanSetDataDouble);
+
+// Reads conf/recsdaemon.ini of the working directory, if there is none all lookups miss
+static void BM_ConfigGetInt(benchmark::State& state) {
+	Config* config = Config::GetInstance();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(config->GetInt("Update", "updateInterval", 1000));
+	}
+}
+BENCHMARK(BM_ConfigGetInt);
+
+static void BM_ConfigGetIntMissing(benchmark::State& state) {
+	Config* config = Config::GetInstance();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(config->GetInt("Benchmark", "missing", 1000));
+	}
+}
+BENCHMARK(BM_ConfigGetIntMissing);
+
+static void BM_IniGetValue(benchmark::State& state) {
+	Config::GetInstance();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(get_value("Update", "updateInterval"));
+	}
+}
+BENCHMARK(BM_IniGetValue);
+
+// As done by sensor plugins in configure()
+static void BM_BaseSensorExtractParam(benchmark::State& state) {
+	SensorBean sensor("Sensor", TYPE_U8, 1, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	string options("path=/sys/class/thermal/thermal_zone0/temp type=U32 divider=1000,group=Temperatures");
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(sensor.getOption(options, "divider"));
+	}
+}
+BENCHMARK(BM_BaseSensorExtractParam);
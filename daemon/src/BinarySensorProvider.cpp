@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "BinarySensorProvider.h"
+#include "json.h"
+
+BinarySensorProvider::BinarySensorProvider(string description) :
+	mSensorsDescription(description), mRecordSize(0), mRecord(NULL), mSeq(0) {
+	pthread_mutex_init(&mMutex, NULL);
+
+	// Same sizes as JSONSensorsParser assigns, entries it rejects are skipped there too
+	json::Value sensors = json::Deserialize(description);
+	if (sensors.GetType() == json::ArrayVal) {
+		for (size_t i = 0; i < sensors.size(); ++i) {
+			json::Value sensor = sensors[i];
+			if (sensor.GetType() != json::ObjectVal || !sensor.HasKey("name") || !sensor.HasKey("dataType")) {
+				continue;
+			}
+			string dataType = sensor["dataType"].ToString("");
+			if (dataType == "U8") {
+				mRecordSize += 1;
+			} else if (dataType == "U16") {
+				mRecordSize += 2;
+			} else if (dataType == "U32") {
+				mRecordSize += 4;
+			} else if (dataType == "U64" || dataType == "double") {
+				mRecordSize += 8;
+			} else if (dataType == "string" && sensor.HasKey("maxDataSize")) {
+				json::Value maxDataSize = sensor["maxDataSize"];
+				int size = 0;
+				if (maxDataSize.IsNumeric()) {
+					size = maxDataSize.ToInt();
+				} else if (maxDataSize.GetType() == json::StringVal) {
+					std::istringstream ss(maxDataSize.ToString());
+					ss >> size;
+				}
+				if (size > 0 && size <= 255) {
+					mRecordSize += size;
+				}
+			}
+		}
+	}
+	mRecord = (uint8_t*)calloc(1, mRecordSize > 0 ? mRecordSize : 1);
+}
+
+BinarySensorProvider::~BinarySensorProvider() {
+	free(mRecord);
+	pthread_mutex_destroy(&mMutex);
+}
+
+const char* BinarySensorProvider::getSensorsDescription(void) {
+	return mSensorsDescription.c_str();
+}
+
+size_t BinarySensorProvider::getRecordSize(void) {
+	return mRecordSize;
+}
+
+uint64_t BinarySensorProvider::readLatest(uint8_t* buffer) {
+	pthread_mutex_lock(&mMutex);
+	memcpy(buffer, mRecord, mRecordSize);
+	uint64_t seq = mSeq;
+	pthread_mutex_unlock(&mMutex);
+	return seq;
+}
+
+bool BinarySensorProvider::updateRecord(const uint8_t* data, size_t length) {
+	if (length != mRecordSize) {
+		return false;
+	}
+	pthread_mutex_lock(&mMutex);
+	memcpy(mRecord, data, length);
+	mSeq++;
+	pthread_mutex_unlock(&mMutex);
+	return true;
+}
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BINARYSENSORPROVIDER_H_
+#define BINARYSENSORPROVIDER_H_
+
+#include <string>
+#include <pthread.h>
+#include "RawSensorProvider.h"
+
+using namespace std;
+
+// Sensor group added through a binary frame on the telnet port. Values are
+// pushed as packed records (same encoding as the shared memory ring) and
+// copied by JSONSensorsParser without any text parsing.
+class BinarySensorProvider: public RawSensorProvider {
+public:
+	BinarySensorProvider(string description);
+	virtual ~BinarySensorProvider();
+
+	const char* getSensorsDescription(void);
+
+	size_t getRecordSize(void);
+	uint64_t readLatest(uint8_t* buffer);
+
+	bool updateRecord(const uint8_t* data, size_t length);
+
+private:
+	//lint -e(1704)
+	BinarySensorProvider(const BinarySensorProvider& cSource);
+	BinarySensorProvider& operator=(const BinarySensorProvider& cSource);
+
+	string mSensorsDescription;
+	size_t mRecordSize;
+	uint8_t* mRecord;
+	uint64_t mSeq;
+	pthread_mutex_t mMutex;
+};
+
+#endif /* BINARYSENSORPROVIDER_H_ */
@@ -43,6 +43,11 @@
 #include "plugin_models/SlotDetectorFactory.h"
 
 #include "network/TelnetServer.h"
+#include "SelfMonitoringSensorProvider.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include "RecordingCommunicator.h"
+#include "network/MetricsServer.h"
 
 #include "Signature.h"
 
@@ -65,7 +70,9 @@ Daemon::Daemon() :
 	mState(State_BasicInformation),
 	mCurrentPage(1),
 	mComm(NULL),
-	mSlot(0) {
+	mSlot(0),
+	mSelfMonitoring(NULL),
+	mReplyWritten(0) {
 	instance = this;
 	pthread_mutex_init(&mCommMutex, NULL);
 }
@@ -97,6 +104,22 @@ void* Daemon::InvokeService(const uint8_t * serviceName, void * serviceParams) {
 		if (serviceParams != NULL) {
 			*((int8_t*)serviceParams) = instance->getSlot();
 		}
+#ifndef WIN32
+	} else if (strcmp((char*)serviceName, "addWakeupFd") == 0) {
+		// The event has to be consumed by poll() itself (e.g. PSI triggers), else the loop would spin
+		if (serviceParams != NULL) {
+			instance->mWakeupFds.push_back(*((struct pollfd*)serviceParams));
+		}
+	} else if (strcmp((char*)serviceName, "removeWakeupFd") == 0) {
+		if (serviceParams != NULL) {
+			for (vector<struct pollfd>::iterator it = instance->mWakeupFds.begin(); it != instance->mWakeupFds.end(); ++it) {
+				if (it->fd == *((int*)serviceParams)) {
+					instance->mWakeupFds.erase(it);
+					break;
+				}
+			}
+		}
+#endif
 	}
 	return 0;
 }
@@ -194,6 +217,17 @@ int Daemon::run(int exitAfter) {
 		return -1;
 	}
 
+	string recordFile = Config::GetInstance()->GetString("Comm", "recordFile", "");
+	if (recordFile != "") {
+		FILE* file = fopen(recordFile.c_str(), "wb");
+		if (file != NULL) {
+			LOG_INFO(logger, "Recording communicator traffic to " << recordFile);
+			mComm = new RecordingCommunicator(mComm, file);
+		} else {
+			LOG_ERROR(logger, "Could not open " << recordFile << " for recording communicator traffic");
+		}
+	}
+
 	if (!mComm->initInterface()) {
 		LOG_ERROR(logger, "Could not initialize communicator interface!");
 
@@ -347,6 +381,13 @@ int Daemon::run(int exitAfter) {
 	LOG_INFO(logger, "Initializing sensors...");
 	Node::NodeType type = baseboardHeader.maxSlots == 4 ? Node::NODE_APALIS : Node::NODE_CXP;
 	Node* node = new Node(nodeID, baseboardID, mSlot, type);
+	if (Config::GetInstance()->GetBoolean("SelfMonitoring", "enabled", false)) {
+		mSelfMonitoring = new SelfMonitoringSensorProvider(Config::GetInstance()->GetInt("SelfMonitoring", "window", 60));
+		if (!node->getSensors()->addJSONSensorProvider(mSelfMonitoring, "Daemon")) {
+			delete mSelfMonitoring;
+			mSelfMonitoring = NULL;
+		}
+	}
 
 	size_t sensorSize = node->getSensors()->getSize();
 	if (sensorSize <= messageMaxSize) {
@@ -368,6 +409,13 @@ int Daemon::run(int exitAfter) {
 
 	LOG_INFO(logger, "Starting server...");
 	CommandLineServer* server = new CommandLineServer(node, this);
+#ifndef WIN32
+	MetricsServer* metricsServer = NULL;
+	int metricsPort = Config::GetInstance()->GetInt("Metrics", "port", 0);
+	if (metricsPort > 0) {
+		metricsServer = new MetricsServer(node, this, metricsPort);
+	}
+#endif
 
 	LOG_INFO(logger, "Initializing crypto...");
 	Signature* signature = new Signature();
@@ -392,24 +440,37 @@ int Daemon::run(int exitAfter) {
 	}
 	timeval lastLoopTime;
 	gettimeofday(&lastLoopTime, 0);
+	uint64_t lastTickStart = 0;
 	while (!mShutdown) {
+		uint64_t tickStart = Profiler::now();
 		// Read message header
 		Message_Header msg;
-		pthread_mutex_lock(&mCommMutex);
-		ssize_t read = mComm->readData(messageOffset, &msg, sizeof(Message_Header));
-		pthread_mutex_unlock(&mCommMutex);
+		ssize_t read;
+		{
+			Tracer::Span span("comm", "header read");
+			read = doRead(messageOffset, &msg, sizeof(Message_Header));
+		}
 		if (read) {
 			enum Message_Type type = static_cast<Message_Type>(msg.type);
 			uint16_t msgSize = ntohs(msg.size);
+			bool awaitingPickup = (type == Monitoring_Description || type == Basic_Information || type == Command_Result) && mFirstWriteDone;
+			if (mReplyWritten != 0 && !awaitingPickup) {
+				// Resolution is one update interval
+				if (mSelfMonitoring != NULL) {
+					mSelfMonitoring->recordPickup(tickStart - mReplyWritten);
+				}
+				mReplyWritten = 0;
+			}
 			//LOG_DEBUG(logger, "Current message size=" << msg.size << " bytes, type=" << type);
 			if (msgSize <= messageMaxSize) {
 				if (type == Command) {
 					// Handle command
 					uint8_t* data = (uint8_t*)malloc(msgSize);
 					if (data != NULL) {
-						pthread_mutex_lock(&mCommMutex);
-						read = mComm->readData(messageOffset + sizeof(Message_Header), data + sizeof(Message_Header), msgSize - sizeof(Message_Header));
-						pthread_mutex_unlock(&mCommMutex);
+						{
+							Tracer::Span span("comm", "command read");
+							read = doRead(messageOffset + sizeof(Message_Header), data + sizeof(Message_Header), msgSize - sizeof(Message_Header));
+						}
 						if (read) {
 							// Copy together complete message for signature check to pass
 							memcpy(data, &msg, sizeof(Message_Header));
@@ -419,13 +480,19 @@ int Daemon::run(int exitAfter) {
 								uint8_t cmdSignature[SIGNATURE_LENGTH];
 								memcpy(&cmdSignature[0], header->signature, SIGNATURE_LENGTH);
 								memset(header->signature, 0, SIGNATURE_LENGTH);
-								if (signature->checkSignature(data, msgSize, &cmdSignature[0], sizeof(cmdSignature))) {
+								bool verified;
+								{
+									Tracer::Span span("command", "verify command");
+									verified = signature->checkSignature(data, msgSize, &cmdSignature[0], sizeof(cmdSignature));
+								}
+								if (verified) {
 									LOG_DEBUG(logger, "Signature successfully verified");
 									//TODO: Optionally check timestamp +- given time frame
 									size_t commandLen = min((size_t)COMMAND_MAX_LENGTH, strlen((char *)header->command));
 									size_t parametersLen = min((size_t)ntohs(header->parametersLength), min((size_t)msgSize, messageMaxSize));
 									string command((char*)(header->command), commandLen);
 									string parameters((char*)(data + sizeof(Command_Header)), parametersLen);
+									Tracer::Span span("command", "execute command");
 									node->executeCommand(command, parameters);
 								} else {
 									LOG_ERROR(logger, "Signature verification failed");
@@ -436,41 +503,56 @@ int Daemon::run(int exitAfter) {
 
 							// Clear command message
 							uint8_t type = 0;
-							pthread_mutex_lock(&mCommMutex);
-							mComm->writeData(messageOffset, &type, 1);
-							pthread_mutex_unlock(&mCommMutex);
+							doWrite(messageOffset, &type, 1);
 						} else {
 							LOG_ERROR(logger, "Could not read rest of command message");
 						}
 					} else {
 						LOG_ERROR(logger, "Could not allocate memory for rest of command message");
 					}
-				} else if ((type == Monitoring_Description || type == Basic_Information || type == Command_Result) && mFirstWriteDone) {
+				} else if (awaitingPickup) {
 					LOG_DEBUG(logger, "Waiting for management to pick up message...");
 					// Reply not yet read by management, keep data
 				} else {
 					if (mState == State_BasicInformation) {
 						uint8_t* desc = (uint8_t*)malloc(messageMaxSize);
-						size_t size = node->getBasicInformationBlock(desc, messageMaxSize);
+						size_t size;
+						{
+							Tracer::Span span("frame", "basic information assembly");
+							size = node->getBasicInformationBlock(desc, messageMaxSize);
+						}
 						LOG_DEBUG(logger, "Writing basic information block (" << size << " bytes)");
-						pthread_mutex_lock(&mCommMutex);
-						mComm->writeData(messageOffset, desc, size);
-						pthread_mutex_unlock(&mCommMutex);
+						doWrite(messageOffset, desc, size);
+						mReplyWritten = Profiler::now();
 						free(desc);
 						mState = State_MonitoringDescription;
+					} else if (mState == State_MonitoringData && node->getSensors()->updateDynamicSensors()) {
+						// Management has to fetch the new description first
+						resetStatemachine();
 					} else if (mState == State_MonitoringData) {
-						//LOG_DEBUG(logger, "Writing sensor data (" << sensorSize << " bytes)");
-						pthread_mutex_lock(&mCommMutex);
-						mComm->writeData(messageOffset, node->getSensors()->getMessage(), sensorSize);
-						pthread_mutex_unlock(&mCommMutex);
+						uint8_t* message;
+						{
+							Tracer::Span span("frame", "frame assembly");
+							message = node->getSensors()->getMessage();
+						}
+						sensorSize = node->getSensors()->getSize(); // Changes when sensor groups are added at runtime
+						if (sensorSize <= messageMaxSize) {
+							//LOG_DEBUG(logger, "Writing sensor data (" << sensorSize << " bytes)");
+							doWrite(messageOffset, message, sensorSize);
+						} else {
+							LOG_ERROR(logger, "Sensor message size of " << sensorSize << " bytes too big for allocated memory!");
+						}
 					} else if (mState == State_MonitoringDescription) {
 						uint8_t* desc = (uint8_t*)malloc(messageMaxSize);
 						uint8_t maxPages = 0;
-						size_t size = node->getSensors()->getDescriptionPage(desc, messageMaxSize, mCurrentPage, &maxPages);
+						size_t size;
+						{
+							Tracer::Span span("frame", "description assembly");
+							size = node->getSensors()->getDescriptionPage(desc, messageMaxSize, mCurrentPage, &maxPages);
+						}
 						LOG_DEBUG(logger, "Writing description page " << (int)mCurrentPage << " of " << (int)maxPages << " (" << size << " bytes)");
-						pthread_mutex_lock(&mCommMutex);
-						mComm->writeData(messageOffset, desc, size);
-						pthread_mutex_unlock(&mCommMutex);
+						doWrite(messageOffset, desc, size);
+						mReplyWritten = Profiler::now();
 						free(desc);
 
 						mCurrentPage++;
@@ -488,6 +570,14 @@ int Daemon::run(int exitAfter) {
 			LOG_WARN(logger, "Could not read message header");
 		}
 
+		if (Tracer::isEnabled()) {
+			Tracer::record("loop", "tick", tickStart, Profiler::now() - tickStart);
+		}
+		if (mSelfMonitoring != NULL && lastTickStart != 0) {
+			mSelfMonitoring->recordTick(Profiler::now() - tickStart, tickStart - lastTickStart, (uint64_t)updateInterval * 1000000);
+		}
+		lastTickStart = tickStart;
+
 		// Wait for next update
 		timeval endTime;
 		int loopTime = 0;
@@ -501,7 +591,13 @@ int Daemon::run(int exitAfter) {
 #ifdef WIN32
 				Sleep(100);
 #else
-				usleep(100 * 1000);
+				if (mWakeupFds.empty()) {
+					usleep(100 * 1000);
+				} else if (poll(&mWakeupFds[0], mWakeupFds.size(), 100) > 0) {
+					LOG_DEBUG(logger, "Woken up before next update");
+					gettimeofday(&endTime, 0);
+					break;
+				}
 #endif
 			} else {
 				break;
@@ -517,14 +613,19 @@ int Daemon::run(int exitAfter) {
 		}
 	}
 
+#ifndef WIN32
+	// Stop feeding sensor groups before they are deleted
+	delete metricsServer;
+#endif
 	LOG_INFO(logger, "RECS daemon quitting, writing empty sensor description page");
+	pthread_mutex_lock(&mCommMutex);
+	mSelfMonitoring = NULL; // Deleted with the sensor groups
+	pthread_mutex_unlock(&mCommMutex);
 	node->getSensors()->clear();
 	uint8_t* desc = (uint8_t*)malloc(messageMaxSize);
 	uint8_t maxPages = 0;
 	size = node->getSensors()->getDescriptionPage(desc, messageMaxSize, 1, &maxPages);
-	pthread_mutex_lock(&mCommMutex);
-	mComm->writeData(messageOffset, desc, size);
-	pthread_mutex_unlock(&mCommMutex);
+	doWrite(messageOffset, desc, size);
 	free(desc);
 
 	LOG_INFO(logger, "Shutting down services");
@@ -550,14 +651,35 @@ LoggerPtr* Daemon::addPluginLogger(string name) {
 
 ssize_t Daemon::doRead(size_t offset, void* buf, size_t count) {
 	ssize_t read = -1;
+	uint64_t start = Profiler::now();
 	pthread_mutex_lock(&mCommMutex);
+	uint64_t locked = Profiler::now();
 	if (mComm != NULL) {
 		read = mComm->readData(offset, buf, count);
 	}
+	if (mSelfMonitoring != NULL) {
+		mSelfMonitoring->recordCommRead(locked - start, Profiler::now() - locked);
+	}
 	pthread_mutex_unlock(&mCommMutex);
 	return read;
 }
 
+ssize_t Daemon::doWrite(size_t offset, const void* buf, size_t count) {
+	Tracer::Span span("comm", "comm write");
+	ssize_t written = -1;
+	uint64_t start = Profiler::now();
+	pthread_mutex_lock(&mCommMutex);
+	uint64_t locked = Profiler::now();
+	if (mComm != NULL) {
+		written = mComm->writeData(offset, buf, count);
+	}
+	if (mSelfMonitoring != NULL) {
+		mSelfMonitoring->recordCommWrite(locked - start, Profiler::now() - locked);
+	}
+	pthread_mutex_unlock(&mCommMutex);
+	return written;
+}
+
 void Daemon::shutdown() {
 	mShutdown = true;
 }
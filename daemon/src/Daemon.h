@@ -27,10 +27,16 @@
 #define DAEMON_H_
 
 #include <list>
+#include <vector>
 #include <logger.h>
 #include <stdint.h>
 #include <pthread.h>
 #include "object_model.h"
+#ifndef WIN32
+#include <poll.h>
+#endif
+
+class SelfMonitoringSensorProvider;
 
 class Daemon {
 public:
@@ -51,6 +57,8 @@ private:
 		State_BasicInformation
 	};
 
+	ssize_t doWrite(size_t offset, const void* buf, size_t count);
+
 	static void* InvokeService(const uint8_t * serviceName, void * serviceParams);
 	static void signal_handler(int sig);
 
@@ -62,6 +70,11 @@ private:
 	ICommunicator* mComm;
 	pthread_mutex_t mCommMutex;
 	int8_t mSlot;
+	SelfMonitoringSensorProvider* mSelfMonitoring; // Owned by the SensorSet, NULL if disabled
+	uint64_t mReplyWritten; // When the reply management has to pick up was written, 0 if none
+#ifndef WIN32
+	std::vector<struct pollfd> mWakeupFds; // Registered by plugins, end the wait for the next update early
+#endif
 
 	static LoggerPtr logger;
 	static Daemon* instance;
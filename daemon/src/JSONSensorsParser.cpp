@@ -25,6 +25,7 @@
 
 #include "JSONSensorsParser.h"
 #include "SensorBean.h"
+#include "RawSensorProvider.h"
 #include <daemon_msgs.h>
 
 using namespace std;
@@ -34,12 +35,17 @@ LoggerPtr JSONSensorsParser::logger(Logger::getLogger("JSONSensorsParser"));
 JSONSensorsParser::JSONSensorsParser(IJSONSensorProvider* sensorProvider, string name) {
 	mSensorProvider = sensorProvider;
 	mName = name;
+	mRawProvider = dynamic_cast<RawSensorProvider*>(sensorProvider);
+	mRecordBuffer = NULL;
+	mLastRecordSeq = 0;
+	mValid = true;
 }
 
 JSONSensorsParser::~JSONSensorsParser() {
 	// Sensor instances will be deleted by SensorSet
 	mSensors.clear();
 	mSensorsOrdered.clear();
+	free(mRecordBuffer);
 	delete mSensorProvider;
 }
 
@@ -49,6 +55,7 @@ JSONSensorsParser::SensorsMap JSONSensorsParser::getSensors(void) {
 	}
 	mSensors.clear();
 	mSensorsOrdered.clear();
+	mValid = true;
 
 	string sensorsDescriptionString = mSensorProvider->getSensorsDescription();
 	json::Value sensorsDescription = json::Deserialize(sensorsDescriptionString);
@@ -89,8 +96,20 @@ JSONSensorsParser::SensorsMap JSONSensorsParser::getSensors(void) {
 				} else if (dataTypeStr == "string") {
 					dataType = TYPE_STR;
 					if (sensor.HasKey("maxDataSize")) {
-						std::istringstream ss(sensor["maxDataSize"]);
-						ss >> maxDataSize;
+						// Accept number and string, reading a string directly into uint8_t would only take its first character
+						json::Value maxDataSizeValue = sensor["maxDataSize"];
+						int size = 0;
+						if (maxDataSizeValue.IsNumeric()) {
+							size = maxDataSizeValue.ToInt();
+						} else if (maxDataSizeValue.GetType() == json::StringVal) {
+							std::istringstream ss(maxDataSizeValue.ToString());
+							ss >> size;
+						}
+						if (size <= 0 || size > 255) {
+							LOG_ERROR(logger, "Invalid property 'maxDataSize' for sensor '" << name << "'");
+							continue;
+						}
+						maxDataSize = (uint8_t)size;
 					} else {
 						LOG_ERROR(logger, "Required property 'maxDataSize' missing");
 						continue;
@@ -112,6 +131,12 @@ JSONSensorsParser::SensorsMap JSONSensorsParser::getSensors(void) {
 						unit = UNIT_TEMPERATURE;
 					} else if (unitStr == "RPM") {
 						unit = UNIT_ROTATIONAL_SPEED;
+					} else if (unitStr == "B/s") {
+						unit = UNIT_BYTE_SECOND;
+					} else if (unitStr == "B") {
+						unit = UNIT_BYTE;
+					} else if (unitStr == "%") {
+						unit = UNIT_PERCENT;
 					}
 				}
 				bool useLowerThresholds = false;
@@ -168,10 +193,34 @@ JSONSensorsParser::SensorsMap JSONSensorsParser::getSensors(void) {
 		}
 	}
 
+	if (mRawProvider != NULL && mRawProvider->getRecordSize() == 0) {
+		// Provider has no records (e.g. device without binary mode), use JSON
+		mRawProvider = NULL;
+	}
+	if (mRawProvider != NULL) {
+		size_t recordSize = 0;
+		for (vector<SensorBean*>::iterator iterator = mSensorsOrdered.begin(); iterator != mSensorsOrdered.end(); ++iterator) {
+			recordSize += (*iterator)->getMaxDataSize();
+		}
+		free(mRecordBuffer);
+		mRecordBuffer = NULL;
+		if (recordSize != mRawProvider->getRecordSize()) {
+			LOG_ERROR(logger, "Record size of " << mName << " is " << mRawProvider->getRecordSize() << " bytes, sensors description needs " << recordSize);
+			mValid = false;
+		} else {
+			mRecordBuffer = (uint8_t*)malloc(recordSize);
+		}
+	}
+
 	return mSensors;
 }
 
 void JSONSensorsParser::updateSensors(void) {
+	if (mRawProvider != NULL) {
+		updateSensorsFromRecord();
+		return;
+	}
+
 	string sensorsDataString = mSensorProvider->getSensorsData();
 	if (sensorsDataString == "") {
 		return;
@@ -212,6 +261,35 @@ void JSONSensorsParser::updateSensors(void) {
 	}
 }
 
+void JSONSensorsParser::updateSensorsFromRecord(void) {
+	if (mRecordBuffer == NULL) {
+		return;
+	}
+	uint64_t seq = mRawProvider->readLatest(mRecordBuffer);
+	if (seq == 0 || seq == mLastRecordSeq) {
+		// Nothing new, keep last values
+		return;
+	}
+	mLastRecordSeq = seq;
+
+	size_t offset = 0;
+	for (vector<SensorBean*>::iterator iterator = mSensorsOrdered.begin(); iterator != mSensorsOrdered.end(); ++iterator) {
+		(*iterator)->setRawData(&mRecordBuffer[offset]);
+		offset += (*iterator)->getMaxDataSize();
+	}
+}
+
 IJSONSensorProvider* JSONSensorsParser::getProvider() {
 	return mSensorProvider;
 }
+
+// False if the provider's records do not match the sensors description
+bool JSONSensorsParser::isValid(void) const {
+	return mValid;
+}
+
+// Provider is not deleted with the parser anymore
+void JSONSensorsParser::releaseProvider(void) {
+	mSensorProvider = NULL;
+	mRawProvider = NULL;
+}
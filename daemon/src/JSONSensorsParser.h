@@ -32,6 +32,8 @@
 #include "SensorSet.h"
 #include "SensorBean.h"
 
+class RawSensorProvider;
+
 class JSONSensorsParser {
 public:
 	typedef std::map<std::string, ISensor* > SensorsMap;
@@ -43,9 +45,17 @@ public:
 	void updateSensors(void);
 
 	IJSONSensorProvider* getProvider();
+	bool isValid(void) const;
+	void releaseProvider(void);
 
 private:
+	void updateSensorsFromRecord(void);
+
 	IJSONSensorProvider* mSensorProvider;
+	RawSensorProvider* mRawProvider;
+	uint8_t* mRecordBuffer;
+	uint64_t mLastRecordSeq;
+	bool mValid;
 	std::string mName;
 	SensorsMap mSensors;
 	std::vector<SensorBean*> mSensorsOrdered;
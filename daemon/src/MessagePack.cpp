@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include "MessagePack.h"
+
+#define MAX_DEPTH	8
+
+json::Value MessagePack::decode(const uint8_t* data, size_t length) {
+	json::Value value;
+	const uint8_t* end = data + length;
+	if (!decodeValue(data, end, value, 0) || data != end) {
+		return json::Value();
+	}
+	return value;
+}
+
+bool MessagePack::readUint(const uint8_t*& data, const uint8_t* end, size_t bytes, uint64_t& value) {
+	if ((size_t)(end - data) < bytes) {
+		return false;
+	}
+	value = 0;
+	for (size_t i = 0; i < bytes; ++i) { // Big endian
+		value = (value << 8) | *data++;
+	}
+	return true;
+}
+
+bool MessagePack::decodeValue(const uint8_t*& data, const uint8_t* end, json::Value& value, int depth) {
+	if (data >= end || depth > MAX_DEPTH) {
+		return false;
+	}
+	uint8_t type = *data++;
+	uint64_t n = 0;
+
+	if (type <= 0x7f) { // positive fixint
+		value = json::Value((int)type);
+	} else if (type >= 0xe0) { // negative fixint
+		value = json::Value((int)(int8_t)type);
+	} else if ((type & 0xe0) == 0xa0) { // fixstr
+		return decodeString(data, end, type & 0x1f, value);
+	} else if ((type & 0xf0) == 0x90) { // fixarray
+		return decodeArray(data, end, type & 0x0f, value, depth);
+	} else if ((type & 0xf0) == 0x80) { // fixmap
+		return decodeMap(data, end, type & 0x0f, value, depth);
+	} else {
+		switch (type) {
+			case 0xc0: value = json::Value(); break;
+			case 0xc2: value = json::Value(false); break;
+			case 0xc3: value = json::Value(true); break;
+			case 0xcc: case 0xcd: case 0xce: case 0xcf: // uint 8/16/32/64
+				if (!readUint(data, end, 1 << (type - 0xcc), n)) {
+					return false;
+				}
+				if (n > 0x7fffffff) {
+					value = json::Value((double)n);
+				} else {
+					value = json::Value((int)n);
+				}
+				break;
+			case 0xd0: case 0xd1: case 0xd2: case 0xd3: { // int 8/16/32/64
+				size_t bytes = 1 << (type - 0xd0);
+				if (!readUint(data, end, bytes, n)) {
+					return false;
+				}
+				int64_t s = (int64_t)(n << (64 - 8 * bytes)) >> (64 - 8 * bytes); // Sign extend
+				if (s > 0x7fffffff || s < -0x7fffffff - 1) {
+					value = json::Value((double)s);
+				} else {
+					value = json::Value((int)s);
+				}
+				break;
+			}
+			case 0xca: { // float32
+				if (!readUint(data, end, 4, n)) {
+					return false;
+				}
+				uint32_t bits = (uint32_t)n;
+				float f;
+				memcpy(&f, &bits, 4);
+				value = json::Value((double)f);
+				break;
+			}
+			case 0xcb: { // float64
+				if (!readUint(data, end, 8, n)) {
+					return false;
+				}
+				double d;
+				memcpy(&d, &n, 8);
+				value = json::Value(d);
+				break;
+			}
+			case 0xd9: case 0xda: case 0xdb: // str 8/16/32
+				if (!readUint(data, end, 1 << (type - 0xd9), n)) {
+					return false;
+				}
+				return decodeString(data, end, n, value);
+			case 0xdc: case 0xdd: // array 16/32
+				if (!readUint(data, end, 2 << (type - 0xdc), n)) {
+					return false;
+				}
+				return decodeArray(data, end, n, value, depth);
+			case 0xde: case 0xdf: // map 16/32
+				if (!readUint(data, end, 2 << (type - 0xde), n)) {
+					return false;
+				}
+				return decodeMap(data, end, n, value, depth);
+			default:
+				return false;
+		}
+	}
+	return true;
+}
+
+bool MessagePack::decodeString(const uint8_t*& data, const uint8_t* end, size_t length, json::Value& value) {
+	if ((size_t)(end - data) < length) {
+		return false;
+	}
+	value = json::Value(std::string((const char*)data, length));
+	data += length;
+	return true;
+}
+
+bool MessagePack::decodeArray(const uint8_t*& data, const uint8_t* end, size_t count, json::Value& value, int depth) {
+	if (count > (size_t)(end - data)) { // Every element needs at least one byte
+		return false;
+	}
+	json::Array array;
+	for (size_t i = 0; i < count; ++i) {
+		json::Value element;
+		if (!decodeValue(data, end, element, depth + 1)) {
+			return false;
+		}
+		array.push_back(element);
+	}
+	value = json::Value(array);
+	return true;
+}
+
+bool MessagePack::decodeMap(const uint8_t*& data, const uint8_t* end, size_t count, json::Value& value, int depth) {
+	if (count > (size_t)(end - data) / 2) {
+		return false;
+	}
+	json::Object object;
+	for (size_t i = 0; i < count; ++i) {
+		json::Value key;
+		json::Value element;
+		if (!decodeValue(data, end, key, depth + 1) || key.GetType() != json::StringVal) {
+			return false;
+		}
+		if (!decodeValue(data, end, element, depth + 1)) {
+			return false;
+		}
+		object[key.ToString()] = element;
+	}
+	value = json::Value(object);
+	return true;
+}
@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MESSAGEPACK_H_
+#define MESSAGEPACK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "json.h"
+
+// Minimal MessagePack decoder producing the same json::Value tree as
+// json::Deserialize, so binary sensor descriptions share the JSON code path.
+// Supported: nil, bool, int/uint up to 64 bit, float32/64, str, array, map
+// with string keys. bin and ext are rejected.
+class MessagePack {
+public:
+	// Returns NULLVal on error, like json::Deserialize
+	static json::Value decode(const uint8_t* data, size_t length);
+
+private:
+	static bool decodeValue(const uint8_t*& data, const uint8_t* end, json::Value& value, int depth);
+	static bool decodeString(const uint8_t*& data, const uint8_t* end, size_t length, json::Value& value);
+	static bool decodeArray(const uint8_t*& data, const uint8_t* end, size_t count, json::Value& value, int depth);
+	static bool decodeMap(const uint8_t*& data, const uint8_t* end, size_t count, json::Value& value, int depth);
+	static bool readUint(const uint8_t*& data, const uint8_t* end, size_t bytes, uint64_t& value);
+};
+
+#endif /* MESSAGEPACK_H_ */
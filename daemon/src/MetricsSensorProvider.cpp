@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <sstream>
+#include "MetricsSensorProvider.h"
+
+MetricsSensorProvider::MetricsSensorProvider() :
+	mMetrics(), mFrozen(false), mSeq(0), mSensorsDescription("") {
+	pthread_mutex_init(&mMutex, NULL);
+}
+
+MetricsSensorProvider::~MetricsSensorProvider() {
+	pthread_mutex_destroy(&mMutex);
+}
+
+bool MetricsSensorProvider::update(const string& sensor, MetricType type, double value, size_t maxSensors) {
+	pthread_mutex_lock(&mMutex);
+	vector<Metric>::iterator iterator = mMetrics.begin();
+	while (iterator != mMetrics.end() && iterator->name != sensor) {
+		++iterator;
+	}
+	if (iterator == mMetrics.end()) {
+		if (mFrozen || mMetrics.size() >= maxSensors) {
+			pthread_mutex_unlock(&mMutex);
+			return false;
+		}
+		Metric metric;
+		metric.name = sensor;
+		metric.type = type;
+		metric.value = 0.0;
+		mMetrics.push_back(metric);
+		iterator = mMetrics.end() - 1;
+	}
+	if (iterator->type == METRIC_COUNTER) {
+		iterator->value += value;
+	} else {
+		iterator->value = value;
+	}
+	mSeq++;
+	pthread_mutex_unlock(&mMutex);
+	return true;
+}
+
+void MetricsSensorProvider::freeze(void) {
+	pthread_mutex_lock(&mMutex);
+	mFrozen = true;
+	std::ostringstream oss;
+	oss << "[";
+	for (vector<Metric>::iterator iterator = mMetrics.begin(); iterator != mMetrics.end(); ++iterator) {
+		if (iterator != mMetrics.begin()) {
+			oss << ",";
+		}
+		oss << "{\"name\":\"" << iterator->name << "\",\"dataType\":\"" << (iterator->type == METRIC_COUNTER ? "U64" : "double") << "\"}";
+	}
+	oss << "]";
+	mSensorsDescription = oss.str();
+	pthread_mutex_unlock(&mMutex);
+}
+
+size_t MetricsSensorProvider::getSensorCount(void) {
+	pthread_mutex_lock(&mMutex);
+	size_t count = mMetrics.size();
+	pthread_mutex_unlock(&mMutex);
+	return count;
+}
+
+const char* MetricsSensorProvider::getSensorsDescription(void) {
+	return mSensorsDescription.c_str();
+}
+
+size_t MetricsSensorProvider::getRecordSize(void) {
+	// Counters are U64, everything else double, both 8 bytes
+	return mMetrics.size() * 8;
+}
+
+uint64_t MetricsSensorProvider::readLatest(uint8_t* buffer) {
+	pthread_mutex_lock(&mMutex);
+	for (vector<Metric>::iterator iterator = mMetrics.begin(); iterator != mMetrics.end(); ++iterator) {
+		if (iterator->type == METRIC_COUNTER) {
+			uint64_t value = iterator->value > 0 ? (uint64_t)iterator->value : 0;
+			for (int i = 7; i >= 0; --i) { // Big endian
+				buffer[i] = value & 0xff;
+				value >>= 8;
+			}
+		} else {
+			memcpy(buffer, &iterator->value, 8);
+		}
+		buffer += 8;
+	}
+	uint64_t seq = mSeq;
+	pthread_mutex_unlock(&mMutex);
+	return seq;
+}
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef METRICSSENSORPROVIDER_H_
+#define METRICSSENSORPROVIDER_H_
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "RawSensorProvider.h"
+
+using namespace std;
+
+// Sensor group that is fed by the UDP line protocol (see MetricsServer).
+// Sensors are collected until the group is registered with the SensorSet,
+// afterwards the set of sensors is fixed.
+class MetricsSensorProvider: public RawSensorProvider {
+public:
+	enum MetricType {
+		METRIC_GAUGE,	// "g", last value
+		METRIC_COUNTER,	// "c", accumulated
+		METRIC_TIMER	// "ms", last value
+	};
+
+	MetricsSensorProvider();
+	virtual ~MetricsSensorProvider();
+
+	// Returns false if the sensor is unknown and can not be added anymore
+	bool update(const string& sensor, MetricType type, double value, size_t maxSensors);
+	void freeze(void);
+	size_t getSensorCount(void);
+
+	const char* getSensorsDescription(void);
+	size_t getRecordSize(void);
+	uint64_t readLatest(uint8_t* buffer);
+
+private:
+	struct Metric {
+		string name;
+		MetricType type;
+		double value;
+	};
+
+	//lint -e(1704)
+	MetricsSensorProvider(const MetricsSensorProvider& cSource);
+	MetricsSensorProvider& operator=(const MetricsSensorProvider& cSource);
+
+	vector<Metric> mMetrics;
+	bool mFrozen;
+	uint64_t mSeq;
+	string mSensorsDescription;
+	pthread_mutex_t mMutex;
+};
+
+#endif /* METRICSSENSORPROVIDER_H_ */
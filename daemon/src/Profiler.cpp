@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Profiler.h"
+#include "Config.h"
+
+#include <string.h>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+Profiler::Entry::Entry(const std::string& name) : mName(name) {
+	clear(mCurrent);
+	clear(mPrevious);
+}
+
+void Profiler::Entry::clear(Histogram& histogram) {
+	memset(&histogram, 0, sizeof(histogram));
+}
+
+Profiler::Profiler() : mEnabled(false), mWindowNs(0), mWindowStart(0) {
+	mEnabled = Config::GetInstance()->GetBoolean("Profile", "enabled", false);
+	mWindowNs = (uint64_t)Config::GetInstance()->GetInt("Profile", "window", 60) * 1000000000ULL;
+	mWindowStart = now();
+}
+
+Profiler::~Profiler() {
+	for (std::map<std::string, Entry*>::iterator iterator = mEntries.begin(); iterator != mEntries.end(); ++iterator) {
+		delete iterator->second;
+	}
+}
+
+void Profiler::setEnabled(bool enabled) {
+	if (enabled && !mEnabled) {
+		// Do not report the time while disabled as part of a window
+		reset();
+	}
+	mEnabled = enabled;
+}
+
+Profiler::Entry* Profiler::getEntry(const std::string& name) {
+	std::map<std::string, Entry*>::iterator iterator = mEntries.find(name);
+	if (iterator != mEntries.end()) {
+		return iterator->second;
+	}
+	Entry* entry = new Entry(name);
+	mEntries[name] = entry;
+	return entry;
+}
+
+void Profiler::tick(void) {
+	uint64_t time = now();
+	if (time - mWindowStart < mWindowNs) {
+		return;
+	}
+	for (std::map<std::string, Entry*>::iterator iterator = mEntries.begin(); iterator != mEntries.end(); ++iterator) {
+		iterator->second->mPrevious = iterator->second->mCurrent;
+		Entry::clear(iterator->second->mCurrent);
+	}
+	mWindowStart = time;
+}
+
+void Profiler::reset(void) {
+	for (std::map<std::string, Entry*>::iterator iterator = mEntries.begin(); iterator != mEntries.end(); ++iterator) {
+		Entry::clear(iterator->second->mCurrent);
+		Entry::clear(iterator->second->mPrevious);
+	}
+	mWindowStart = now();
+}
+
+namespace {
+struct ReportLine {
+	std::string name;
+	uint32_t count;
+	uint64_t totalNs;
+	uint64_t maxNs;
+	uint32_t buckets[PROFILE_BUCKETS];
+
+	bool operator<(const ReportLine& other) const {
+		return totalNs > other.totalNs;
+	}
+};
+
+// Upper bound of the bucket holding the given fraction of samples, in us
+std::string percentile(const ReportLine& line, double fraction) {
+	uint32_t target = (uint32_t)(line.count * fraction);
+	uint32_t seen = 0;
+	for (int i = 0; i < PROFILE_BUCKETS; ++i) {
+		seen += line.buckets[i];
+		if (seen > target || i == PROFILE_BUCKETS - 1) {
+			std::ostringstream oss;
+			if (i == PROFILE_BUCKETS - 1) {
+				oss << ">" << (1ULL << (i - 1));
+			} else {
+				oss << "<" << (1ULL << i);
+			}
+			return oss.str();
+		}
+	}
+	return "";
+}
+}
+
+std::string Profiler::getReport(void) {
+	std::vector<ReportLine> lines;
+	for (std::map<std::string, Entry*>::iterator iterator = mEntries.begin(); iterator != mEntries.end(); ++iterator) {
+		Entry* entry = iterator->second;
+		ReportLine line;
+		line.name = entry->mName;
+		line.count = entry->mCurrent.count + entry->mPrevious.count;
+		if (line.count == 0) {
+			continue;
+		}
+		line.totalNs = entry->mCurrent.totalNs + entry->mPrevious.totalNs;
+		line.maxNs = std::max(entry->mCurrent.maxNs, entry->mPrevious.maxNs);
+		for (int i = 0; i < PROFILE_BUCKETS; ++i) {
+			line.buckets[i] = entry->mCurrent.buckets[i] + entry->mPrevious.buckets[i];
+		}
+		lines.push_back(line);
+	}
+	std::sort(lines.begin(), lines.end());
+
+	std::ostringstream oss;
+	oss << std::left << std::setw(36) << "Name (durations in us)" << std::right
+		<< std::setw(8) << "count" << std::setw(10) << "avg" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << std::setw(12) << "total" << "\n";
+	for (std::vector<ReportLine>::iterator line = lines.begin(); line != lines.end(); ++line) {
+		oss << std::left << std::setw(36) << line->name << std::right
+			<< std::setw(8) << line->count
+			<< std::setw(10) << line->totalNs / line->count / 1000
+			<< std::setw(10) << percentile(*line, 0.5)
+			<< std::setw(10) << percentile(*line, 0.99)
+			<< std::setw(10) << line->maxNs / 1000
+			<< std::setw(12) << line->totalNs / 1000 << "\n";
+	}
+	return oss.str();
+}
+
+#ifdef WIN32
+uint64_t Profiler::nowWin32(void) {
+	static LARGE_INTEGER frequency = { { 0, 0 } };
+	if (frequency.QuadPart == 0) {
+		QueryPerformanceFrequency(&frequency);
+	}
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)((double)counter.QuadPart * 1000000000.0 / (double)frequency.QuadPart);
+}
+#endif
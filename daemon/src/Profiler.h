@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <map>
+#include <string>
+
+#define PROFILE_BUCKETS	24 // < 1 us, then powers of two up to 4 s
+
+// Rolling duration histograms of the sensor acquisition hot path. Samples go
+// into the current window, reports cover the current and the previous one.
+// Not thread safe, SensorSet uses it under its mutex.
+class Profiler {
+public:
+	class Entry {
+	public:
+		explicit Entry(const std::string& name);
+
+		void record(uint64_t ns) {
+			uint64_t us = ns / 1000;
+			int bucket = 0;
+			while (us > 0 && bucket < PROFILE_BUCKETS - 1) {
+				us >>= 1;
+				bucket++;
+			}
+			mCurrent.buckets[bucket]++;
+			mCurrent.count++;
+			mCurrent.totalNs += ns;
+			if (ns > mCurrent.maxNs) {
+				mCurrent.maxNs = ns;
+			}
+		}
+
+		const std::string& getName(void) const {
+			return mName;
+		}
+
+	private:
+		friend class Profiler;
+
+		struct Histogram {
+			uint32_t buckets[PROFILE_BUCKETS];
+			uint32_t count;
+			uint64_t totalNs;
+			uint64_t maxNs;
+		};
+
+		static void clear(Histogram& histogram);
+
+		std::string mName;
+		Histogram mCurrent;
+		Histogram mPrevious;
+	};
+
+	// Scoped measurement, does nothing for a NULL entry
+	class Scope {
+	public:
+		explicit Scope(Entry* entry) : mEntry(entry), mStart(entry != NULL ? now() : 0) {
+		}
+
+		~Scope() {
+			if (mEntry != NULL) {
+				mEntry->record(now() - mStart);
+			}
+		}
+
+	private:
+		//lint -e(1704)
+		Scope(const Scope& cSource);
+		Scope& operator=(const Scope& cSource);
+
+		Entry* mEntry;
+		uint64_t mStart;
+	};
+
+	Profiler();
+	~Profiler();
+
+	bool isEnabled(void) const {
+		return mEnabled;
+	}
+	void setEnabled(bool enabled);
+
+	// Entries live as long as the profiler, the same name gives the same entry
+	Entry* getEntry(const std::string& name);
+
+	// Called once per tick, starts a new window when the current one is full
+	void tick(void);
+	void reset(void);
+	std::string getReport(void);
+
+	// Monotonic clock in ns
+	static uint64_t now(void) {
+#ifndef WIN32
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#else
+		return nowWin32();
+#endif
+	}
+
+private:
+	//lint -e(1704)
+	Profiler(const Profiler& cSource);
+	Profiler& operator=(const Profiler& cSource);
+
+#ifdef WIN32
+	static uint64_t nowWin32(void);
+#endif
+
+	std::map<std::string, Entry*> mEntries;
+	bool mEnabled;
+	uint64_t mWindowNs;
+	uint64_t mWindowStart;
+};
+
+#endif /* PROFILER_H_ */
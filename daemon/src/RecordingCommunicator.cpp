@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "RecordingCommunicator.h"
+#include "CommCapture.h"
+#include "Profiler.h"
+
+#include <string.h>
+
+LoggerPtr RecordingCommunicator::logger(Logger::getLogger("RecordingCommunicator"));
+
+RecordingCommunicator::RecordingCommunicator(ICommunicator* comm, FILE* file) :
+	mComm(comm), mFile(file), mHeaderWritten(false), mLastTime(0), mRecords(0) {
+	pthread_mutex_init(&mMutex, NULL);
+}
+
+RecordingCommunicator::~RecordingCommunicator() {
+	delete mComm;
+	fclose(mFile);
+	LOG_INFO(logger, "Recorded " << mRecords << " communicator accesses");
+	pthread_mutex_destroy(&mMutex);
+}
+
+bool RecordingCommunicator::initInterface(void) {
+	if (!mComm->initInterface()) {
+		return false;
+	}
+	// Replay needs the memory size before the first access
+	uint8_t header[sizeof(COMM_CAPTURE_MAGIC) + COMM_CAPTURE_MAX_VARINT];
+	size_t length = strlen(COMM_CAPTURE_MAGIC);
+	memcpy(header, COMM_CAPTURE_MAGIC, length);
+	header[length++] = COMM_CAPTURE_VERSION;
+	length += commCapturePutVarint(&header[length], mComm->getMaxDataSize());
+	pthread_mutex_lock(&mMutex);
+	mHeaderWritten = fwrite(header, 1, length, mFile) == length;
+	mLastTime = Profiler::now() / 1000;
+	pthread_mutex_unlock(&mMutex);
+	if (!mHeaderWritten) {
+		LOG_ERROR(logger, "Could not write capture header, not recording");
+	}
+	return true;
+}
+
+size_t RecordingCommunicator::getMaxDataSize(void) {
+	return mComm->getMaxDataSize();
+}
+
+ssize_t RecordingCommunicator::readData(size_t offset, void* buf, size_t count) {
+	ssize_t result = mComm->readData(offset, buf, count);
+	record(COMM_CAPTURE_READ, offset, count, result, buf, result > 0 ? result : 0);
+	return result;
+}
+
+ssize_t RecordingCommunicator::writeData(size_t offset, const void* buf, size_t count) {
+	ssize_t result = mComm->writeData(offset, buf, count);
+	record(COMM_CAPTURE_WRITE, offset, count, result, buf, count);
+	return result;
+}
+
+void RecordingCommunicator::record(uint8_t kind, size_t offset, size_t count, ssize_t result, const void* payload, size_t payloadLength) {
+	uint8_t prefix[COMM_CAPTURE_MAX_PREFIX];
+	pthread_mutex_lock(&mMutex);
+	if (mHeaderWritten) {
+		uint64_t time = Profiler::now() / 1000;
+		size_t length = commCapturePutRecord(prefix, kind, time - mLastTime, offset, count, result);
+		mLastTime = time;
+		fwrite(prefix, 1, length, mFile);
+		fwrite(payload, 1, payloadLength, mFile);
+		mRecords++;
+		if (kind == COMM_CAPTURE_WRITE) {
+			// About once per update, so a crash loses little of the capture
+			fflush(mFile);
+		}
+	}
+	pthread_mutex_unlock(&mMutex);
+}
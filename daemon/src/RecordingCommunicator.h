@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RECORDINGCOMMUNICATOR_H_
+#define RECORDINGCOMMUNICATOR_H_
+
+#include <stdio.h>
+#include <pthread.h>
+#include <logger.h>
+#include "object_model.h"
+
+// Passes all calls on to the wrapped communicator and logs every readData
+// and writeData with payload to a capture file (see CommCapture.h), which
+// the CommunicatorReplay plugin plays back. Owns the communicator and file.
+class RecordingCommunicator: public ICommunicator {
+public:
+	RecordingCommunicator(ICommunicator* comm, FILE* file);
+	virtual ~RecordingCommunicator();
+
+	virtual bool initInterface(void);
+	virtual size_t getMaxDataSize(void);
+	virtual ssize_t readData(size_t offset, void* buf, size_t count);
+	virtual ssize_t writeData(size_t offset, const void* buf, size_t count);
+
+private:
+	//lint -e(1704)
+	RecordingCommunicator(const RecordingCommunicator& cSource);
+	RecordingCommunicator& operator=(const RecordingCommunicator& cSource);
+
+	void record(uint8_t kind, size_t offset, size_t count, ssize_t result, const void* payload, size_t payloadLength);
+
+	ICommunicator* mComm;
+	FILE* mFile;
+	bool mHeaderWritten;
+	uint64_t mLastTime; // us
+	uint64_t mRecords;
+	pthread_mutex_t mMutex;
+
+	static LoggerPtr logger;
+};
+
+#endif /* RECORDINGCOMMUNICATOR_H_ */
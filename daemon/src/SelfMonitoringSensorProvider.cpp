@@ -0,0 +1,188 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+#include "SelfMonitoringSensorProvider.h"
+#include "Profiler.h"
+
+#define NS_PER_MS	1000000.0
+
+// Same order as the record
+static const char* SENSORS_DESCRIPTION = "["
+	"{\"name\":\"Daemon tick\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon tick p99\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon jitter p50\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon jitter p99\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon comm lock\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon comm lock wait\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon comm read p50\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon comm read p99\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon comm write p50\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon comm write p99\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon pickup delay\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon CPU\",\"dataType\":\"double\",\"unit\":\"%\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon CPU time\",\"dataType\":\"double\",\"group\":\"Daemon\"},"
+	"{\"name\":\"Daemon RSS\",\"dataType\":\"U64\",\"unit\":\"B\",\"group\":\"Daemon\"}"
+	"]";
+#define SENSOR_COUNT	14 // All 8 bytes
+
+void SelfMonitoringSensorProvider::SampleWindow::add(double value) {
+	if (mSamples.size() < mSize) {
+		mSamples.push_back(value);
+	} else {
+		mSamples[mNext] = value;
+	}
+	mNext = (mNext + 1) % mSize;
+}
+
+double SelfMonitoringSensorProvider::SampleWindow::percentile(double fraction) const {
+	if (mSamples.empty()) {
+		return 0.0;
+	}
+	vector<double> sorted(mSamples);
+	size_t n = std::min((size_t)(fraction * sorted.size()), sorted.size() - 1);
+	std::nth_element(sorted.begin(), sorted.begin() + n, sorted.end());
+	return sorted[n];
+}
+
+SelfMonitoringSensorProvider::SelfMonitoringSensorProvider(size_t window) :
+	mTicks(window), mJitter(window), mReads(window * 4), mWrites(window * 4),
+	mLastTick(0.0), mLockHeld(0.0), mLockWait(0.0), mLockHeldCurrent(0.0), mLockWaitCurrent(0.0), mPickupDelay(0.0),
+	mLastCpuTime(0.0), mLastCpuSample(0), mStatm("/proc/self/statm", 128), mSeq(0) {
+	pthread_mutex_init(&mMutex, NULL);
+}
+
+SelfMonitoringSensorProvider::~SelfMonitoringSensorProvider() {
+	pthread_mutex_destroy(&mMutex);
+}
+
+void SelfMonitoringSensorProvider::recordTick(uint64_t work, uint64_t period, uint64_t interval) {
+	pthread_mutex_lock(&mMutex);
+	mLastTick = work / NS_PER_MS;
+	mTicks.add(mLastTick);
+	// Deviation from the configured interval, early wake-ups count as well
+	mJitter.add((period > interval ? period - interval : interval - period) / NS_PER_MS);
+	mLockHeld = mLockHeldCurrent;
+	mLockWait = mLockWaitCurrent;
+	mLockHeldCurrent = 0.0;
+	mLockWaitCurrent = 0.0;
+	mSeq++;
+	pthread_mutex_unlock(&mMutex);
+}
+
+void SelfMonitoringSensorProvider::recordCommRead(uint64_t wait, uint64_t duration) {
+	pthread_mutex_lock(&mMutex);
+	mReads.add(duration / NS_PER_MS);
+	mLockHeldCurrent += duration / NS_PER_MS;
+	mLockWaitCurrent += wait / NS_PER_MS;
+	pthread_mutex_unlock(&mMutex);
+}
+
+void SelfMonitoringSensorProvider::recordCommWrite(uint64_t wait, uint64_t duration) {
+	pthread_mutex_lock(&mMutex);
+	mWrites.add(duration / NS_PER_MS);
+	mLockHeldCurrent += duration / NS_PER_MS;
+	mLockWaitCurrent += wait / NS_PER_MS;
+	pthread_mutex_unlock(&mMutex);
+}
+
+void SelfMonitoringSensorProvider::recordPickup(uint64_t delay) {
+	pthread_mutex_lock(&mMutex);
+	mPickupDelay = delay / NS_PER_MS;
+	pthread_mutex_unlock(&mMutex);
+}
+
+const char* SelfMonitoringSensorProvider::getSensorsDescription(void) {
+	return SENSORS_DESCRIPTION;
+}
+
+size_t SelfMonitoringSensorProvider::getRecordSize(void) {
+	return SENSOR_COUNT * 8;
+}
+
+void SelfMonitoringSensorProvider::readProcess(double& cpuPercent, double& cpuTime, uint64_t& rss) {
+	cpuPercent = 0.0;
+	cpuTime = 0.0;
+	rss = 0;
+#ifndef WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		cpuTime = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+		uint64_t now = Profiler::now();
+		if (mLastCpuSample != 0 && now > mLastCpuSample) {
+			cpuPercent = (cpuTime - mLastCpuTime) * 1e9 / (double)(now - mLastCpuSample) * 100.0;
+		}
+		mLastCpuTime = cpuTime;
+		mLastCpuSample = now;
+	}
+
+	// Second field is the resident set in pages
+	if (mStatm.read()) {
+		const char* p = mStatm.data();
+		uint64_t size, resident;
+		if (procScanUint64(p, mStatm.end(), size) && procScanUint64(p, mStatm.end(), resident)) {
+			rss = resident * sysconf(_SC_PAGESIZE);
+		}
+	}
+#endif
+}
+
+static void putDouble(uint8_t*& buffer, double value) {
+	memcpy(buffer, &value, 8);
+	buffer += 8;
+}
+
+uint64_t SelfMonitoringSensorProvider::readLatest(uint8_t* buffer) {
+	double cpuPercent, cpuTime;
+	uint64_t rss;
+	readProcess(cpuPercent, cpuTime, rss);
+
+	pthread_mutex_lock(&mMutex);
+	putDouble(buffer, mLastTick);
+	putDouble(buffer, mTicks.percentile(0.99));
+	putDouble(buffer, mJitter.percentile(0.5));
+	putDouble(buffer, mJitter.percentile(0.99));
+	putDouble(buffer, mLockHeld);
+	putDouble(buffer, mLockWait);
+	putDouble(buffer, mReads.percentile(0.5));
+	putDouble(buffer, mReads.percentile(0.99));
+	putDouble(buffer, mWrites.percentile(0.5));
+	putDouble(buffer, mWrites.percentile(0.99));
+	putDouble(buffer, mPickupDelay);
+	putDouble(buffer, cpuPercent);
+	putDouble(buffer, cpuTime);
+	for (int i = 7; i >= 0; --i) { // Big endian
+		buffer[i] = rss & 0xff;
+		rss >>= 8;
+	}
+	// Values change every tick, also without a new tick sample (CPU, RSS)
+	uint64_t seq = ++mSeq;
+	pthread_mutex_unlock(&mMutex);
+	return seq;
+}
@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SELFMONITORINGSENSORPROVIDER_H_
+#define SELFMONITORINGSENSORPROVIDER_H_
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "RawSensorProvider.h"
+#include "ProcFile.h"
+
+using namespace std;
+
+// Health of the daemon itself as sensor group "Daemon": tick duration and
+// jitter, time spent on the communicator and holding its mutex, CPU time,
+// RSS and how long management takes to pick up replies. Fed by Daemon, the
+// record is built once per message. Thread safe, the communicator is also
+// used from plugin threads.
+class SelfMonitoringSensorProvider: public RawSensorProvider {
+public:
+	explicit SelfMonitoringSensorProvider(size_t window);
+	virtual ~SelfMonitoringSensorProvider();
+
+	// Durations in ns
+	void recordTick(uint64_t work, uint64_t period, uint64_t interval);
+	void recordCommRead(uint64_t wait, uint64_t duration);
+	void recordCommWrite(uint64_t wait, uint64_t duration);
+	void recordPickup(uint64_t delay);
+
+	const char* getSensorsDescription(void);
+	size_t getRecordSize(void);
+	uint64_t readLatest(uint8_t* buffer);
+
+private:
+	// Last samples for percentiles
+	class SampleWindow {
+	public:
+		explicit SampleWindow(size_t size) : mSamples(), mSize(size), mNext(0) {
+		}
+		void add(double value);
+		double percentile(double fraction) const;
+
+	private:
+		vector<double> mSamples;
+		size_t mSize;
+		size_t mNext;
+	};
+
+	//lint -e(1704)
+	SelfMonitoringSensorProvider(const SelfMonitoringSensorProvider& cSource);
+	SelfMonitoringSensorProvider& operator=(const SelfMonitoringSensorProvider& cSource);
+
+	void readProcess(double& cpuPercent, double& cpuTime, uint64_t& rss);
+
+	SampleWindow mTicks;
+	SampleWindow mJitter;
+	SampleWindow mReads;
+	SampleWindow mWrites;
+	double mLastTick;
+	double mLockHeld; // During the last tick
+	double mLockWait;
+	double mLockHeldCurrent;
+	double mLockWaitCurrent;
+	double mPickupDelay;
+	double mLastCpuTime;
+	uint64_t mLastCpuSample;
+	ProcFile mStatm;
+	uint64_t mSeq;
+	pthread_mutex_t mMutex;
+};
+
+#endif /* SELFMONITORINGSENSORPROVIDER_H_ */
@@ -34,10 +34,13 @@
 #include "plugin_models/JSONSensorProviderFactory.h"
 #include "../include/daemon_msgs.h"
 #include "JSONSensorsParser.h"
+#include "Tracer.h"
+#include "../include/SensorBean.h"
 
 LoggerPtr SensorSet::logger(Logger::getLogger("SensorSet"));
 
-SensorSet::SensorSet() {
+SensorSet::SensorSet() : mSize(0), mRequiredSize(0), mData(NULL), mMessageValid(false), mTickEntry(NULL), mLastTickNs(0), mSlowest(NULL), mSlowestNs(0) {
+	pthread_mutex_init(&mMutex, NULL);
 	int cnt = Config::GetInstance()->GetInt("Sensors", "count", 0);
 	LOG_INFO(logger, cnt << " manual sensors configured");
 	for (uint16_t i = 0; i < cnt; ++i) {
@@ -90,7 +93,12 @@ SensorSet::SensorSet() {
 				mSensorMap.insert(map.begin(), map.end());
 				LOG_INFO(logger, "Added " << map.size() << " sensors");
 
-				delete SensorProvider;
+				if (IDynamicSensorProvider* dynamicProvider = dynamic_cast<IDynamicSensorProvider*>(SensorProvider)) {
+					mDynamicProviders.push_back(dynamicProvider);
+					mDynamicProviderEntries.push_back(mProfiler.getEntry(pluginName + " (poll)"));
+				} else {
+					delete SensorProvider;
+				}
 			}
 		}
 	}
@@ -103,37 +111,146 @@ SensorSet::SensorSet() {
 			LOG_INFO(logger, "Enabling JSON sensor provider " << pluginName);
 			IJSONSensorProvider* JSONSensorProvider = JSONSensorProviderFactory::createJSONSensorProvider(pluginName);
 
-			if (JSONSensorProvider != NULL) {
-				addJSONSensorProvider(JSONSensorProvider, pluginName);
+			if (JSONSensorProvider != NULL && !addJSONSensorProvider(JSONSensorProvider, pluginName)) {
+				LOG_ERROR(logger, "Could not add JSON sensor provider " << pluginName);
+				delete JSONSensorProvider;
 			}
 		}
 	}
 
+	if (Config::GetInstance()->GetBoolean("Profile", "sensors", false)) {
+		addProfileSensors();
+	}
+
 	mSize = sizeof(Monitoring_Data_Header);
 	for (SensorMap::iterator iterator = mSensorMap.begin(); iterator != mSensorMap.end(); ++iterator) {
 		mSize += iterator->second->getMaxDataSize();
 	}
+	mRequiredSize = mSize;
 	mData = (uint8_t*)malloc(mSize);
 }
 
+void SensorSet::addProfileSensors() {
+	SensorBean* sensor = new SensorBean("Profile tick time", TYPE_U32, 4, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData((uint32_t)0);
+	sensor->mTag = this;
+	sensor->setUpdateCallback(&SensorSet::updateProfileSensor);
+	mSensorMap[sensor->getName()] = sensor;
+
+	sensor = new SensorBean("Profile slowest", TYPE_STR, 48, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData(string(""));
+	sensor->mTag = this;
+	sensor->setUpdateCallback(&SensorSet::updateProfileSensor);
+	mSensorMap[sensor->getName()] = sensor;
+}
+
+void SensorSet::updateProfileSensor(SensorBean* sensor) {
+	// Values of the previous tick, the current one is not complete yet
+	SensorSet* set = static_cast<SensorSet*>(sensor->mTag);
+	if (sensor->getDataType() == TYPE_U32) {
+		sensor->setData((uint32_t)(set->mLastTickNs / 1000)); // us
+	} else {
+		sensor->setData(set->getSlowest());
+	}
+}
+
+string SensorSet::getSlowest() {
+	if (mSlowest == NULL) {
+		return "";
+	}
+	std::ostringstream oss;
+	oss << mSlowest->getName() << " " << mSlowestNs / 1000 << " us";
+	return oss.str();
+}
+
 bool SensorSet::addJSONSensorProvider(IJSONSensorProvider* provider, string name) {
+	pthread_mutex_lock(&mMutex);
 	if (mJSONSensorsParsers.find(name) != mJSONSensorsParsers.end()) {
+		LOG_ERROR(logger, "Sensor group '" << name << "' already exists");
+		pthread_mutex_unlock(&mMutex);
 		return false;
 	}
 	JSONSensorsParser* jsonSensors = new JSONSensorsParser(provider, name);
 	SensorMap map = jsonSensors->getSensors();
+	bool valid = jsonSensors->isValid();
+	for (SensorMap::iterator iterator = map.begin(); valid && iterator != map.end(); ++iterator) {
+		if (mSensorMap.find(iterator->first) != mSensorMap.end()) {
+			LOG_ERROR(logger, "Sensor '" << iterator->first << "' of group '" << name << "' already exists");
+			valid = false;
+		}
+	}
+	if (!valid) {
+		// Would never get (all) values, refuse the group. Caller keeps the provider
+		for (SensorMap::iterator iterator = map.begin(); iterator != map.end(); ++iterator) {
+			delete iterator->second;
+		}
+		jsonSensors->releaseProvider();
+		delete jsonSensors;
+		pthread_mutex_unlock(&mMutex);
+		return false;
+	}
 	mSensorMap.insert(map.begin(), map.end());
 	mJSONSensorsParsers[name] = jsonSensors;
 	LOG_INFO(logger, "Added " << map.size() << " sensors");
+
+	// Groups added at runtime enlarge the data message, buffer is resized by the next getMessage()
+	for (SensorMap::iterator iterator = map.begin(); iterator != map.end(); ++iterator) {
+		mRequiredSize += iterator->second->getMaxDataSize();
+	}
+	mMessageValid = false;
+	pthread_mutex_unlock(&mMutex);
 	return true;
 }
 
 IJSONSensorProvider* SensorSet::getJSONSensorProvider(std::string name) {
+	IJSONSensorProvider* provider = NULL;
+	pthread_mutex_lock(&mMutex);
 	JSONParsersMap::iterator iter = mJSONSensorsParsers.find(name);
 	if (iter != mJSONSensorsParsers.end()) {
-		return iter->second->getProvider();
+		provider = iter->second->getProvider();
+	}
+	pthread_mutex_unlock(&mMutex);
+	return provider;
+}
+
+bool SensorSet::updateDynamicSensors() {
+	bool changed = false;
+	pthread_mutex_lock(&mMutex);
+	for (size_t i = 0; i < mDynamicProviders.size(); ++i) {
+		IDynamicSensorProvider* provider = mDynamicProviders[i];
+		SensorMap added;
+		std::vector<std::string> removed;
+		bool providerChanged;
+		{
+			Profiler::Scope scope(mProfiler.isEnabled() ? mDynamicProviderEntries[i] : NULL);
+			Tracer::Span span("poll", mDynamicProviderEntries[i]->getName().c_str());
+			providerChanged = provider->pollSensorChanges(added, removed);
+		}
+		if (!providerChanged) {
+			continue;
+		}
+		changed = true;
+		mMessageValid = false;
+		for (std::vector<std::string>::iterator name = removed.begin(); name != removed.end(); ++name) {
+			SensorMap::iterator iterator = mSensorMap.find(*name);
+			if (iterator != mSensorMap.end()) {
+				mRequiredSize -= iterator->second->getMaxDataSize();
+				delete iterator->second;
+				mSensorMap.erase(iterator);
+			}
+		}
+		for (SensorMap::iterator iterator = added.begin(); iterator != added.end(); ++iterator) {
+			if (!mSensorMap.insert(*iterator).second) {
+				LOG_ERROR(logger, "Sensor '" << iterator->first << "' already exists, ignoring");
+				delete iterator->second;
+				continue;
+			}
+			mRequiredSize += iterator->second->getMaxDataSize();
+		}
+		LOG_INFO(logger, "Sensors changed at runtime: " << added.size() << " added, " << removed.size() << " removed");
 	}
-	return NULL;
+	pthread_mutex_unlock(&mMutex);
+	return changed;
 }
 
 size_t SensorSet::getSize() {
@@ -141,30 +258,77 @@ size_t SensorSet::getSize() {
 }
 
 uint8_t* SensorSet::getMessage() {
+	pthread_mutex_lock(&mMutex);
+	if (mRequiredSize != mSize) {
+		mData = (uint8_t*)realloc(mData, mRequiredSize);
+		mSize = mRequiredSize;
+		mMessageValid = false;
+	}
+
 	Monitoring_Data_Header* header = (Monitoring_Data_Header*)mData;
 	header->header.type = Monitoring_Data;
 	header->header.size = htons(mSize);
 	header->flags = 0;
 	header->sensorCnt = htons(mSensorMap.size());
 
+	bool profile = mProfiler.isEnabled();
+	uint64_t tickStart = 0;
+	if (profile) {
+		if (!mMessageValid) {
+			updateProfileEntries();
+		}
+		tickStart = Profiler::now();
+	}
+
 	// Update JSON sensors
-	for (JSONParsersMap::iterator iterator = mJSONSensorsParsers.begin(); iterator != mJSONSensorsParsers.end(); ++iterator) {
+	size_t index = 0;
+	for (JSONParsersMap::iterator iterator = mJSONSensorsParsers.begin(); iterator != mJSONSensorsParsers.end(); ++iterator, ++index) {
+		Profiler::Scope scope(profile ? mParserEntries[index] : NULL);
+		Tracer::Span span("update", iterator->first.c_str());
 		iterator->second->updateSensors();
 	}
 
 	size_t offset = sizeof(Monitoring_Data_Header);
-	for (SensorMap::iterator iterator = mSensorMap.begin(); iterator != mSensorMap.end(); ++iterator) {
-		bool ret = iterator->second->getData(&mData[offset]);
+	uint64_t slowestNs = 0;
+	Profiler::Entry* slowest = NULL;
+	index = 0;
+	for (SensorMap::iterator iterator = mSensorMap.begin(); iterator != mSensorMap.end(); ++iterator, ++index) {
 		size_t len = iterator->second->getMaxDataSize();
-		if (!ret) {
-			memset(&mData[offset], 0, len);
+		// Offsets are only stable as long as the sensor map does not change
+		if (!mMessageValid || !iterator->second->isStatic() || iterator->second->hasChanged()) {
+			Tracer::Span span("sensor", iterator->first.c_str());
+			uint64_t start = profile ? Profiler::now() : 0;
+			if (!iterator->second->getData(&mData[offset])) {
+				memset(&mData[offset], 0, len);
+			}
+			if (profile) {
+				uint64_t duration = Profiler::now() - start;
+				mSensorEntries[index]->record(duration);
+				if (duration >= slowestNs) {
+					slowestNs = duration;
+					slowest = mSensorEntries[index];
+				}
+			}
 		}
 		offset += len;
 	}
+	mMessageValid = true;
+
+	if (profile) {
+		mLastTickNs = Profiler::now() - tickStart;
+		if (slowest != NULL) {
+			mSlowest = slowest;
+			mSlowestNs = slowestNs;
+		}
+		mTickEntry->record(mLastTickNs);
+		mProfiler.tick();
+	}
+	pthread_mutex_unlock(&mMutex);
 	return mData;
 }
 
 size_t SensorSet::getDescriptionPage(uint8_t* buffer, size_t bufferSize, uint8_t page, uint8_t* maxPages) {
+	pthread_mutex_lock(&mMutex);
 	uint16_t sensorCnt = mSensorMap.size();
 	bufferSize -= sizeof(Monitoring_Description_Header);
 	size_t offset = sizeof(Monitoring_Description_Header);
@@ -220,10 +384,50 @@ size_t SensorSet::getDescriptionPage(uint8_t* buffer, size_t bufferSize, uint8_t
 	header->maxPages = *maxPages;
 	header->sensorEntries = sensorsOnPage;
 	header->startIndex = htons(startingSensor);
+	pthread_mutex_unlock(&mMutex);
 
 	return offset;
 }
 
+void SensorSet::updateProfileEntries() {
+	mSensorEntries.clear();
+	for (SensorMap::iterator iterator = mSensorMap.begin(); iterator != mSensorMap.end(); ++iterator) {
+		mSensorEntries.push_back(mProfiler.getEntry(iterator->first));
+	}
+	mParserEntries.clear();
+	for (JSONParsersMap::iterator iterator = mJSONSensorsParsers.begin(); iterator != mJSONSensorsParsers.end(); ++iterator) {
+		mParserEntries.push_back(mProfiler.getEntry(iterator->first + " (update)"));
+	}
+	mTickEntry = mProfiler.getEntry("(tick)");
+}
+
+void SensorSet::setProfiling(bool enabled) {
+	pthread_mutex_lock(&mMutex);
+	mProfiler.setEnabled(enabled);
+	// Entries are updated with the next message
+	mMessageValid = false;
+	pthread_mutex_unlock(&mMutex);
+}
+
+void SensorSet::resetProfile() {
+	pthread_mutex_lock(&mMutex);
+	mProfiler.reset();
+	pthread_mutex_unlock(&mMutex);
+}
+
+string SensorSet::getProfileReport() {
+	pthread_mutex_lock(&mMutex);
+	string report;
+	if (mProfiler.isEnabled()) {
+		report = mProfiler.getReport();
+		if (mSlowest != NULL) {
+			report += "Slowest sensor of last tick: " + getSlowest() + "\n";
+		}
+	}
+	pthread_mutex_unlock(&mMutex);
+	return report;
+}
+
 uint8_t SensorSet::getGroupId(const char* name) {
 	if (name[0] == '\0') { // Empty string -> no group
 		return 0;
@@ -244,6 +448,7 @@ uint8_t SensorSet::getGroupId(const char* name) {
 }
 
 void SensorSet::clear() {
+	pthread_mutex_lock(&mMutex);
 	for (SensorMap::iterator iterator = mSensorMap.begin(); iterator != mSensorMap.end(); ++iterator) {
 		delete iterator->second;
 	}
@@ -254,10 +459,20 @@ void SensorSet::clear() {
 	}
 	mJSONSensorsParsers.clear();
 
+	for (std::vector<IDynamicSensorProvider*>::iterator iterator = mDynamicProviders.begin(); iterator != mDynamicProviders.end(); ++iterator) {
+		delete *iterator;
+	}
+	mDynamicProviders.clear();
+	mDynamicProviderEntries.clear();
+
 	mKnownGroups.clear();
+	mRequiredSize = sizeof(Monitoring_Data_Header);
+	mMessageValid = false;
+	pthread_mutex_unlock(&mMutex);
 }
 
 SensorSet::~SensorSet() {
 	clear();
 	free(mData);
+	pthread_mutex_destroy(&mMutex);
 }
@@ -30,9 +30,12 @@
 #include <logger.h>
 #include <map>
 #include <vector>
+#include <pthread.h>
 #include "../include/object_model.h"
+#include "Profiler.h"
 
 class JSONSensorsParser;
+class SensorBean;
 
 class SensorSet {
 	typedef std::map<std::string, ISensor* > SensorMap;
@@ -43,6 +46,7 @@ public:
 	virtual ~SensorSet();
 
 	bool addJSONSensorProvider(IJSONSensorProvider* provider, std::string name);
+	bool updateDynamicSensors();
 	IJSONSensorProvider* getJSONSensorProvider(std::string name);
 
 	size_t getSize();
@@ -50,18 +54,40 @@ public:
 	size_t getDescriptionPage(uint8_t* buffer, size_t bufferSize, uint8_t page, uint8_t* maxPages);
 	void clear();
 
+	void setProfiling(bool enabled);
+	void resetProfile();
+	std::string getProfileReport();
+
 private:
 	//lint -e(1704)
 	SensorSet(const SensorSet& cSource);
 	SensorSet& operator=(const SensorSet& cSource);
 
 	uint8_t getGroupId(const char* name);
+	void addProfileSensors();
+	void updateProfileEntries();
+	std::string getSlowest();
+	static void updateProfileSensor(SensorBean* sensor);
 
 	SensorMap mSensorMap;
 	JSONParsersMap mJSONSensorsParsers;
+	std::vector<IDynamicSensorProvider*> mDynamicProviders;
+	std::vector<Profiler::Entry*> mDynamicProviderEntries;
 	std::map<std::string, int> mKnownGroups;
 	size_t mSize;
+	size_t mRequiredSize;
 	uint8_t* mData;
+	bool mMessageValid; // Static sensor data in mData is up to date
+	Profiler mProfiler;
+	// In the order of mSensorMap and mJSONSensorsParsers, updated with the message layout
+	std::vector<Profiler::Entry*> mSensorEntries;
+	std::vector<Profiler::Entry*> mParserEntries;
+	Profiler::Entry* mTickEntry;
+	uint64_t mLastTickNs;
+	// Formatted only when read
+	Profiler::Entry* mSlowest;
+	uint64_t mSlowestNs;
+	pthread_mutex_t mMutex; // Sensor groups can be added from network threads
 
 	static LoggerPtr logger;
 };
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "SharedMemorySensorProvider.h"
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+LoggerPtr SharedMemorySensorProvider::logger(Logger::getLogger("SharedMemorySensorProvider"));
+
+SharedMemorySensorProvider::SharedMemorySensorProvider(string shmName) :
+	mShmName(shmName), mSensorsDescription(""), mRing(NULL), mMappedSize(0) {
+	memset(&mGeometry, 0, sizeof(mGeometry));
+#ifndef WIN32
+	int fd = shm_open(mShmName.c_str(), O_RDONLY, 0);
+	if (fd < 0) {
+		LOG_ERROR(logger, "Could not open shared memory segment '" << mShmName << "'");
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmSensorRing_Header)) {
+		LOG_ERROR(logger, "Shared memory segment '" << mShmName << "' too small for ring header");
+		close(fd);
+		return;
+	}
+	void* mem = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd); // Mapping stays valid
+	if (mem == MAP_FAILED) {
+		LOG_ERROR(logger, "Could not map shared memory segment '" << mShmName << "'");
+		return;
+	}
+	mMappedSize = st.st_size;
+	mRing = (ShmSensorRing_Header*)mem;
+
+	bool headerValid = __atomic_load_n(&mRing->magic, __ATOMIC_ACQUIRE) == SHM_RING_MAGIC && mRing->version == SHM_RING_VERSION;
+	// Read the header fields once, the producer may still change them
+	mGeometry = shmRingGeometry(mRing);
+	uint32_t descriptionOffset = mRing->descriptionOffset;
+	uint32_t descriptionLength = mRing->descriptionLength;
+	if (!headerValid) {
+		LOG_ERROR(logger, "Shared memory segment '" << mShmName << "' has no valid ring header");
+	} else if (!shmRingGeometryValid(&mGeometry, mMappedSize) ||
+			(uint64_t)descriptionOffset + descriptionLength >= mMappedSize) {
+		LOG_ERROR(logger, "Shared memory segment '" << mShmName << "' has inconsistent ring geometry");
+	} else {
+		mSensorsDescription = string((const char*)mRing + descriptionOffset, descriptionLength);
+		LOG_INFO(logger, "Attached to '" << mShmName << "': " << mGeometry.slotCount << " slots of " << mGeometry.recordSize << " bytes");
+		return;
+	}
+	memset(&mGeometry, 0, sizeof(mGeometry));
+	munmap(mRing, mMappedSize);
+	mRing = NULL;
+	mMappedSize = 0;
+#else
+	LOG_ERROR(logger, "Shared memory sensor rings are not supported on this platform");
+#endif
+}
+
+SharedMemorySensorProvider::~SharedMemorySensorProvider() {
+#ifndef WIN32
+	if (mRing != NULL) {
+		munmap(mRing, mMappedSize);
+		mRing = NULL;
+	}
+#endif
+}
+
+bool SharedMemorySensorProvider::isAttached(void) {
+	return mRing != NULL;
+}
+
+const char* SharedMemorySensorProvider::getSensorsDescription(void) {
+	return mSensorsDescription.c_str();
+}
+
+size_t SharedMemorySensorProvider::getRecordSize(void) {
+	if (mRing == NULL) {
+		return 0;
+	}
+	return mGeometry.recordSize;
+}
+
+uint64_t SharedMemorySensorProvider::readLatest(uint8_t* buffer) {
+	if (mRing == NULL) {
+		return 0;
+	}
+	return shmRingReadLatest(mRing, &mGeometry, buffer);
+}
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SHAREDMEMORYSENSORPROVIDER_H_
+#define SHAREDMEMORYSENSORPROVIDER_H_
+
+#include <string>
+#include <logger.h>
+#include <ShmSensorRing.h>
+#include "RawSensorProvider.h"
+
+using namespace std;
+
+// Sensor group fed by a local producer through a shared memory ring (see
+// ShmSensorRing.h). The description is taken from the segment once, values
+// are copied by JSONSensorsParser directly from the latest record.
+class SharedMemorySensorProvider: public RawSensorProvider {
+public:
+	SharedMemorySensorProvider(string shmName);
+	virtual ~SharedMemorySensorProvider();
+
+	bool isAttached(void);
+
+	const char* getSensorsDescription(void);
+
+	size_t getRecordSize(void);
+	uint64_t readLatest(uint8_t* buffer);
+
+private:
+	//lint -e(1704)
+	SharedMemorySensorProvider(const SharedMemorySensorProvider& cSource);
+	SharedMemorySensorProvider& operator=(const SharedMemorySensorProvider& cSource);
+
+	string mShmName;
+	string mSensorsDescription;
+	ShmSensorRing_Header* mRing;
+	ShmSensorRing_Geometry mGeometry; // Validated at attach, the header may change afterwards
+	size_t mMappedSize;
+
+	static LoggerPtr logger;
+};
+
+#endif /* SHAREDMEMORYSENSORPROVIDER_H_ */
@@ -0,0 +1,207 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Tracer.h"
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define TRACE_FLUSH_INTERVAL	100 // ms
+
+Tracer* Tracer::sInstance = NULL;
+LoggerPtr Tracer::logger(Logger::getLogger("Tracer"));
+
+Tracer::Tracer(FILE* file) :
+	mFile(file), mFirstEvent(true), mStartTime(Profiler::now()), mPid(getpid()), mBuffers(NULL), mNextTid(1), mRunning(true) {
+	pthread_key_create(&mKey, NULL);
+	pthread_mutex_init(&mBuffersMutex, NULL);
+	fputs("{\"traceEvents\":[\n", mFile);
+}
+
+Tracer::~Tracer() {
+	while (mBuffers != NULL) {
+		ThreadBuffer* buffer = mBuffers;
+		mBuffers = buffer->next;
+		free(buffer);
+	}
+	pthread_mutex_destroy(&mBuffersMutex);
+	pthread_key_delete(mKey);
+}
+
+bool Tracer::Start(const std::string& path) {
+	if (sInstance != NULL) {
+		return false;
+	}
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == NULL) {
+		LOG_ERROR(logger, "Could not open trace file " << path);
+		return false;
+	}
+	Tracer* tracer = new Tracer(file);
+	if (pthread_create(&tracer->mThread, NULL, &Tracer::flushThread, tracer) != 0) {
+		LOG_ERROR(logger, "Could not start trace flush thread");
+		fclose(file);
+		delete tracer;
+		return false;
+	}
+	sInstance = tracer;
+	setThreadName("main");
+	LOG_INFO(logger, "Writing trace to " << path);
+	return true;
+}
+
+void Tracer::Stop(void) {
+	Tracer* tracer = sInstance;
+	if (tracer == NULL) {
+		return;
+	}
+	sInstance = NULL;
+	tracer->mRunning = false;
+	pthread_join(tracer->mThread, NULL);
+	tracer->drain();
+
+	uint32_t dropped = 0;
+	for (ThreadBuffer* buffer = tracer->mBuffers; buffer != NULL; buffer = buffer->next) {
+		dropped += buffer->dropped;
+		if (buffer->name[0] != '\0') {
+			fprintf(tracer->mFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":", tracer->mFirstEvent ? "" : ",\n", tracer->mPid, buffer->tid);
+			tracer->writeString(buffer->name);
+			fputs("}}", tracer->mFile);
+			tracer->mFirstEvent = false;
+		}
+	}
+	fputs("\n],\"displayTimeUnit\":\"ms\"}\n", tracer->mFile);
+	fclose(tracer->mFile);
+	if (dropped > 0) {
+		LOG_WARN(logger, dropped << " trace events were dropped because the buffers were full");
+	}
+	delete tracer;
+}
+
+void Tracer::setThreadName(const char* name) {
+	Tracer* tracer = sInstance;
+	if (tracer == NULL) {
+		return;
+	}
+	ThreadBuffer* buffer = tracer->getThreadBuffer();
+	if (buffer != NULL) {
+		strncpy(buffer->name, name, TRACE_NAME_LENGTH - 1);
+	}
+}
+
+void Tracer::record(const char* category, const char* name, uint64_t start, uint64_t duration) {
+	Tracer* tracer = sInstance;
+	if (tracer == NULL) {
+		return;
+	}
+	ThreadBuffer* buffer = tracer->getThreadBuffer();
+	if (buffer == NULL) {
+		return;
+	}
+	uint32_t head = buffer->head;
+	if (head - buffer->tail >= TRACE_BUFFER_EVENTS) {
+		buffer->dropped++;
+		return;
+	}
+	Event& event = buffer->events[head % TRACE_BUFFER_EVENTS];
+	event.start = start;
+	event.duration = duration;
+	event.category = category;
+	strncpy(event.name, name, TRACE_NAME_LENGTH - 1);
+	event.name[TRACE_NAME_LENGTH - 1] = '\0';
+	// Event must be complete before the flush thread sees it
+	__sync_synchronize();
+	buffer->head = head + 1;
+}
+
+Tracer::ThreadBuffer* Tracer::getThreadBuffer(void) {
+	ThreadBuffer* buffer = (ThreadBuffer*)pthread_getspecific(mKey);
+	if (buffer != NULL) {
+		return buffer;
+	}
+	// First event of this thread
+	buffer = (ThreadBuffer*)calloc(1, sizeof(ThreadBuffer));
+	if (buffer == NULL) {
+		return NULL;
+	}
+	pthread_mutex_lock(&mBuffersMutex);
+	buffer->tid = mNextTid++;
+	buffer->next = mBuffers;
+	mBuffers = buffer;
+	pthread_mutex_unlock(&mBuffersMutex);
+	pthread_setspecific(mKey, buffer);
+	return buffer;
+}
+
+void Tracer::drain(void) {
+	pthread_mutex_lock(&mBuffersMutex);
+	ThreadBuffer* buffers = mBuffers;
+	pthread_mutex_unlock(&mBuffersMutex);
+
+	// New buffers are only ever prepended, the list behind its head is stable
+	for (ThreadBuffer* buffer = buffers; buffer != NULL; buffer = buffer->next) {
+		uint32_t head = buffer->head;
+		__sync_synchronize();
+		for (uint32_t tail = buffer->tail; tail != head; ++tail) {
+			const Event& event = buffer->events[tail % TRACE_BUFFER_EVENTS];
+			uint64_t start = event.start > mStartTime ? event.start - mStartTime : 0;
+			fprintf(mFile, "%s{\"name\":", mFirstEvent ? "" : ",\n");
+			writeString(event.name);
+			fprintf(mFile, ",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%llu.%03u,\"dur\":%llu.%03u}",
+				event.category, mPid, buffer->tid,
+				(unsigned long long)(start / 1000), (unsigned int)(start % 1000),
+				(unsigned long long)(event.duration / 1000), (unsigned int)(event.duration % 1000));
+			mFirstEvent = false;
+		}
+		// Slots may only be reused once they are written out
+		__sync_synchronize();
+		buffer->tail = head;
+	}
+	fflush(mFile);
+}
+
+void Tracer::writeString(const char* str) {
+	fputc('"', mFile);
+	for (const char* p = str; *p != '\0'; ++p) {
+		if (*p == '"' || *p == '\\') {
+			fputc('\\', mFile);
+			fputc(*p, mFile);
+		} else if ((unsigned char)*p < 0x20) {
+			fprintf(mFile, "\\u%04x", (unsigned char)*p);
+		} else {
+			fputc(*p, mFile);
+		}
+	}
+	fputc('"', mFile);
+}
+
+void* Tracer::flushThread(void* arg) {
+	Tracer* tracer = (Tracer*)arg;
+	while (tracer->mRunning) {
+		usleep(TRACE_FLUSH_INTERVAL * 1000);
+		tracer->drain();
+	}
+	return NULL;
+}
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACER_H_
+#define TRACER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <pthread.h>
+#include <logger.h>
+#include "Profiler.h"
+
+#define TRACE_BUFFER_EVENTS	16384 // Per thread, events are dropped when full
+#define TRACE_NAME_LENGTH	48
+
+// Records spans of the main loop in Chrome/Perfetto trace event format
+// (--trace <file>). Every thread writes into its own ring buffer without
+// locking, a background thread drains the buffers into the file.
+class Tracer {
+public:
+	// Scoped span, does nothing while tracing is off. Category must be a
+	// string literal, the name is copied.
+	class Span {
+	public:
+		Span(const char* category, const char* name) : mCategory(category), mName(name), mStart(isEnabled() ? Profiler::now() : 0) {
+		}
+
+		~Span() {
+			if (mStart != 0) {
+				record(mCategory, mName, mStart, Profiler::now() - mStart);
+			}
+		}
+
+	private:
+		//lint -e(1704)
+		Span(const Span& cSource);
+		Span& operator=(const Span& cSource);
+
+		const char* mCategory;
+		const char* mName;
+		uint64_t mStart;
+	};
+
+	// The calling thread is named "main" in the trace
+	static bool Start(const std::string& path);
+	// Only call when no other thread records anymore
+	static void Stop(void);
+
+	static bool isEnabled(void) {
+		return sInstance != NULL;
+	}
+
+	static void setThreadName(const char* name);
+	static void record(const char* category, const char* name, uint64_t start, uint64_t duration);
+
+private:
+	struct Event {
+		uint64_t start;
+		uint64_t duration;
+		const char* category;
+		char name[TRACE_NAME_LENGTH];
+	};
+
+	// Single producer (owning thread), single consumer (flush thread)
+	struct ThreadBuffer {
+		Event events[TRACE_BUFFER_EVENTS];
+		volatile uint32_t head;
+		volatile uint32_t tail;
+		volatile uint32_t dropped;
+		uint32_t tid;
+		char name[TRACE_NAME_LENGTH];
+		ThreadBuffer* next;
+	};
+
+	explicit Tracer(FILE* file);
+	~Tracer();
+
+	//lint -e(1704)
+	Tracer(const Tracer& cSource);
+	Tracer& operator=(const Tracer& cSource);
+
+	ThreadBuffer* getThreadBuffer(void);
+	void drain(void);
+	void writeString(const char* str);
+	static void* flushThread(void* arg);
+
+	static Tracer* sInstance;
+	static LoggerPtr logger;
+
+	FILE* mFile;
+	bool mFirstEvent;
+	uint64_t mStartTime;
+	int mPid;
+	pthread_key_t mKey;
+	pthread_mutex_t mBuffersMutex;
+	ThreadBuffer* volatile mBuffers;
+	uint32_t mNextTid;
+	volatile bool mRunning;
+	pthread_t mThread;
+};
+
+#endif /* TRACER_H_ */
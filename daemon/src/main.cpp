@@ -31,6 +31,7 @@
 
 #include "version.h"
 #include "Daemon.h"
+#include "Tracer.h"
 
 using namespace std;
 
@@ -42,19 +43,31 @@ int main(int argc, char **argv) {
     // Loop over command-line args
 	vector<string> args(argv + 1, argv + argc);
 	int exitAfter = 0;
+	string traceFile;
     for (vector<string>::iterator i = args.begin(); i != args.end(); ++i) {
         if (*i == "-h" || *i == "--help") {
-            cout << "Syntax: RECSDaemon [-exitAfter n]" << endl;
+            cout << "Syntax: RECSDaemon [-exitAfter n] [--trace file]" << endl;
             return 0;
         } else if (*i == "-exitAfter") {
-        	++i;
-        	if (i != args.end()) {
-				istringstream(*i) >> exitAfter;
-				LOG_INFO(logger, "exitAfter set, will exit after " << exitAfter << " update iterations");
+        	if (i + 1 == args.end()) {
+        		cerr << "Syntax: RECSDaemon [-exitAfter n] [--trace file]" << endl;
+        		return 1;
         	}
+        	istringstream(*++i) >> exitAfter;
+        	LOG_INFO(logger, "exitAfter set, will exit after " << exitAfter << " update iterations");
+        } else if (*i == "--trace") {
+        	if (i + 1 == args.end()) {
+        		cerr << "Syntax: RECSDaemon [-exitAfter n] [--trace file]" << endl;
+        		return 1;
+        	}
+        	traceFile = *++i;
         }
     }
 
+	if (!traceFile.empty()) {
+		Tracer::Start(traceFile);
+	}
 	int ret = (new Daemon())->run(exitAfter);
+	Tracer::Stop();
 	return ret;
 }
@@ -0,0 +1,242 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WIN32
+
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "MetricsServer.h"
+#include "../Config.h"
+#include "../../include/daemon_msgs.h"
+
+#define UNUSED(x) (void)(x)
+
+#define BATCH_SIZE			32
+#define DATAGRAM_LENGTH		1472 // Fits into one Ethernet frame
+#define RECEIVE_TIMEOUT		200 // ms
+
+LoggerPtr MetricsServer::logger(Logger::getLogger("MetricsServer"));
+
+MetricsServer::MetricsServer(Node* node, Daemon* daemon, uint16_t port)
+	: mSocket(-1), mNode(node), mDaemon(daemon), mGroups() {
+	mMaxGroups = Config::GetInstance()->GetInt("Metrics", "maxGroups", 8);
+	mMaxSensorsPerGroup = Config::GetInstance()->GetInt("Metrics", "maxSensorsPerGroup", 32);
+	mGroupSettleTime = Config::GetInstance()->GetInt("Metrics", "groupSettleTime", 2000);
+
+	mSocket = socket(AF_INET, SOCK_DGRAM, 0);
+	if (mSocket < 0) {
+		LOG_ERROR(logger, "Unable to create socket!");
+		return;
+	}
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	if (bind(mSocket, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		LOG_ERROR(logger, "Unable to bind socket to port " << port << ": Error " << errno);
+		close(mSocket);
+		mSocket = -1;
+		return;
+	}
+	// Wake up regularly to register settled groups and to notice shutdown
+	struct timeval timeout;
+	timeout.tv_sec = 0;
+	timeout.tv_usec = RECEIVE_TIMEOUT * 1000;
+	setsockopt(mSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	LOG_DEBUG(logger, "Listening on UDP port " << port);
+	this->start(this);
+}
+
+MetricsServer::~MetricsServer() {
+	this->stop();
+	if (mSocket >= 0) {
+		close(mSocket);
+	}
+	// Registered providers are owned by the SensorSet
+	for (std::map<std::string, Group>::iterator iterator = mGroups.begin(); iterator != mGroups.end(); ++iterator) {
+		if (!iterator->second.registered) {
+			delete iterator->second.provider;
+		}
+	}
+}
+
+void MetricsServer::execute(void* arg) {
+	UNUSED(arg);
+	static char buffers[BATCH_SIZE][DATAGRAM_LENGTH + 1];
+	struct mmsghdr msgs[BATCH_SIZE];
+	struct iovec iovecs[BATCH_SIZE];
+
+	memset(msgs, 0, sizeof(msgs));
+	for (int i = 0; i < BATCH_SIZE; ++i) {
+		iovecs[i].iov_base = buffers[i];
+		iovecs[i].iov_len = DATAGRAM_LENGTH;
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while (IsRunning()) {
+		// Block for the first datagram, then take whatever else is queued
+		int cnt = recvmmsg(mSocket, msgs, BATCH_SIZE, MSG_WAITFORONE, NULL);
+		long now = getTimeMs();
+		for (int i = 0; i < cnt; ++i) {
+			parseDatagram(buffers[i], msgs[i].msg_len, now);
+		}
+		if (cnt < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+			LOG_ERROR(logger, "recvmmsg failed: Error " << errno);
+			break;
+		}
+		registerSettledGroups(now);
+	}
+}
+
+void MetricsServer::parseDatagram(char* data, size_t length, long now) {
+	data[length] = '\0';
+	char* line = data;
+	while (line != NULL && *line != '\0') {
+		char* next = strchr(line, '\n');
+		if (next != NULL) {
+			*next++ = '\0';
+		}
+		parseLine(line, now);
+		line = next;
+	}
+}
+
+void MetricsServer::parseLine(char* line, long now) {
+	// group.sensor:value|type[|@rate]
+	char* dot = strchr(line, '.');
+	char* colon = strrchr(line, ':');
+	char* pipe = colon != NULL ? strchr(colon, '|') : NULL;
+	if (dot == NULL || colon == NULL || pipe == NULL || dot > colon || dot == line || colon == dot + 1) {
+		return;
+	}
+	*dot = '\0';
+	*colon = '\0';
+	*pipe = '\0';
+	for (char* c = line; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\' || (unsigned char)*c < ' ') {
+			return; // Would break the JSON description
+		}
+	}
+	for (char* c = dot + 1; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\' || (unsigned char)*c < ' ') {
+			return;
+		}
+	}
+	if (strlen(dot + 1) > SENSOR_NAME_LENGTH) {
+		return;
+	}
+
+	char* end;
+	double value = strtod(colon + 1, &end);
+	if (end == colon + 1) {
+		return;
+	}
+
+	char* type = pipe + 1;
+	char* rate = strchr(type, '|');
+	if (rate != NULL) {
+		*rate++ = '\0';
+	}
+	MetricsSensorProvider::MetricType metricType;
+	if (strcmp(type, "g") == 0) {
+		metricType = MetricsSensorProvider::METRIC_GAUGE;
+	} else if (strcmp(type, "c") == 0) {
+		metricType = MetricsSensorProvider::METRIC_COUNTER;
+		if (rate != NULL && rate[0] == '@') {
+			double sampleRate = strtod(rate + 1, NULL);
+			if (sampleRate > 0.0) {
+				value /= sampleRate;
+			}
+		}
+	} else if (strcmp(type, "ms") == 0) {
+		metricType = MetricsSensorProvider::METRIC_TIMER;
+	} else {
+		return;
+	}
+
+	std::string groupName(line);
+	std::map<std::string, Group>::iterator iterator = mGroups.find(groupName);
+	if (iterator == mGroups.end()) {
+		if (mGroups.size() >= mMaxGroups) {
+			return;
+		}
+		LOG_INFO(logger, "New sensor group '" << groupName << "'");
+		Group group;
+		group.provider = new MetricsSensorProvider();
+		group.lastSensorCount = 0;
+		group.lastChange = now;
+		group.registered = false;
+		group.dropLogged = false;
+		iterator = mGroups.insert(std::pair<std::string, Group>(groupName, group)).first;
+	}
+	Group& group = iterator->second;
+	if (group.provider == NULL) {
+		return; // Group was rejected by the SensorSet
+	}
+	if (!group.provider->update(std::string(dot + 1), metricType, value, mMaxSensorsPerGroup) && !group.dropLogged) {
+		LOG_WARN(logger, "Dropping sensor '" << (dot + 1) << "' for group '" << groupName << "': group already registered or full");
+		group.dropLogged = true;
+	}
+}
+
+void MetricsServer::registerSettledGroups(long now) {
+	for (std::map<std::string, Group>::iterator iterator = mGroups.begin(); iterator != mGroups.end(); ++iterator) {
+		Group& group = iterator->second;
+		if (group.registered || group.provider == NULL) {
+			continue;
+		}
+		size_t count = group.provider->getSensorCount();
+		if (count != group.lastSensorCount) {
+			group.lastSensorCount = count;
+			group.lastChange = now;
+		} else if (now - group.lastChange >= mGroupSettleTime) {
+			group.provider->freeze();
+			if (mNode->getSensors()->addJSONSensorProvider(group.provider, iterator->first)) {
+				LOG_INFO(logger, "Registered sensor group '" << iterator->first << "' with " << count << " sensors");
+				group.registered = true;
+				mDaemon->resetStatemachine();
+			} else {
+				LOG_ERROR(logger, "Could not add sensors group '" << iterator->first << "', group or one of its metric names already exists!");
+				delete group.provider;
+				group.provider = NULL;
+			}
+		}
+	}
+}
+
+long MetricsServer::getTimeMs(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+#endif
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef METRICSSERVER_H_
+#define METRICSSERVER_H_
+
+#include <map>
+#include <string>
+#include <logger.h>
+#include "../Thread.h"
+#include "../Daemon.h"
+#include "../Node.h"
+#include "../MetricsSensorProvider.h"
+
+// Fire-and-forget ingestion of "group.sensor:value|type" lines via UDP.
+// Groups are created on first sight and registered with the SensorSet once
+// no new sensors showed up for groupSettleTime ms.
+class MetricsServer : public Thread {
+public:
+	MetricsServer(Node* node, Daemon* daemon, uint16_t port);
+	virtual ~MetricsServer();
+
+private:
+	struct Group {
+		MetricsSensorProvider* provider;
+		size_t lastSensorCount;
+		long lastChange; // ms
+		bool registered;
+		bool dropLogged;
+	};
+
+	//lint -e(1704)
+	MetricsServer(const MetricsServer& cSource);
+	MetricsServer& operator=(const MetricsServer& cSource);
+
+	void execute(void* arg);
+	void parseDatagram(char* data, size_t length, long now);
+	void parseLine(char* line, long now);
+	void registerSettledGroups(long now);
+	static long getTimeMs(void);
+
+	int mSocket;
+	Node* mNode;
+	Daemon* mDaemon;
+	std::map<std::string, Group> mGroups;
+	size_t mMaxGroups;
+	size_t mMaxSensorsPerGroup;
+	long mGroupSettleTime;
+
+	static LoggerPtr logger;
+};
+
+#endif /* METRICSSERVER_H_ */
@@ -25,15 +25,28 @@
 
 #include <algorithm>
 #include <string.h>
+#include <sstream>
+#include <vector>
 #include "TelnetServer.h"
 #include "../Config.h"
 #include "../StaticJSONSensorProvider.h"
+#include "../SharedMemorySensorProvider.h"
+#include "../BinarySensorProvider.h"
+#include "../MessagePack.h"
 
 #define UNUSED(x) (void)(x)
 
 #define BUFFER_LENGTH		1024
 #define CONNECTION_TIME_OUT	10 // s
 
+// Binary frame, distinguished from text commands by its first byte:
+// FRAME_MARKER | type u8 | name length u8 | payload length u32 big endian | name | payload
+#define FRAME_MARKER			0x01
+#define FRAME_HEADER_LENGTH		7
+#define FRAME_MAX_PAYLOAD		65536
+#define FRAME_ADDSENSORS		1 // MessagePack (or JSON) sensors description
+#define FRAME_UPDATESENSORS		2 // Packed record, encoded like in the Monitoring_Data message
+
 LoggerPtr CommandLineServer::logger(Logger::getLogger("TelnetServer"));
 
 CommandLineServer::CommandLineServer(Node* node, Daemon* daemon)
@@ -84,10 +97,22 @@ void CommandLineServer::CommandLineServerClient::execute(void* arg) {
 
 	char cmdBuffer[BUFFER_LENGTH] = { 0 };
 	while (true) {
-		if (readline(cmdBuffer, sizeof(cmdBuffer) - 1) == -1) {
+		char first;
+		if (mClient->receiveData(&first, (size_t)1) <= 0) {
+			break;
+		}
+		if (first == FRAME_MARKER) {
+			if (!handleBinaryFrame()) {
+				break;
+			}
+			continue;
+		}
+		if (readline(cmdBuffer, sizeof(cmdBuffer) - 1, first) == -1) {
 				break;
 		}
-		string cmd(cmdBuffer);
+		// Only the command word is case insensitive, parameters are taken from line
+		string line(cmdBuffer);
+		string cmd(line);
 		transform(cmd.begin(), cmd.end(), cmd.begin(), ::tolower);
 		//LOG_DEBUG(CommandLineServer::logger, "Received new command: '" << cmd << "'");
 
@@ -96,30 +121,30 @@ void CommandLineServer::CommandLineServerClient::execute(void* arg) {
 		} else if (cmd.substr(0, 7) == "monitor") {
 			mClient->sendData(mServer->getNode()->getJSONMonitoringData(mServer->getDaemon()));
 		} else if (cmd.substr(0, 11) == "addsensors ") {
-			size_t firstSpace = cmd.find(" ");
-			size_t secondSpace = cmd.find(" ", firstSpace + 1);
+			size_t firstSpace = line.find(" ");
+			size_t secondSpace = line.find(" ", firstSpace + 1);
 			if (firstSpace == string::npos || secondSpace == string::npos) {
 				mClient->sendData("Invalid parameters, expected addsensors <group name> <JSON data>\n");
 				continue;
 			}
-			string name = cmd.substr(firstSpace + 1, secondSpace - firstSpace - 1);
-			string description = cmd.substr(secondSpace + 1);
+			string name = line.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+			string description = line.substr(secondSpace + 1);
 			IJSONSensorProvider* provider = new StaticJSONSensorProvider(description);
 			if (mServer->getNode()->getSensors()->addJSONSensorProvider(provider, name)) {
 				mServer->getDaemon()->resetStatemachine();
 			} else {
 				delete provider;
-				mClient->sendData("Could not add sensors group '" + name + "', group already exists!\n");
+				mClient->sendData("Could not add sensors group '" + name + "', group or one of its sensors already exists, or it has an invalid description!\n");
 			}
 		} else if (cmd.substr(0, 14) == "updatesensors ") {
-			size_t firstSpace = cmd.find(" ");
-			size_t secondSpace = cmd.find(" ", firstSpace + 1);
+			size_t firstSpace = line.find(" ");
+			size_t secondSpace = line.find(" ", firstSpace + 1);
 			if (firstSpace == string::npos || secondSpace == string::npos) {
 				mClient->sendData("Invalid parameters, expected updatesensors <group name> <JSON data>\n");
 				continue;
 			}
-			string name = cmd.substr(firstSpace + 1, secondSpace - firstSpace - 1);
-			string data = cmd.substr(secondSpace + 1);
+			string name = line.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+			string data = line.substr(secondSpace + 1);
 			IJSONSensorProvider* provider = mServer->getNode()->getSensors()->getJSONSensorProvider(name);
 			if (provider == NULL) {
 				mClient->sendData("Could not update sensors group '" + name + "', group does not exist!\n");
@@ -130,6 +155,40 @@ void CommandLineServer::CommandLineServerClient::execute(void* arg) {
 					mClient->sendData("Could not update sensors group '" + name + "', group was not added via this interface!\n");
 				}
 			}
+		} else if (cmd.substr(0, 14) == "addshmsensors ") {
+			size_t firstSpace = line.find(" ");
+			size_t secondSpace = line.find(" ", firstSpace + 1);
+			if (firstSpace == string::npos || secondSpace == string::npos) {
+				mClient->sendData("Invalid parameters, expected addshmsensors <group name> <shared memory name>\n");
+				continue;
+			}
+			string name = line.substr(firstSpace + 1, secondSpace - firstSpace - 1);
+			string shmName = line.substr(secondSpace + 1);
+			SharedMemorySensorProvider* provider = new SharedMemorySensorProvider(shmName);
+			if (!provider->isAttached()) {
+				delete provider;
+				mClient->sendData("Could not attach to shared memory ring '" + shmName + "'!\n");
+			} else if (mServer->getNode()->getSensors()->addJSONSensorProvider(provider, name)) {
+				mServer->getDaemon()->resetStatemachine();
+			} else {
+				delete provider;
+				mClient->sendData("Could not add sensors group '" + name + "', group or one of its sensors already exists, or it has an invalid description!\n");
+			}
+		} else if (cmd == "profile" || cmd.substr(0, 8) == "profile ") {
+			SensorSet* sensors = mServer->getNode()->getSensors();
+			string arg = cmd.length() > 8 ? cmd.substr(8) : "";
+			if (arg == "on") {
+				sensors->setProfiling(true);
+			} else if (arg == "off") {
+				sensors->setProfiling(false);
+			} else if (arg == "reset") {
+				sensors->resetProfile();
+			} else if (arg == "") {
+				string report = sensors->getProfileReport();
+				mClient->sendData(report != "" ? report : "Profiling is disabled, enable with 'profile on'\n");
+			} else {
+				mClient->sendData("Invalid parameters, expected profile [on|off|reset]\n");
+			}
 		} else if (cmd == "exit") {
 			mClient->sendData("Closing connection\n");
 			break;
@@ -142,14 +201,18 @@ void CommandLineServer::CommandLineServerClient::execute(void* arg) {
 	delete mClient;
 }
 
-ssize_t CommandLineServer::CommandLineServerClient::readline(void* buffer, size_t len) {
+ssize_t CommandLineServer::CommandLineServerClient::readline(void* buffer, size_t len, char first) {
 	char c = '\0', *out = (char*) buffer;
 	size_t i;
 
 	memset(buffer, 0, len);
 
+	bool haveFirst = true; // First character was already read to tell text from binary frames
 	for (i = 0; i < len && c != '\n'; ++i) {
-		if (mClient->receiveData(&c, (size_t)1) <= 0) {
+		if (haveFirst) {
+			c = first;
+			haveFirst = false;
+		} else if (mClient->receiveData(&c, (size_t)1) <= 0) {
 			// timeout or error occured
 			return -1;
 		}
@@ -163,3 +226,78 @@ ssize_t CommandLineServer::CommandLineServerClient::readline(void* buffer, size_
 
 	return (ssize_t)i;
 }
+
+bool CommandLineServer::CommandLineServerClient::receiveAll(void* buffer, size_t len) {
+	char* out = (char*) buffer;
+	while (len > 0) {
+		size_t received = mClient->receiveData(out, len);
+		if (received == 0 || received > len) {
+			// timeout or error occured
+			return false;
+		}
+		out += received;
+		len -= received;
+	}
+	return true;
+}
+
+bool CommandLineServer::CommandLineServerClient::handleBinaryFrame(void) {
+	uint8_t header[FRAME_HEADER_LENGTH - 1];
+	if (!receiveAll(header, sizeof(header))) {
+		return false;
+	}
+	uint8_t type = header[0];
+	uint8_t nameLength = header[1];
+	uint32_t payloadLength = ((uint32_t)header[2] << 24) | ((uint32_t)header[3] << 16) | ((uint32_t)header[4] << 8) | header[5];
+	if (payloadLength > FRAME_MAX_PAYLOAD) {
+		// Cannot resynchronize the stream, drop the connection
+		LOG_ERROR(CommandLineServer::logger, "Binary frame payload of " << payloadLength << " bytes exceeds maximum of " << FRAME_MAX_PAYLOAD);
+		return false;
+	}
+	char name[256];
+	if (!receiveAll(name, nameLength)) {
+		return false;
+	}
+	vector<uint8_t> payload(payloadLength);
+	if (payloadLength > 0 && !receiveAll(&payload[0], payloadLength)) {
+		return false;
+	}
+	string groupName(name, nameLength);
+
+	if (type == FRAME_ADDSENSORS) {
+		string description;
+		if (payloadLength > 0 && payload[0] == '[') {
+			description.assign((const char*)&payload[0], payloadLength);
+		} else {
+			json::Value value = MessagePack::decode(payloadLength > 0 ? &payload[0] : NULL, payloadLength);
+			if (value.GetType() != json::ArrayVal) {
+				mClient->sendData("Could not add sensors group '" + groupName + "', description is not a MessagePack array!\n");
+				return true;
+			}
+			description = json::Serialize(value);
+		}
+		BinarySensorProvider* provider = new BinarySensorProvider(description);
+		if (mServer->getNode()->getSensors()->addJSONSensorProvider(provider, groupName)) {
+			mServer->getDaemon()->resetStatemachine();
+		} else {
+			delete provider;
+			mClient->sendData("Could not add sensors group '" + groupName + "', group or one of its sensors already exists, or it has an invalid description!\n");
+		}
+	} else if (type == FRAME_UPDATESENSORS) {
+		IJSONSensorProvider* provider = mServer->getNode()->getSensors()->getJSONSensorProvider(groupName);
+		if (provider == NULL) {
+			mClient->sendData("Could not update sensors group '" + groupName + "', group does not exist!\n");
+		} else if (BinarySensorProvider* v = dynamic_cast<BinarySensorProvider*>(provider)) {
+			if (!v->updateRecord(payloadLength > 0 ? &payload[0] : NULL, payloadLength)) {
+				std::ostringstream oss;
+				oss << "Could not update sensors group '" << groupName << "', record has " << payloadLength << " bytes, expected " << v->getRecordSize() << "!\n";
+				mClient->sendData(oss.str());
+			}
+		} else {
+			mClient->sendData("Could not update sensors group '" + groupName + "', group was not added via binary frame!\n");
+		}
+	} else {
+		mClient->sendData("Unknown binary frame type\n");
+	}
+	return true;
+}
@@ -56,7 +56,9 @@ private:
 		CommandLineServerClient& operator=(const CommandLineServerClient& cSource);
 
 		void execute(void* arg);
-		ssize_t readline(void* buffer, size_t len);
+		ssize_t readline(void* buffer, size_t len, char first);
+		bool receiveAll(void* buffer, size_t len);
+		bool handleBinaryFrame(void);
 
 		CommandLineServer* mServer;
 		Network* mClient;
@@ -0,0 +1,124 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "gtest/gtest.h"
+#include <string.h>
+#include "AuroraMonitor.h"
+#include "RegisterMapping.h"
+
+// Register block in plain memory instead of /dev/mem
+class MockRegisterMapping: public RegisterMapping {
+public:
+	MockRegisterMapping() : reads(0), available(true) {
+		memset(registers, 0, sizeof(registers));
+	}
+
+	virtual bool read(uint32_t* target, size_t count) {
+		reads++;
+		if (!available) {
+			return false;
+		}
+		memcpy(target, registers, count * sizeof(uint32_t));
+		return true;
+	}
+
+	uint32_t registers[AuroraMonitor::REGISTER_COUNT];
+	int reads;
+	bool available;
+};
+
+TEST(AuroraMonitorTest, ReadsBlockOncePerTick) {
+	MockRegisterMapping* mapping = new MockRegisterMapping();
+	AuroraMonitor* monitor = new AuroraMonitor(mapping);
+	uint32_t link = 0, errors = 0;
+
+	mapping->registers[AuroraMonitor::FRAME_ERROR_COUNT] = 3;
+	ASSERT_TRUE(monitor->update(link));
+	ASSERT_TRUE(monitor->update(errors));
+	EXPECT_EQ(1, mapping->reads);
+
+	// Values of one tick come from the same snapshot
+	mapping->registers[AuroraMonitor::FRAME_ERROR_COUNT] = 4;
+	ASSERT_TRUE(monitor->update(link));
+	mapping->registers[AuroraMonitor::FRAME_ERROR_COUNT] = 5;
+	ASSERT_TRUE(monitor->update(errors));
+	EXPECT_EQ(2, mapping->reads);
+	EXPECT_EQ(4u, monitor->getRegister(AuroraMonitor::FRAME_ERROR_COUNT));
+
+	monitor->release();
+}
+
+TEST(AuroraMonitorTest, UnavailableRegisters) {
+	MockRegisterMapping* mapping = new MockRegisterMapping();
+	AuroraMonitor* monitor = new AuroraMonitor(mapping);
+	uint32_t generation = 0;
+
+	mapping->available = false;
+	EXPECT_FALSE(monitor->update(generation));
+	mapping->available = true;
+	EXPECT_TRUE(monitor->update(generation));
+
+	monitor->release();
+}
+
+TEST(AuroraMonitorTest, DecodesRegisters) {
+	MockRegisterMapping* mapping = new MockRegisterMapping();
+	AuroraMonitor* monitor = new AuroraMonitor(mapping);
+	uint32_t generation = 0;
+
+	mapping->registers[AuroraMonitor::BUS_UTILIZATION] = 192;
+	mapping->registers[AuroraMonitor::DATA_WIDTH] = 8;
+	mapping->registers[AuroraMonitor::STATUS] = 0x0f050000;
+	mapping->registers[AuroraMonitor::BUS_FREQUENCY] = 156250000;
+	mapping->registers[AuroraMonitor::BUS_WIDTH] = 64;
+	ASSERT_TRUE(monitor->update(generation));
+
+	EXPECT_EQ(75u, monitor->getUtilization());
+	EXPECT_EQ(1250000000ull, monitor->getBandwidth());
+	EXPECT_EQ("Channel down (lanes 1, 3 up) (0xf050000)", monitor->getLinkStatus());
+
+	mapping->registers[AuroraMonitor::STATUS] = 0x0f0f0038;
+	ASSERT_TRUE(monitor->update(generation));
+	EXPECT_EQ("Channel up, HardErr, PLL not locked (0xf0f0038)", monitor->getLinkStatus());
+
+	monitor->release();
+}
+
+TEST(AuroraMonitorTest, MonitorsAreIndependent) {
+	MockRegisterMapping* first = new MockRegisterMapping();
+	MockRegisterMapping* second = new MockRegisterMapping();
+	AuroraMonitor* monitor1 = new AuroraMonitor(first);
+	AuroraMonitor* monitor2 = new AuroraMonitor(second);
+	uint32_t generation1 = 0, generation2 = 0;
+
+	first->registers[AuroraMonitor::SOFT_ERROR_COUNT] = 1;
+	second->registers[AuroraMonitor::SOFT_ERROR_COUNT] = 2;
+	ASSERT_TRUE(monitor1->update(generation1));
+	ASSERT_TRUE(monitor2->update(generation2));
+	EXPECT_EQ(1u, monitor1->getRegister(AuroraMonitor::SOFT_ERROR_COUNT));
+	EXPECT_EQ(2u, monitor2->getRegister(AuroraMonitor::SOFT_ERROR_COUNT));
+
+	monitor1->release();
+	monitor2->release();
+}
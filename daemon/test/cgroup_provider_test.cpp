@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "gtest/gtest.h"
+#include <vector>
+#include "LinuxSensorProviderCgroup.h"
+#include "fake_sysfs.h"
+
+class CgroupProviderTest: public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		config.set("cgroupPath", sysfs.getRoot());
+		LinuxSensorProviderCgroup::config = &config;
+		LinuxSensorProviderCgroup::logger = Logger::getLogger("LinuxSensorProviderCgroup");
+		provider = static_cast<LinuxSensorProviderCgroup*>(LinuxSensorProviderCgroup::create(NULL));
+		sensors = provider->getSensors();
+	}
+
+	virtual void TearDown() {
+		for (std::map<std::string, ISensor*>::iterator iterator = sensors.begin(); iterator != sensors.end(); ++iterator) {
+			delete iterator->second;
+		}
+		LinuxSensorProviderCgroup::destroy(provider);
+	}
+
+	void createGroup(const std::string& group) {
+		sysfs.write(group + "/cgroup.events", "populated 1\nfrozen 0\n");
+	}
+
+	void removeGroup(const std::string& group) {
+		unlink((sysfs.getRoot() + "/" + group + "/cgroup.events").c_str());
+		rmdir((sysfs.getRoot() + "/" + group).c_str());
+	}
+
+	// Applies the changes like SensorSet::updateDynamicSensors
+	bool poll(std::map<std::string, ISensor*>& added, std::vector<std::string>& removed) {
+		bool changed = provider->pollSensorChanges(added, removed);
+		for (std::vector<std::string>::iterator name = removed.begin(); name != removed.end(); ++name) {
+			std::map<std::string, ISensor*>::iterator iterator = sensors.find(*name);
+			if (iterator != sensors.end()) {
+				delete iterator->second;
+				sensors.erase(iterator);
+			}
+		}
+		for (std::map<std::string, ISensor*>::iterator iterator = added.begin(); iterator != added.end(); ++iterator) {
+			EXPECT_TRUE(sensors.insert(*iterator).second) << iterator->first;
+		}
+		return changed;
+	}
+
+	FakeSysfs sysfs;
+	FakeConfig config;
+	LinuxSensorProviderCgroup* provider;
+	std::map<std::string, ISensor*> sensors;
+};
+
+TEST_F(CgroupProviderTest, AddsAndRemovesGroups) {
+	createGroup("web.service");
+	std::map<std::string, ISensor*> added;
+	std::vector<std::string> removed;
+	ASSERT_TRUE(poll(added, removed));
+	EXPECT_EQ(4u, added.size());
+	EXPECT_TRUE(removed.empty());
+	EXPECT_TRUE(sensors.find("web CPU") != sensors.end());
+	EXPECT_TRUE(sensors.find("web IO write") != sensors.end());
+
+	removeGroup("web.service");
+	added.clear();
+	ASSERT_TRUE(poll(added, removed));
+	EXPECT_TRUE(added.empty());
+	EXPECT_EQ(4u, removed.size());
+	EXPECT_TRUE(sensors.empty());
+}
+
+TEST_F(CgroupProviderTest, GroupCreatedAndRemovedWithinOnePoll) {
+	// Created, deleted and created again before the poll: the first
+	// incarnation must neither be added nor reported as removed
+	createGroup("batch.slice");
+	removeGroup("batch.slice");
+	createGroup("batch.slice");
+	std::map<std::string, ISensor*> added;
+	std::vector<std::string> removed;
+	ASSERT_TRUE(poll(added, removed));
+	EXPECT_EQ(4u, added.size());
+	EXPECT_TRUE(removed.empty());
+	EXPECT_EQ(4u, sensors.size());
+
+	// Still owned by its group: removal and re-creation work afterwards
+	removeGroup("batch.slice");
+	added.clear();
+	removed.clear();
+	ASSERT_TRUE(poll(added, removed));
+	EXPECT_EQ(4u, removed.size());
+	EXPECT_TRUE(sensors.empty());
+
+	createGroup("batch.slice");
+	added.clear();
+	removed.clear();
+	ASSERT_TRUE(poll(added, removed));
+	EXPECT_EQ(4u, added.size());
+	EXPECT_EQ(4u, sensors.size());
+}
+
+TEST_F(CgroupProviderTest, GroupRemovedAndRecreatedWithinOnePoll) {
+	createGroup("db.service");
+	std::map<std::string, ISensor*> added;
+	std::vector<std::string> removed;
+	ASSERT_TRUE(poll(added, removed));
+
+	removeGroup("db.service");
+	createGroup("db.service");
+	added.clear();
+	ASSERT_TRUE(poll(added, removed));
+	EXPECT_EQ(4u, removed.size());
+	EXPECT_EQ(4u, added.size());
+	EXPECT_EQ(4u, sensors.size());
+}
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FAKE_SYSFS_H_
+#define FAKE_SYSFS_H_
+
+#include <string>
+#include <map>
+#include <cstdlib>
+#include <cstdio>
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <IConfig.h>
+
+// Temporary directory tree standing in for /sys, removed again on destruction
+class FakeSysfs {
+public:
+	FakeSysfs() {
+		char path[] = "/tmp/fake_sysfs.XXXXXX";
+		mRoot = mkdtemp(path) != NULL ? path : "";
+	}
+
+	~FakeSysfs() {
+		if (!mRoot.empty()) {
+			nftw(mRoot.c_str(), &FakeSysfs::removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+		}
+	}
+
+	// Creates missing parent directories
+	void write(const std::string& path, const std::string& content) {
+		for (size_t slash = path.find('/'); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+			mkdir((mRoot + "/" + path.substr(0, slash)).c_str(), 0755);
+		}
+		FILE* file = fopen((mRoot + "/" + path).c_str(), "w");
+		if (file != NULL) {
+			fputs(content.c_str(), file);
+			fclose(file);
+		}
+	}
+
+	const std::string& getRoot(void) const {
+		return mRoot;
+	}
+
+private:
+	static int removeEntry(const char* path, const struct stat*, int, struct FTW*) {
+		return remove(path);
+	}
+
+	std::string mRoot;
+};
+
+// Plugin configuration with string values, everything else returns the default
+class FakeConfig: public IConfig {
+public:
+	void set(const std::string& setting, const std::string& value) {
+		mValues[setting] = value;
+	}
+
+	bool GetBoolean(string, string Setting, bool Default) {
+		std::map<std::string, std::string>::iterator iterator = mValues.find(Setting);
+		return iterator != mValues.end() ? iterator->second == "true" : Default;
+	}
+	bool SetBoolean(string, string, bool) {
+		return false;
+	}
+	string GetString(string, string Setting, string Default) {
+		std::map<std::string, std::string>::iterator iterator = mValues.find(Setting);
+		return iterator != mValues.end() ? iterator->second : Default;
+	}
+	bool SetString(string, string, string) {
+		return false;
+	}
+	int GetInt(string, string Setting, int Default) {
+		std::map<std::string, std::string>::iterator iterator = mValues.find(Setting);
+		return iterator != mValues.end() ? atoi(iterator->second.c_str()) : Default;
+	}
+	bool SetInt(string, string, int) {
+		return false;
+	}
+	double GetDouble(string, string Setting, double Default) {
+		std::map<std::string, std::string>::iterator iterator = mValues.find(Setting);
+		return iterator != mValues.end() ? atof(iterator->second.c_str()) : Default;
+	}
+	bool SetDouble(string, string, double) {
+		return false;
+	}
+
+private:
+	std::map<std::string, std::string> mValues;
+};
+
+#endif /* FAKE_SYSFS_H_ */
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "gtest/gtest.h"
+#include <string.h>
+#include "LinuxSensorProviderHwmon.h"
+#include "fake_sysfs.h"
+
+class HwmonProviderTest: public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		config.set("hwmonSysfsRoot", sysfs.getRoot());
+		LinuxSensorProviderHwmon::config = &config;
+		LinuxSensorProviderHwmon::logger = Logger::getLogger("LinuxSensorProviderHwmon");
+	}
+
+	virtual void TearDown() {
+		for (std::map<std::string, ISensor*>::iterator iterator = sensors.begin(); iterator != sensors.end(); ++iterator) {
+			delete iterator->second;
+		}
+	}
+
+	void scan(void) {
+		void* provider = LinuxSensorProviderHwmon::create(NULL);
+		sensors = static_cast<LinuxSensorProviderHwmon*>(provider)->getSensors();
+		LinuxSensorProviderHwmon::destroy(provider);
+	}
+
+	SensorBean* sensor(const std::string& name) {
+		std::map<std::string, ISensor*>::iterator iterator = sensors.find(name);
+		return iterator != sensors.end() ? static_cast<SensorBean*>(iterator->second) : NULL;
+	}
+
+	double value(const std::string& name) {
+		uint8_t data[8];
+		double result;
+		sensor(name)->getData(data);
+		memcpy(&result, data, sizeof(result));
+		return result;
+	}
+
+	FakeSysfs sysfs;
+	FakeConfig config;
+	std::map<std::string, ISensor*> sensors;
+};
+
+TEST_F(HwmonProviderTest, NamesHwmonSensors) {
+	sysfs.write("class/hwmon/hwmon0/name", "coretemp\n");
+	sysfs.write("class/hwmon/hwmon0/temp1_input", "45000\n");
+	sysfs.write("class/hwmon/hwmon0/temp1_label", "Package id 0\n");
+	sysfs.write("class/hwmon/hwmon0/temp2_input", "41000\n");
+	sysfs.write("class/hwmon/hwmon0/temp2_crit_alarm", "0\n");
+	// Second chip of the same type
+	sysfs.write("class/hwmon/hwmon1/name", "coretemp\n");
+	sysfs.write("class/hwmon/hwmon1/temp1_input", "47000\n");
+	sysfs.write("class/hwmon/hwmon1/temp1_label", "Package id 0\n");
+	sysfs.write("class/hwmon/hwmon1/temp1_max", "80000\n");
+	// Older driver with its attributes in the device directory
+	sysfs.write("class/hwmon/hwmon2/device/name", "w83627ehf\n");
+	sysfs.write("class/hwmon/hwmon2/device/fan1_input", "1500\n");
+	scan();
+
+	ASSERT_EQ(4u, sensors.size());
+	ASSERT_TRUE(sensor("coretemp Package id 0") != NULL);
+	ASSERT_TRUE(sensor("coretemp temp2") != NULL);
+	ASSERT_TRUE(sensor("coretemp Package id 0 2") != NULL);
+	ASSERT_TRUE(sensor("w83627ehf fan1") != NULL);
+	EXPECT_EQ(UNIT_TEMPERATURE, sensor("coretemp temp2")->getUnit());
+	EXPECT_EQ(UNIT_ROTATIONAL_SPEED, sensor("w83627ehf fan1")->getUnit());
+}
+
+TEST_F(HwmonProviderTest, ScalesMilliUnits) {
+	sysfs.write("class/hwmon/hwmon0/name", "ina3221\n");
+	sysfs.write("class/hwmon/hwmon0/temp1_input", "45500\n");
+	sysfs.write("class/hwmon/hwmon0/in1_input", "12040\n");
+	sysfs.write("class/hwmon/hwmon0/curr1_input", "-250\n");
+	sysfs.write("class/hwmon/hwmon0/power1_input", "12500000\n");
+	sysfs.write("class/hwmon/hwmon0/fan1_input", "2400\n");
+	scan();
+
+	EXPECT_DOUBLE_EQ(45.5, value("ina3221 temp1"));
+	EXPECT_DOUBLE_EQ(12.04, value("ina3221 in1"));
+	EXPECT_DOUBLE_EQ(-0.25, value("ina3221 curr1"));
+	EXPECT_DOUBLE_EQ(12.5, value("ina3221 power1"));
+	EXPECT_DOUBLE_EQ(2400.0, value("ina3221 fan1"));
+
+	// Values are read on every update
+	sysfs.write("class/hwmon/hwmon0/temp1_input", "50000\n");
+	EXPECT_DOUBLE_EQ(50.0, value("ina3221 temp1"));
+}
+
+TEST_F(HwmonProviderTest, MapsThresholds) {
+	sysfs.write("class/hwmon/hwmon0/name", "nct6775\n");
+	sysfs.write("class/hwmon/hwmon0/temp1_input", "40000\n");
+	sysfs.write("class/hwmon/hwmon0/temp1_max", "80000\n");
+	sysfs.write("class/hwmon/hwmon0/temp1_crit", "100000\n");
+	sysfs.write("class/hwmon/hwmon0/in0_input", "1200\n");
+	sysfs.write("class/hwmon/hwmon0/in0_lcrit", "1000\n");
+	sysfs.write("class/hwmon/hwmon0/in0_min", "1100\n");
+	// Only one level present, used for both
+	sysfs.write("class/hwmon/hwmon0/in1_input", "3300\n");
+	sysfs.write("class/hwmon/hwmon0/in1_crit", "3600\n");
+	sysfs.write("class/hwmon/hwmon0/in1_min", "3000\n");
+	sysfs.write("class/hwmon/hwmon0/temp2_input", "30000\n");
+	scan();
+
+	SensorBean* temp1 = sensor("nct6775 temp1");
+	ASSERT_TRUE(temp1 != NULL);
+	EXPECT_FALSE(temp1->getUseLowerThresholds());
+	EXPECT_TRUE(temp1->getUseUpperThresholds());
+	EXPECT_DOUBLE_EQ(80.0, temp1->getUpperWarningThreshold());
+	EXPECT_DOUBLE_EQ(100.0, temp1->getUpperCriticalThreshold());
+
+	SensorBean* in0 = sensor("nct6775 in0");
+	ASSERT_TRUE(in0 != NULL);
+	EXPECT_TRUE(in0->getUseLowerThresholds());
+	EXPECT_FALSE(in0->getUseUpperThresholds());
+	EXPECT_DOUBLE_EQ(1.0, in0->getLowerCriticalThreshold());
+	EXPECT_DOUBLE_EQ(1.1, in0->getLowerWarningThreshold());
+
+	SensorBean* in1 = sensor("nct6775 in1");
+	ASSERT_TRUE(in1 != NULL);
+	EXPECT_TRUE(in1->getUseLowerThresholds());
+	EXPECT_DOUBLE_EQ(3.0, in1->getLowerCriticalThreshold());
+	EXPECT_DOUBLE_EQ(3.0, in1->getLowerWarningThreshold());
+	EXPECT_TRUE(in1->getUseUpperThresholds());
+	EXPECT_DOUBLE_EQ(3.6, in1->getUpperWarningThreshold());
+	EXPECT_DOUBLE_EQ(3.6, in1->getUpperCriticalThreshold());
+
+	SensorBean* temp2 = sensor("nct6775 temp2");
+	ASSERT_TRUE(temp2 != NULL);
+	EXPECT_FALSE(temp2->getUseLowerThresholds());
+	EXPECT_FALSE(temp2->getUseUpperThresholds());
+}
+
+TEST_F(HwmonProviderTest, MapsThermalTripPoints) {
+	sysfs.write("class/thermal/thermal_zone0/type", "x86_pkg_temp\n");
+	sysfs.write("class/thermal/thermal_zone0/temp", "52000\n");
+	sysfs.write("class/thermal/thermal_zone0/trip_point_0_type", "critical\n");
+	sysfs.write("class/thermal/thermal_zone0/trip_point_0_temp", "105000\n");
+	sysfs.write("class/thermal/thermal_zone0/trip_point_1_type", "passive\n");
+	sysfs.write("class/thermal/thermal_zone0/trip_point_1_temp", "95000\n");
+	sysfs.write("class/thermal/thermal_zone0/trip_point_2_type", "hot\n");
+	sysfs.write("class/thermal/thermal_zone0/trip_point_2_temp", "90000\n");
+	sysfs.write("class/thermal/cooling_device0/type", "Processor\n");
+	scan();
+
+	ASSERT_EQ(1u, sensors.size());
+	SensorBean* zone = sensor("x86_pkg_temp");
+	ASSERT_TRUE(zone != NULL);
+	EXPECT_DOUBLE_EQ(52.0, value("x86_pkg_temp"));
+	EXPECT_TRUE(zone->getUseUpperThresholds());
+	EXPECT_DOUBLE_EQ(90.0, zone->getUpperWarningThreshold());
+	EXPECT_DOUBLE_EQ(105.0, zone->getUpperCriticalThreshold());
+}
+
+TEST_F(HwmonProviderTest, ScalesIioChannels) {
+	sysfs.write("bus/iio/devices/iio:device0/name", "ads1015\n");
+	// (raw + offset) * scale in milli units, channel specific offset and shared scale
+	sysfs.write("bus/iio/devices/iio:device0/in_voltage0_raw", "1000\n");
+	sysfs.write("bus/iio/devices/iio:device0/in_voltage0_offset", "10\n");
+	sysfs.write("bus/iio/devices/iio:device0/in_voltage_scale", "2.0\n");
+	sysfs.write("bus/iio/devices/iio:device0/in_voltage1_raw", "500\n");
+	sysfs.write("bus/iio/devices/iio:device0/in_voltage1_scale", "0.5\n");
+	// Processed value preferred over raw
+	sysfs.write("bus/iio/devices/iio:device0/in_temp_raw", "1234\n");
+	sysfs.write("bus/iio/devices/iio:device0/in_temp_scale", "3.0\n");
+	sysfs.write("bus/iio/devices/iio:device0/in_temp_input", "25500\n");
+	// No scale, unitless
+	sysfs.write("bus/iio/devices/iio:device1/in_current0_raw", "42\n");
+	scan();
+
+	ASSERT_EQ(3u, sensors.size());
+	EXPECT_DOUBLE_EQ(2.02, value("ads1015 voltage0"));
+	EXPECT_DOUBLE_EQ(0.25, value("ads1015 voltage1"));
+	EXPECT_DOUBLE_EQ(25.5, value("ads1015 temp"));
+	EXPECT_EQ(UNIT_VOLTAGE, sensor("ads1015 voltage0")->getUnit());
+	EXPECT_EQ(UNIT_TEMPERATURE, sensor("ads1015 temp")->getUnit());
+}
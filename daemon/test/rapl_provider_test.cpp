@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "gtest/gtest.h"
+#include <string.h>
+#include "LinuxSensorProviderRapl.h"
+#include "RaplZone.h"
+#include "fake_sysfs.h"
+
+class RaplProviderTest: public ::testing::Test {
+protected:
+	virtual void SetUp() {
+		config.set("raplSysfsRoot", sysfs.getRoot());
+		LinuxSensorProviderRapl::config = &config;
+		LinuxSensorProviderRapl::logger = Logger::getLogger("LinuxSensorProviderRapl");
+	}
+
+	virtual void TearDown() {
+		for (std::map<std::string, ISensor*>::iterator iterator = sensors.begin(); iterator != sensors.end(); ++iterator) {
+			delete iterator->second;
+		}
+	}
+
+	void addZone(const std::string& zone, const std::string& name, const std::string& maxEnergyRange, const std::string& energy) {
+		sysfs.write("class/powercap/" + zone + "/name", name + "\n");
+		if (!maxEnergyRange.empty()) {
+			sysfs.write("class/powercap/" + zone + "/max_energy_range_uj", maxEnergyRange + "\n");
+		}
+		sysfs.write("class/powercap/" + zone + "/energy_uj", energy + "\n");
+	}
+
+	void scan(void) {
+		void* provider = LinuxSensorProviderRapl::create(NULL);
+		sensors = static_cast<LinuxSensorProviderRapl*>(provider)->getSensors();
+		LinuxSensorProviderRapl::destroy(provider);
+	}
+
+	double value(const std::string& name) {
+		uint8_t data[8];
+		double result;
+		sensors[name]->getData(data);
+		memcpy(&result, data, sizeof(result));
+		return result;
+	}
+
+	FakeSysfs sysfs;
+	FakeConfig config;
+	std::map<std::string, ISensor*> sensors;
+};
+
+TEST_F(RaplProviderTest, NamesZonesAndSubZones) {
+	sysfs.write("class/powercap/intel-rapl/enabled", "1\n");
+	addZone("intel-rapl:0", "package-0", "262143328850", "1000");
+	addZone("intel-rapl:0:0", "core", "262143328850", "2000");
+	addZone("intel-rapl:0:1", "dram", "262143328850", "3000");
+	addZone("intel-rapl:1", "package-1", "262143328850", "4000");
+	// Same package counters again
+	addZone("intel-rapl-mmio:0", "package-0", "262143328850", "5000");
+	// Unusable without the wraparound range
+	addZone("intel-rapl:1:0", "core", "", "6000");
+	scan();
+
+	ASSERT_EQ(8u, sensors.size());
+	EXPECT_TRUE(sensors.find("package-0 power") != sensors.end());
+	EXPECT_TRUE(sensors.find("package-0 energy") != sensors.end());
+	EXPECT_TRUE(sensors.find("package-0 core power") != sensors.end());
+	EXPECT_TRUE(sensors.find("package-0 dram energy") != sensors.end());
+	EXPECT_TRUE(sensors.find("package-1 power") != sensors.end());
+	EXPECT_TRUE(sensors.find("package-1 core power") == sensors.end());
+	EXPECT_EQ(UNIT_POWER, sensors["package-0 dram power"]->getUnit());
+	EXPECT_EQ(UNIT_DIMENSIONLESS, sensors["package-0 dram energy"]->getUnit());
+}
+
+TEST_F(RaplProviderTest, AccumulatesEnergyAcrossWraparound) {
+	addZone("intel-rapl:0", "package-0", "1000000", "997000");
+	scan();
+
+	// Energy counts from the first sample, in J
+	EXPECT_DOUBLE_EQ(0.0, value("package-0 energy"));
+	sysfs.write("class/powercap/intel-rapl:0/energy_uj", "999000\n");
+	EXPECT_DOUBLE_EQ(0.002, value("package-0 energy"));
+	sysfs.write("class/powercap/intel-rapl:0/energy_uj", "1000\n");
+	EXPECT_DOUBLE_EQ(0.004, value("package-0 energy"));
+	sysfs.write("class/powercap/intel-rapl:0/energy_uj", "4000\n");
+	EXPECT_DOUBLE_EQ(0.007, value("package-0 energy"));
+}
+
+TEST_F(RaplProviderTest, PowerFromWrappedDelta) {
+	sysfs.write("class/powercap/intel-rapl:0/energy_uj", "999000\n");
+	RaplZone* zone = new RaplZone(sysfs.getRoot() + "/class/powercap/intel-rapl:0/energy_uj", 1000000);
+	zone->acquire();
+	uint32_t generation = 0;
+	double power = 0.0;
+
+	ASSERT_TRUE(zone->update(generation));
+	EXPECT_FALSE(zone->getPower(power));
+
+	usleep(10000);
+	sysfs.write("class/powercap/intel-rapl:0/energy_uj", "4000\n");
+	ASSERT_TRUE(zone->update(generation));
+	EXPECT_DOUBLE_EQ(0.005, zone->getEnergy());
+	ASSERT_TRUE(zone->getPower(power));
+	// 5 mJ in at least 10 ms
+	EXPECT_GT(power, 0.0);
+	EXPECT_LE(power, 0.5);
+
+	// Unreadable counter
+	sysfs.write("class/powercap/intel-rapl:0/energy_uj", "\n");
+	EXPECT_FALSE(zone->update(generation));
+	EXPECT_DOUBLE_EQ(0.005, zone->getEnergy());
+
+	zone->release();
+}
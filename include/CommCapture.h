@@ -0,0 +1,128 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMMCAPTURE_H_
+#define COMMCAPTURE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+// Capture of communicator traffic, recorded by the daemon ([Comm] recordFile)
+// and played back by the CommunicatorReplay plugin. Numbers are unsigned
+// LEB128 varints, a header poll takes about 10 bytes.
+//
+// File:   "RCAP" version (u8) maxDataSize (varint) record...
+// Record: kind (u8, 'R' or 'W') time since previous record in us (varint)
+//         offset (varint) count (varint) result (zigzag varint) payload
+// The payload of a read are the result bytes read (none if result <= 0),
+// that of a write are the count bytes passed to writeData.
+
+#define COMM_CAPTURE_MAGIC		"RCAP"
+#define COMM_CAPTURE_VERSION	1
+#define COMM_CAPTURE_READ		'R'
+#define COMM_CAPTURE_WRITE		'W'
+#define COMM_CAPTURE_MAX_VARINT	10
+#define COMM_CAPTURE_MAX_PREFIX	(1 + 4 * COMM_CAPTURE_MAX_VARINT) // Record without payload
+
+struct CommCaptureRecord {
+	uint8_t kind;
+	uint64_t time; // us since start of capture
+	size_t offset;
+	size_t count;
+	ssize_t result;
+	const uint8_t* payload;
+	size_t payloadLength;
+};
+
+static inline size_t commCapturePutVarint(uint8_t* buffer, uint64_t value) {
+	size_t length = 0;
+	while (value >= 0x80) {
+		buffer[length++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	buffer[length++] = (uint8_t)value;
+	return length;
+}
+
+static inline bool commCaptureGetVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+	value = 0;
+	for (int shift = 0; shift < 64 && p < end; shift += 7) {
+		uint8_t byte = *p++;
+		value |= (uint64_t)(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Encodes the record without payload into buffer (COMM_CAPTURE_MAX_PREFIX bytes)
+static inline size_t commCapturePutRecord(uint8_t* buffer, uint8_t kind, uint64_t delta, size_t offset, size_t count, ssize_t result) {
+	size_t length = 0;
+	buffer[length++] = kind;
+	length += commCapturePutVarint(&buffer[length], delta);
+	length += commCapturePutVarint(&buffer[length], offset);
+	length += commCapturePutVarint(&buffer[length], count);
+	int64_t value = result;
+	length += commCapturePutVarint(&buffer[length], ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+	return length;
+}
+
+// Parses the record at p and advances p behind it. time is the time of the
+// previous record on entry.
+static inline bool commCaptureGetRecord(const uint8_t*& p, const uint8_t* end, CommCaptureRecord& record) {
+	if (p >= end) {
+		return false;
+	}
+	record.kind = *p++;
+	if (record.kind != COMM_CAPTURE_READ && record.kind != COMM_CAPTURE_WRITE) {
+		return false;
+	}
+	uint64_t delta, offset, count, result;
+	if (!commCaptureGetVarint(p, end, delta) || !commCaptureGetVarint(p, end, offset)
+			|| !commCaptureGetVarint(p, end, count) || !commCaptureGetVarint(p, end, result)) {
+		return false;
+	}
+	record.time += delta;
+	record.offset = offset;
+	record.count = count;
+	record.result = (ssize_t)((int64_t)(result >> 1) ^ -(int64_t)(result & 1));
+	if (record.kind == COMM_CAPTURE_READ && record.result > 0 && (uint64_t)record.result > count) {
+		return false; // More bytes read than requested
+	}
+	if (record.kind == COMM_CAPTURE_WRITE) {
+		record.payloadLength = count;
+	} else {
+		record.payloadLength = record.result > 0 ? record.result : 0;
+	}
+	if ((size_t)(end - p) < record.payloadLength) {
+		return false;
+	}
+	record.payload = p;
+	p += record.payloadLength;
+	return true;
+}
+
+#endif /* COMMCAPTURE_H_ */
@@ -0,0 +1,184 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROCFILE_H_
+#define PROCFILE_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef WIN32
+#include <io.h>
+#ifndef O_CLOEXEC
+#define O_CLOEXEC	0
+#endif
+#endif
+
+// Keeps a /proc or /sys file open and re-reads it with pread into a buffer
+// allocated once, so sampling does not open files or allocate per tick.
+// /proc and most /sys attributes regenerate their content on every read
+// from offset 0.
+class ProcFile {
+public:
+	ProcFile(const char* path, size_t bufferSize = 4096) :
+		mFd(open(path, O_RDONLY | O_CLOEXEC)), mBuffer((char*)malloc(bufferSize + 1)), mBufferSize(bufferSize), mLength(0) {
+		mBuffer[0] = '\0';
+	}
+
+	~ProcFile() {
+		if (mFd >= 0) {
+			close(mFd);
+		}
+		free(mBuffer);
+	}
+
+	bool isOpen(void) const {
+		return mFd >= 0;
+	}
+
+	int getFd(void) const {
+		return mFd;
+	}
+
+	// Reads at most maxLength bytes (0: whole buffer) from the start of the file.
+	// Content is zero terminated, longer files are truncated.
+	bool read(size_t maxLength = 0) {
+		if (mFd < 0) {
+			return false;
+		}
+		if (maxLength == 0 || maxLength > mBufferSize) {
+			maxLength = mBufferSize;
+		}
+		mLength = 0;
+		while (mLength < maxLength) {
+#ifdef WIN32
+			// No pread, but the fd is never shared between threads
+			if (mLength == 0 && lseek(mFd, 0, SEEK_SET) < 0) {
+				mLength = 0;
+				mBuffer[0] = '\0';
+				return false;
+			}
+			ssize_t n = ::read(mFd, mBuffer + mLength, maxLength - mLength);
+#else
+			ssize_t n = pread(mFd, mBuffer + mLength, maxLength - mLength, mLength);
+#endif
+			if (n < 0) {
+				mLength = 0;
+				mBuffer[0] = '\0';
+				return false;
+			}
+			if (n == 0) {
+				break;
+			}
+			mLength += n;
+		}
+		mBuffer[mLength] = '\0';
+		return true;
+	}
+
+	const char* data(void) const {
+		return mBuffer;
+	}
+
+	const char* end(void) const {
+		return mBuffer + mLength;
+	}
+
+	size_t length(void) const {
+		return mLength;
+	}
+
+private:
+	//lint -e(1704)
+	ProcFile(const ProcFile& cSource);
+	ProcFile& operator=(const ProcFile& cSource);
+
+	int mFd;
+	char* mBuffer;
+	size_t mBufferSize;
+	size_t mLength;
+};
+
+// Allocation free scanners for the text formats found in /proc and /sys.
+// All of them advance p and never read beyond end.
+
+static inline void procSkipBlanks(const char*& p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		++p;
+	}
+}
+
+// Parses an unsigned decimal after optional blanks, false if there is none
+static inline bool procScanUint64(const char*& p, const char* end, uint64_t& value) {
+	procSkipBlanks(p, end);
+	if (p >= end || *p < '0' || *p > '9') {
+		return false;
+	}
+	value = 0;
+	while (p < end && *p >= '0' && *p <= '9') {
+		value = value * 10 + (uint64_t)(*p - '0');
+		++p;
+	}
+	return true;
+}
+
+static inline bool procScanInt64(const char*& p, const char* end, int64_t& value) {
+	procSkipBlanks(p, end);
+	bool negative = false;
+	if (p < end && *p == '-') {
+		negative = true;
+		++p;
+	}
+	uint64_t magnitude;
+	if (!procScanUint64(p, end, magnitude)) {
+		return false;
+	}
+	value = negative ? -(int64_t)magnitude : (int64_t)magnitude;
+	return true;
+}
+
+// Moves p to the first character of the next line, or end
+static inline void procNextLine(const char*& p, const char* end) {
+	const char* nl = (const char*)memchr(p, '\n', end - p);
+	p = nl != NULL ? nl + 1 : end;
+}
+
+// Searches for a line starting with key, beginning at p. On success p points
+// behind the key and true is returned, otherwise p is end.
+static inline bool procFindLine(const char*& p, const char* end, const char* key) {
+	size_t keyLength = strlen(key);
+	while (p < end) {
+		if ((size_t)(end - p) >= keyLength && memcmp(p, key, keyLength) == 0) {
+			p += keyLength;
+			return true;
+		}
+		procNextLine(p, end);
+	}
+	return false;
+}
+
+#endif /* PROCFILE_H_ */
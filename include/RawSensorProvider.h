@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RAWSENSORPROVIDER_H_
+#define RAWSENSORPROVIDER_H_
+
+#include <stdint.h>
+#include <object_model.h>
+
+// JSON sensor provider whose values bypass JSON: JSONSensorsParser builds the
+// sensors from the description, then copies readLatest() records of
+// getRecordSize() bytes (values in message encoding, description order).
+// A record size of 0 after getSensorsDescription() selects getSensorsData().
+class RawSensorProvider: public IJSONSensorProvider {
+public:
+	virtual ~RawSensorProvider() {}
+
+	virtual const char* getSensorsData(void) {
+		return "";
+	}
+
+	virtual size_t getRecordSize(void) = 0;
+	// Returns a sequence number that changes with every new record, 0 if none available
+	virtual uint64_t readLatest(uint8_t* buffer) = 0;
+};
+
+#endif /* RAWSENSORPROVIDER_H_ */
@@ -128,6 +128,11 @@ public:
 		memcpy(mData, bytes, mMaxDataSize);
 	}
 
+	// Data already in message encoding, mMaxDataSize bytes
+	void setRawData(const uint8_t* data) {
+		memcpy(mData, data, mMaxDataSize);
+	}
+
 	void setUpdateCallback(updateSensorCallback_t callback) {
 		mUpdateCallback = callback;
 	}
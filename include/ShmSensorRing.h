@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SHMSENSORRING_H_
+#define SHMSENSORRING_H_
+
+#include <stdint.h>
+#include <string.h>
+
+// Layout of a POSIX shared memory segment used by local high-rate producers
+// (e.g. FPGA host software) to publish sensor values to the daemon.
+//
+// The producer creates the segment, writes the header and the sensor
+// description (same JSON format as the "addsensors" telnet command) and then
+// publishes records. Each record holds the packed values of all sensors in
+// description order, encoded like in the Monitoring_Data message (integers
+// big endian, doubles in host byte order, strings zero padded).
+//
+// Single producer / single consumer: the daemon only ever reads the latest
+// complete record, so there is no read pointer and the producer never blocks.
+
+#define SHM_RING_MAGIC		0x52435352 // "RCSR"
+#define SHM_RING_VERSION	1
+
+typedef struct {
+	uint32_t		magic;
+	uint16_t		version;
+	uint16_t		slotCount;			// Number of record slots
+	uint32_t		recordSize;			// Bytes of packed values per record
+	uint32_t		descriptionOffset;	// JSON sensor description, zero terminated
+	uint32_t		descriptionLength;
+	uint32_t		slotsOffset;		// Begin of slot array, 8 byte aligned
+	uint32_t		slotSize;			// sizeof(uint64_t) + recordSize, rounded up to 8 bytes
+	uint32_t		reserved;
+	uint64_t		writeSeq;			// Number of records published so far
+} ShmSensorRing_Header; // 40 bytes, all fields naturally aligned
+
+// Each slot starts with the sequence number of the record it holds
+// (0 while being written), followed by recordSize bytes of values.
+
+// Slot layout as used for reading and writing records. The consumer
+// validates it once at attach and keeps its own copy, so a producer
+// rewriting the header later can not make it access memory out of bounds.
+typedef struct {
+	uint32_t		slotCount;
+	uint32_t		recordSize;
+	uint32_t		slotsOffset;
+	uint32_t		slotSize;
+} ShmSensorRing_Geometry;
+
+static inline size_t shmRingSlotSize(uint32_t recordSize) {
+	return (sizeof(uint64_t) + recordSize + 7) & ~(size_t)7;
+}
+
+static inline size_t shmRingTotalSize(uint16_t slotCount, uint32_t recordSize, uint32_t descriptionLength) {
+	size_t slotsOffset = (sizeof(ShmSensorRing_Header) + descriptionLength + 1 + 7) & ~(size_t)7;
+	return slotsOffset + slotCount * shmRingSlotSize(recordSize);
+}
+
+static inline ShmSensorRing_Geometry shmRingGeometry(const ShmSensorRing_Header* hdr) {
+	ShmSensorRing_Geometry geometry;
+	geometry.slotCount = hdr->slotCount;
+	geometry.recordSize = hdr->recordSize;
+	geometry.slotsOffset = hdr->slotsOffset;
+	geometry.slotSize = hdr->slotSize;
+	return geometry;
+}
+
+// True if all slots lie within a mapping of mappedSize bytes
+static inline bool shmRingGeometryValid(const ShmSensorRing_Geometry* geometry, size_t mappedSize) {
+	return geometry->slotCount > 0 && geometry->slotSize >= shmRingSlotSize(geometry->recordSize) &&
+		geometry->slotsOffset >= sizeof(ShmSensorRing_Header) && geometry->slotsOffset % 8 == 0 && geometry->slotSize % 8 == 0 &&
+		(uint64_t)geometry->slotsOffset + (uint64_t)geometry->slotCount * geometry->slotSize <= mappedSize;
+}
+
+static inline uint64_t* shmRingSlot(ShmSensorRing_Header* hdr, const ShmSensorRing_Geometry* geometry, uint64_t seq) {
+	return (uint64_t*)((uint8_t*)hdr + geometry->slotsOffset + ((seq - 1) % geometry->slotCount) * geometry->slotSize);
+}
+
+// Producer side: initialize a freshly mapped segment of shmRingTotalSize() bytes
+static inline void shmRingInit(ShmSensorRing_Header* hdr, uint16_t slotCount, uint32_t recordSize, const char* description) {
+	uint32_t descriptionLength = strlen(description);
+	memset(hdr, 0, shmRingTotalSize(slotCount, recordSize, descriptionLength));
+	hdr->version = SHM_RING_VERSION;
+	hdr->slotCount = slotCount;
+	hdr->recordSize = recordSize;
+	hdr->descriptionOffset = sizeof(ShmSensorRing_Header);
+	hdr->descriptionLength = descriptionLength;
+	hdr->slotsOffset = (sizeof(ShmSensorRing_Header) + descriptionLength + 1 + 7) & ~(uint32_t)7;
+	hdr->slotSize = shmRingSlotSize(recordSize);
+	memcpy((uint8_t*)hdr + hdr->descriptionOffset, description, descriptionLength + 1);
+	// Magic last, the consumer must not attach to a half initialized segment
+	__atomic_store_n(&hdr->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+}
+
+// Producer side: publish one record of hdr->recordSize bytes
+static inline void shmRingPublish(ShmSensorRing_Header* hdr, const void* values) {
+	ShmSensorRing_Geometry geometry = shmRingGeometry(hdr);
+	uint64_t seq = hdr->writeSeq + 1;
+	uint64_t* slot = shmRingSlot(hdr, &geometry, seq);
+	__atomic_store_n(slot, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	memcpy(slot + 1, values, geometry.recordSize);
+	__atomic_store_n(slot, seq, __ATOMIC_RELEASE);
+	__atomic_store_n(&hdr->writeSeq, seq, __ATOMIC_RELEASE);
+}
+
+// Consumer side: copy the latest complete record (geometry->recordSize bytes)
+// to values. geometry is the consumer's validated copy, never the header.
+// Returns its sequence number or 0 if nothing consistent could be read.
+static inline uint64_t shmRingReadLatest(ShmSensorRing_Header* hdr, const ShmSensorRing_Geometry* geometry, void* values) {
+	for (int retries = 0; retries < 4; ++retries) {
+		uint64_t seq = __atomic_load_n(&hdr->writeSeq, __ATOMIC_ACQUIRE);
+		if (seq == 0) {
+			return 0;
+		}
+		uint64_t* slot = shmRingSlot(hdr, geometry, seq);
+		if (__atomic_load_n(slot, __ATOMIC_ACQUIRE) != seq) {
+			continue; // Producer lapped us and is rewriting this slot
+		}
+		memcpy(values, slot + 1, geometry->recordSize);
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(slot, __ATOMIC_RELAXED) == seq) {
+			return seq;
+		}
+	}
+	return 0;
+}
+
+#endif /* SHMSENSORRING_H_ */
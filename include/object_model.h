@@ -28,6 +28,7 @@
 #include "c_object_model.h"
 #include <map>
 #include <string>
+#include <vector>
 
 struct ICommunicator {
 	virtual ~ICommunicator() {}
@@ -66,6 +67,17 @@ struct ISensor {
 	virtual uint16_t getNumberOfValues(void) = 0;
 	virtual IRenderingType getRenderingType(void) = 0;
 	virtual const char* getGroup(void) = 0;
+
+	// Static sensors change their value only occasionally. The SensorSet then
+	// asks hasChanged() every update and only calls getData() when it returns
+	// true, keeping the bytes of the previous message otherwise.
+	virtual bool isStatic(void) {
+		return false;
+	}
+
+	virtual bool hasChanged(void) {
+		return true;
+	}
 };
 
 struct IJSONSensorProvider {
@@ -81,4 +93,14 @@ struct ISensorProvider {
 	virtual std::map<std::string, ISensor*> getSensors(void) = 0;
 };
 
+// Provider whose sensors change at runtime (e.g. hotplugged interfaces).
+// Instead of being deleted after getSensors() it is kept by the SensorSet
+// and polled once per update. Removed sensors are deleted by the SensorSet.
+struct IDynamicSensorProvider: public ISensorProvider {
+	virtual ~IDynamicSensorProvider() {}
+
+	// Returns true if sensors were added or removed
+	virtual bool pollSensorChanges(std::map<std::string, ISensor*>& added, std::vector<std::string>& removed) = 0;
+};
+
 #endif
@@ -0,0 +1,220 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "CommunicatorReplay.h"
+
+#include <cstring>
+#include <cstdio>
+#include <time.h>
+#include <unistd.h>
+
+using namespace std;
+
+LoggerPtr CommunicatorReplay::logger;
+IConfig* CommunicatorReplay::config = NULL;
+
+void * CommunicatorReplay::create(PF_ObjectParams *) {
+	return new CommunicatorReplay();
+}
+
+int32_t CommunicatorReplay::destroy(void * p) {
+	if (!p)
+		return -1;
+	delete static_cast<CommunicatorReplay*>(p);
+	return 0;
+}
+
+CommunicatorReplay::CommunicatorReplay() :
+	mPosition(NULL), mRecordValid(false), mSpeed(1.0), mStartTime(0), mFirstRecordTime(0),
+	mReads(0), mMismatchedReads(0), mWrites(0), mIdenticalWrites(0), mDifferingWrites(0), mUnmatchedWrites(0), mSkippedWrites(0),
+	mBytesWritten(0), mRecordedBytesWritten(0) {
+	memset(&mRecord, 0, sizeof(mRecord));
+}
+
+CommunicatorReplay::~CommunicatorReplay() {
+	// Already logged if the end of the capture was reached
+	if (!mImage.empty() && mPosition != NULL) {
+		logSummary();
+	}
+}
+
+bool CommunicatorReplay::initInterface() {
+	string path = config->GetString("Comm", "replayFile", "");
+	mSpeed = config->GetDouble("Comm", "replaySpeed", 1.0);
+
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == NULL) {
+		LOG_ERROR(logger, "Could not open capture '" << path << "'");
+		return false;
+	}
+	uint8_t buffer[4096];
+	size_t length;
+	while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		mCapture.insert(mCapture.end(), buffer, buffer + length);
+	}
+	fclose(file);
+
+	size_t magicLength = strlen(COMM_CAPTURE_MAGIC);
+	const uint8_t* end = mCapture.empty() ? NULL : &mCapture[0] + mCapture.size();
+	mPosition = mCapture.empty() ? NULL : &mCapture[0];
+	uint64_t maxDataSize = 0;
+	if (mCapture.size() <= magicLength || memcmp(mPosition, COMM_CAPTURE_MAGIC, magicLength) != 0) {
+		LOG_ERROR(logger, "'" << path << "' is no communicator capture");
+		return false;
+	}
+	mPosition += magicLength;
+	if (*mPosition++ != COMM_CAPTURE_VERSION) {
+		LOG_ERROR(logger, "Unsupported capture version " << (int)mPosition[-1]);
+		return false;
+	}
+	if (!commCaptureGetVarint(mPosition, end, maxDataSize) || maxDataSize == 0) {
+		LOG_ERROR(logger, "Invalid capture header");
+		return false;
+	}
+	mImage.resize(maxDataSize, 0);
+	nextRecord();
+	mFirstRecordTime = mRecord.time;
+	LOG_INFO(logger, "Replaying " << mCapture.size() << " bytes capture of " << maxDataSize << " bytes memory at speed " << mSpeed);
+
+	return true;
+}
+
+size_t CommunicatorReplay::getMaxDataSize(void) {
+	return mImage.size();
+}
+
+ssize_t CommunicatorReplay::readData(size_t offset, void* buf, size_t count) {
+	if (mImage.empty())
+		return -3;
+
+	// Recorded writes the daemon did not repeat
+	while (mRecordValid && mRecord.kind == COMM_CAPTURE_WRITE) {
+		mSkippedWrites++;
+		mRecordedBytesWritten += mRecord.payloadLength;
+		nextRecord();
+	}
+
+	if (mRecordValid) {
+		waitForRecord();
+		mReads++;
+		applyToImage(mRecord.offset, mRecord.payload, mRecord.payloadLength);
+		if (mRecord.offset == offset && mRecord.count == count) {
+			ssize_t result = mRecord.result;
+			if (result > 0) {
+				memcpy(buf, mRecord.payload, result);
+			}
+			nextRecord();
+			return result;
+		}
+		mMismatchedReads++;
+		nextRecord();
+	}
+
+	if (offset >= mImage.size()) {
+		return -1;
+	}
+	if (offset + count > mImage.size()) {
+		count = mImage.size() - offset;
+	}
+	memcpy(buf, &mImage[offset], count);
+	return count;
+}
+
+ssize_t CommunicatorReplay::writeData(size_t offset, const void* buf, size_t count) {
+	if (mImage.empty())
+		return -3;
+
+	mWrites++;
+	mBytesWritten += count;
+	applyToImage(offset, (const uint8_t*)buf, count);
+	if (mRecordValid && mRecord.kind == COMM_CAPTURE_WRITE && mRecord.offset == offset) {
+		mRecordedBytesWritten += mRecord.payloadLength;
+		if (mRecord.count == count && memcmp(mRecord.payload, buf, count) == 0) {
+			mIdenticalWrites++;
+		} else {
+			mDifferingWrites++;
+		}
+		nextRecord();
+	} else {
+		mUnmatchedWrites++;
+	}
+
+	if (offset >= mImage.size()) {
+		return -1;
+	}
+	return offset + count > mImage.size() ? mImage.size() - offset : count;
+}
+
+bool CommunicatorReplay::nextRecord(void) {
+	const uint8_t* end = &mCapture[0] + mCapture.size();
+	bool wasValid = mRecordValid || mPosition != NULL;
+	mRecordValid = mPosition != NULL && commCaptureGetRecord(mPosition, end, mRecord);
+	if (!mRecordValid && wasValid) {
+		if (mPosition != NULL && mPosition < end) {
+			LOG_ERROR(logger, "Capture corrupt at byte " << (mPosition - &mCapture[0]) << ", stopping replay");
+		} else {
+			LOG_INFO(logger, "End of capture reached, serving last memory contents from now on");
+		}
+		logSummary();
+		mPosition = NULL;
+	}
+	return mRecordValid;
+}
+
+void CommunicatorReplay::waitForRecord(void) {
+	uint64_t time = now();
+	if (mStartTime == 0) {
+		mStartTime = time;
+	}
+	if (mSpeed <= 0.0) {
+		return;
+	}
+	uint64_t due = mStartTime + (uint64_t)((mRecord.time - mFirstRecordTime) / mSpeed);
+	if (due > time) {
+		usleep(due - time);
+	}
+}
+
+void CommunicatorReplay::applyToImage(size_t offset, const uint8_t* data, size_t count) {
+	if (offset >= mImage.size()) {
+		return;
+	}
+	if (offset + count > mImage.size()) {
+		count = mImage.size() - offset;
+	}
+	memcpy(&mImage[offset], data, count);
+}
+
+void CommunicatorReplay::logSummary(void) {
+	LOG_INFO(logger, "Replayed " << mReads << " reads (" << mMismatchedReads << " not matching the capture), "
+		<< mWrites << " writes: " << mIdenticalWrites << " identical, " << mDifferingWrites << " differing, "
+		<< mUnmatchedWrites << " not in capture, " << mSkippedWrites << " recorded writes not repeated");
+	LOG_INFO(logger, "Bytes written: " << mBytesWritten << " (capture: " << mRecordedBytesWritten << ")");
+}
+
+uint64_t CommunicatorReplay::now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef COMMUNICATORREPLAY_H
+#define COMMUNICATORREPLAY_H
+
+#include <object_model.h>
+#include <IConfig.h>
+#include <CommCapture.h>
+#include <string>
+#include <vector>
+#include <logger.h>
+
+struct PF_ObjectParams;
+
+// Plays back a capture recorded with [Comm] recordFile. Recorded reads are
+// served in order at their recorded time (divided by replaySpeed, 0 for no
+// waiting), writes of the daemon are compared with the recorded ones. Reads
+// that do not match the next recorded one, e.g. because the daemon under
+// test accesses the bus differently, are served from a memory image built
+// from all recorded reads and the daemon's writes.
+class CommunicatorReplay: public ICommunicator {
+public:
+
+	// static plugin interface
+	static void * create(PF_ObjectParams *);
+	static int32_t destroy(void *);
+	~CommunicatorReplay();
+
+	// ICommunicator methods
+	virtual bool initInterface(void);
+	virtual size_t getMaxDataSize(void);
+	virtual ssize_t readData(size_t offset, void* buf, size_t count);
+	virtual ssize_t writeData(size_t offset, const void* buf, size_t count);
+
+	static LoggerPtr logger;
+	static IConfig* config;
+
+private:
+	CommunicatorReplay();
+	bool nextRecord(void);
+	void waitForRecord(void);
+	void applyToImage(size_t offset, const uint8_t* data, size_t count);
+	void logSummary(void);
+	static uint64_t now(void);
+
+	std::vector<uint8_t> mCapture;
+	const uint8_t* mPosition;
+	CommCaptureRecord mRecord;
+	bool mRecordValid;
+	std::vector<uint8_t> mImage;
+	double mSpeed;
+	uint64_t mStartTime; // us, 0 until the first read
+	uint64_t mFirstRecordTime;
+
+	uint64_t mReads;
+	uint64_t mMismatchedReads;
+	uint64_t mWrites;
+	uint64_t mIdenticalWrites;
+	uint64_t mDifferingWrites;
+	uint64_t mUnmatchedWrites;
+	uint64_t mSkippedWrites;
+	uint64_t mBytesWritten;
+	uint64_t mRecordedBytesWritten;
+};
+
+#endif
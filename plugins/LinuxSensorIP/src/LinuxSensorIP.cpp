@@ -26,13 +26,21 @@
 
 #include <cstring>
 #include <cstdlib>
+#include <errno.h>
+#include <unistd.h>
 #include <sys/types.h>
+#include <sys/socket.h>
 #include <ifaddrs.h>
 #include <netinet/in.h>
 #include <string.h>
 #include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 #include "daemon_msgs.h"
 
+#define MAX_STRING_SIZE		255
+#define DEFAULT_STRING_SIZE	128
+
 using namespace std;
 
 LoggerPtr LinuxSensorIP::logger;
@@ -48,63 +56,138 @@ int32_t LinuxSensorIP::destroy(void * p) {
 	return 0;
 }
 
-LinuxSensorIP::LinuxSensorIP() {
+LinuxSensorIP::LinuxSensorIP() : mStringSize(DEFAULT_STRING_SIZE), mNetlinkFd(-1) {
 }
 
 LinuxSensorIP::~LinuxSensorIP() {
+	if (mNetlinkFd >= 0) {
+		close(mNetlinkFd);
+	}
 }
 
 bool LinuxSensorIP::configure(const char* data) {
 	BaseSensor::configure(data);
 
-    struct ifaddrs * ifAddrStruct=NULL;
-    struct ifaddrs * ifa=NULL;
-    void * tmpAddrPtr=NULL;
-
-    getifaddrs(&ifAddrStruct);
-
-    for (ifa = ifAddrStruct; ifa != NULL; ifa = ifa->ifa_next) {
-        if (!ifa->ifa_addr) {
-            continue;
-        }
-        if (ifa->ifa_addr->sa_family == AF_INET) { // check it is IP4
-            // is a valid IP4 Address
-            tmpAddrPtr=&((struct sockaddr_in *)ifa->ifa_addr)->sin_addr;
-            char addressBuffer[INET_ADDRSTRLEN];
-            inet_ntop(AF_INET, tmpAddrPtr, addressBuffer, INET_ADDRSTRLEN);
-            //printf("%s IP Address %s\n", ifa->ifa_name, addressBuffer);
-            mIPs += string(addressBuffer) + ", ";
-        } else if (ifa->ifa_addr->sa_family == AF_INET6) { // check it is IP6
-            // is a valid IP6 Address
-            tmpAddrPtr=&((struct sockaddr_in6 *)ifa->ifa_addr)->sin6_addr;
-            char addressBuffer[INET6_ADDRSTRLEN];
-            inet_ntop(AF_INET6, tmpAddrPtr, addressBuffer, INET6_ADDRSTRLEN);
-            //printf("%s IP Address %s\n", ifa->ifa_name, addressBuffer);
-            mIPs += string(addressBuffer) + ", ";
-        }
-    }
-    if (ifAddrStruct!=NULL) freeifaddrs(ifAddrStruct);
-
-    if (mIPs.length() > 0) {
-    	mIPs = mIPs.substr(0, mIPs.length() - 2);
-    }
+	// Size is fixed, the data message layout must not change when addresses do
+	string options(data);
+	string size = getOption(options, "size");
+	if (size != "") {
+		int value = atoi(size.c_str());
+		if (value > 1 && value <= MAX_STRING_SIZE) {
+			mStringSize = value;
+		} else {
+			LOG_WARN(logger, "Invalid 'size' attribute '" << size << "', using " << DEFAULT_STRING_SIZE);
+		}
+	}
+
+	// Subscribe before reading so no change in between is lost
+	if (!openNetlink()) {
+		LOG_WARN(logger, "Could not subscribe to address changes: " << strerror(errno) << ", addresses are read once");
+	}
+	readAddresses();
 
 	return true;
 }
 
+bool LinuxSensorIP::openNetlink(void) {
+	mNetlinkFd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (mNetlinkFd < 0) {
+		return false;
+	}
+	struct sockaddr_nl addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+	if (bind(mNetlinkFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+		int error = errno;
+		close(mNetlinkFd);
+		mNetlinkFd = -1;
+		errno = error;
+		return false;
+	}
+	return true;
+}
+
+void LinuxSensorIP::readAddresses(void) {
+	struct ifaddrs * ifAddrStruct = NULL;
+	struct ifaddrs * ifa = NULL;
+	void * tmpAddrPtr = NULL;
+
+	mIPs.clear();
+	if (getifaddrs(&ifAddrStruct) != 0) {
+		LOG_WARN(logger, "Could not read interface addresses: " << strerror(errno));
+		return;
+	}
+
+	for (ifa = ifAddrStruct; ifa != NULL; ifa = ifa->ifa_next) {
+		if (!ifa->ifa_addr) {
+			continue;
+		}
+		char addressBuffer[INET6_ADDRSTRLEN];
+		if (ifa->ifa_addr->sa_family == AF_INET) {
+			tmpAddrPtr = &((struct sockaddr_in *)ifa->ifa_addr)->sin_addr;
+			inet_ntop(AF_INET, tmpAddrPtr, addressBuffer, INET_ADDRSTRLEN);
+		} else if (ifa->ifa_addr->sa_family == AF_INET6) {
+			tmpAddrPtr = &((struct sockaddr_in6 *)ifa->ifa_addr)->sin6_addr;
+			inet_ntop(AF_INET6, tmpAddrPtr, addressBuffer, INET6_ADDRSTRLEN);
+		} else {
+			continue;
+		}
+		// Only whole addresses, the rest is cut off
+		string address = mIPs.empty() ? string(addressBuffer) : ", " + string(addressBuffer);
+		if (mIPs.length() + address.length() > mStringSize) {
+			LOG_DEBUG(logger, "Addresses exceed " << mStringSize << " characters, truncated");
+			break;
+		}
+		mIPs += address;
+	}
+	freeifaddrs(ifAddrStruct);
+}
+
 ISensorDataType LinuxSensorIP::getDataType(void) {
 	return TYPE_STR;
 }
 
 size_t LinuxSensorIP::getMaxDataSize(void) {
-	return mIPs.length();
+	return mStringSize;
 }
 
 bool LinuxSensorIP::getData(uint8_t* data) {
+	memset(data, 0, mStringSize);
 	memcpy(data, mIPs.c_str(), mIPs.length());
 	return true;
 }
 
+bool LinuxSensorIP::isStatic(void) {
+	return mNetlinkFd >= 0;
+}
+
+bool LinuxSensorIP::hasChanged(void) {
+	bool changed = false;
+	char buffer[8192];
+	while (true) {
+		ssize_t len = recv(mNetlinkFd, buffer, sizeof(buffer), 0);
+		if (len < 0) {
+			if (errno == ENOBUFS) {
+				// Notifications were dropped, re-read to be safe
+				changed = true;
+				continue;
+			}
+			break;
+		}
+		for (struct nlmsghdr* msg = (struct nlmsghdr*)buffer; NLMSG_OK(msg, (size_t)len); msg = NLMSG_NEXT(msg, len)) {
+			if (msg->nlmsg_type == RTM_NEWADDR || msg->nlmsg_type == RTM_DELADDR) {
+				changed = true;
+			}
+		}
+	}
+	if (changed) {
+		readAddresses();
+		LOG_DEBUG(logger, "Addresses changed: " << mIPs);
+	}
+	return changed;
+}
+
 const char* LinuxSensorIP::getDescription(void) {
 	return "Returns IP addresses of NICs";
 }
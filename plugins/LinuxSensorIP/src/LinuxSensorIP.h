@@ -49,6 +49,8 @@ public:
 	virtual bool getData(uint8_t* data);
 	virtual const char* getDescription(void);
 	virtual ISensorUnit getUnit(void);
+	virtual bool isStatic(void);
+	virtual bool hasChanged(void);
 
 	virtual LoggerPtr getLogger(void);
 
@@ -56,8 +58,16 @@ public:
 
 private:
 	LinuxSensorIP();
+	//lint -e(1704)
+	LinuxSensorIP(const LinuxSensorIP& cSource);
+	LinuxSensorIP& operator=(const LinuxSensorIP& cSource);
+
+	bool openNetlink(void);
+	void readAddresses(void);
 
 	string mIPs;
+	size_t mStringSize;
+	int mNetlinkFd; // Address change notifications, -1 if unavailable
 };
 
 #endif
@@ -0,0 +1,389 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LinuxSensorProviderCgroup.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <unistd.h>
+#include <errno.h>
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <daemon_msgs.h>
+
+using namespace std;
+
+LoggerPtr LinuxSensorProviderCgroup::logger;
+IConfig* LinuxSensorProviderCgroup::config;
+
+static long cpuCount = 1;
+
+LinuxSensorProviderCgroup::GroupInfo::GroupInfo(const string& path) :
+	cpuStat((path + "/cpu.stat").c_str(), 1024), memoryCurrent((path + "/memory.current").c_str(), 32), ioStat((path + "/io.stat").c_str(), 4096),
+	sensorNames(), ioWriteSensor(NULL), lastCpuUsage(0), lastReadBytes(0), lastWriteBytes(0), refCount(0) {
+	lastCpuUpdate.tv_sec = 0;
+	lastCpuUpdate.tv_nsec = 0;
+	lastIoUpdate.tv_sec = 0;
+	lastIoUpdate.tv_nsec = 0;
+}
+
+void * LinuxSensorProviderCgroup::create(PF_ObjectParams *) {
+	return new LinuxSensorProviderCgroup();
+}
+
+int32_t LinuxSensorProviderCgroup::destroy(void * p) {
+	if (!p)
+		return -1;
+	delete static_cast<LinuxSensorProviderCgroup*>(p);
+	return 0;
+}
+
+LinuxSensorProviderCgroup::LinuxSensorProviderCgroup() :
+	mSensors(), mDirectoryWatch(-1), mWatches(), mGroups(), mSensorNames(), mCapLogged(false) {
+	mPath = config->GetString("Plugins", "cgroupPath", "/sys/fs/cgroup");
+	mMaxGroups = config->GetInt("Plugins", "cgroupMaxGroups", 16);
+	cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpuCount < 1) {
+		cpuCount = 1;
+	}
+
+	mInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (mInotify < 0) {
+		LOG_ERROR(logger, "Could not create inotify instance: " << strerror(errno));
+		return;
+	}
+	mDirectoryWatch = inotify_add_watch(mInotify, mPath.c_str(), IN_CREATE | IN_DELETE | IN_ONLYDIR);
+	if (mDirectoryWatch < 0) {
+		LOG_ERROR(logger, "Could not watch cgroup directory " << mPath << ": " << strerror(errno));
+		return;
+	}
+	vector<string> removed;
+	scan(mSensors, removed);
+}
+
+LinuxSensorProviderCgroup::~LinuxSensorProviderCgroup() {
+	// Groups are owned by their sensors
+	if (mInotify >= 0) {
+		close(mInotify);
+	}
+}
+
+map<string, ISensor*> LinuxSensorProviderCgroup::getSensors(void) {
+	return mSensors;
+}
+
+bool LinuxSensorProviderCgroup::pollSensorChanges(map<string, ISensor*>& added, vector<string>& removed) {
+	if (mDirectoryWatch < 0) {
+		return false;
+	}
+	char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	while (true) {
+		ssize_t length = read(mInotify, buffer, sizeof(buffer));
+		if (length <= 0) {
+			if (length < 0 && errno != EAGAIN && errno != EINTR) {
+				LOG_ERROR(logger, "Could not read inotify events: " << strerror(errno));
+			}
+			break;
+		}
+		for (char* p = buffer; p < buffer + length; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len) {
+			const struct inotify_event* event = (const struct inotify_event*)p;
+			if (event->mask & IN_Q_OVERFLOW) {
+				LOG_WARN(logger, "inotify queue overflow, rescanning " << mPath);
+				scan(added, removed);
+			} else if (event->wd == mDirectoryWatch && event->len > 0 && (event->mask & IN_ISDIR)) {
+				if (event->mask & IN_CREATE) {
+					watchGroup(event->name);
+					checkGroup(event->name, added, removed);
+				} else if (event->mask & IN_DELETE) {
+					unwatchGroup(event->name, added, removed);
+				}
+			} else {
+				map<int, string>::iterator watch = mWatches.find(event->wd);
+				if (watch == mWatches.end()) {
+					continue;
+				}
+				string group = watch->second;
+				if (event->mask & IN_IGNORED) {
+					// cgroup.events is gone with its group
+					mWatches.erase(watch);
+					removeGroup(group, added, removed);
+				} else {
+					checkGroup(group, added, removed);
+				}
+			}
+		}
+	}
+	// A group removed and recreated within one poll is in both lists, the
+	// SensorSet applies removals first. One created and removed again is in neither.
+	return !added.empty() || !removed.empty();
+}
+
+void LinuxSensorProviderCgroup::scan(map<string, ISensor*>& added, vector<string>& removed) {
+	vector<string> groups;
+	DIR* dir = opendir(mPath.c_str());
+	if (dir == NULL) {
+		LOG_ERROR(logger, "Could not open cgroup directory " << mPath << ": " << strerror(errno));
+		return;
+	}
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (entry->d_type == DT_DIR && entry->d_name[0] != '.') {
+			groups.push_back(entry->d_name);
+		}
+	}
+	closedir(dir);
+	sort(groups.begin(), groups.end());
+
+	// Groups that vanished while events were lost
+	vector<string> watched;
+	for (map<int, string>::iterator watch = mWatches.begin(); watch != mWatches.end(); ++watch) {
+		if (find(groups.begin(), groups.end(), watch->second) == groups.end()) {
+			watched.push_back(watch->second);
+		}
+	}
+	for (vector<string>::iterator group = watched.begin(); group != watched.end(); ++group) {
+		unwatchGroup(*group, added, removed);
+	}
+	for (vector<string>::iterator group = groups.begin(); group != groups.end(); ++group) {
+		watchGroup(*group);
+		checkGroup(*group, added, removed);
+	}
+}
+
+void LinuxSensorProviderCgroup::watchGroup(const string& group) {
+	string path = mPath + "/" + group + "/cgroup.events";
+	int watch = inotify_add_watch(mInotify, path.c_str(), IN_MODIFY);
+	if (watch < 0) {
+		LOG_WARN(logger, "Could not watch " << path << ": " << strerror(errno));
+		return;
+	}
+	mWatches[watch] = group;
+}
+
+void LinuxSensorProviderCgroup::unwatchGroup(const string& group, map<string, ISensor*>& added, vector<string>& removed) {
+	for (map<int, string>::iterator watch = mWatches.begin(); watch != mWatches.end(); ++watch) {
+		if (watch->second == group) {
+			inotify_rm_watch(mInotify, watch->first);
+			mWatches.erase(watch);
+			break;
+		}
+	}
+	removeGroup(group, added, removed);
+}
+
+void LinuxSensorProviderCgroup::checkGroup(const string& group, map<string, ISensor*>& added, vector<string>& removed) {
+	string path = mPath + "/" + group + "/cgroup.events";
+	ProcFile events(path.c_str(), 128);
+	bool populated = false;
+	if (events.read()) {
+		const char* p = events.data();
+		uint64_t value;
+		populated = procFindLine(p, events.end(), "populated ") && procScanUint64(p, events.end(), value) && value != 0;
+	}
+
+	bool exposed = mGroups.find(group) != mGroups.end();
+	if (populated && !exposed) {
+		if (mGroups.size() >= mMaxGroups) {
+			if (!mCapLogged) {
+				LOG_WARN(logger, "Maximum of " << mMaxGroups << " cgroups reached, ignoring " << group << " and further ones (Plugins->cgroupMaxGroups)");
+				mCapLogged = true;
+			}
+			return;
+		}
+		LOG_INFO(logger, "Found cgroup " << group);
+		addGroup(group, added);
+	} else if (!populated && exposed) {
+		removeGroup(group, added, removed);
+	}
+}
+
+void LinuxSensorProviderCgroup::addGroup(const string& group, map<string, ISensor*>& sensors) {
+	string name = shortName(group);
+	if (mSensorNames.find(name + " CPU") != mSensorNames.end()) {
+		LOG_WARN(logger, "Sensor name of cgroup " << group << " clashes with another group, ignoring");
+		return;
+	}
+	GroupInfo* tag = new GroupInfo(mPath + "/" + group);
+	tag->refCount = 1;
+	mGroups[group] = tag;
+
+	addSensor(tag, name + " CPU", TYPE_FLOAT, UNIT_PERCENT, &LinuxSensorProviderCgroup::updateCpu, sensors);
+	addSensor(tag, name + " memory", TYPE_U64, UNIT_BYTE, &LinuxSensorProviderCgroup::updateMemory, sensors);
+	addSensor(tag, name + " IO read", TYPE_U32, UNIT_BYTE_SECOND, &LinuxSensorProviderCgroup::updateIo, sensors);
+	tag->ioWriteSensor = addSensor(tag, name + " IO write", TYPE_U32, UNIT_BYTE_SECOND, NULL, sensors);
+
+	if (--tag->refCount == 0) {
+		delete tag;
+	}
+}
+
+SensorBean* LinuxSensorProviderCgroup::addSensor(GroupInfo* tag, const string& name, ISensorDataType dataType, ISensorUnit unit, SensorBean::updateSensorCallback_t callback, map<string, ISensor*>& sensors) {
+	SensorBean* sensor = new SensorBean(name, dataType, dataType == TYPE_U32 ? 4 : 8, 1, unit, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	if (dataType == TYPE_FLOAT) {
+		sensor->setData(0.0);
+	} else if (dataType == TYPE_U64) {
+		sensor->setData((uint64_t)0);
+	} else {
+		sensor->setData((uint32_t)0);
+	}
+	if (callback != NULL) {
+		sensor->setUpdateCallback(callback);
+	}
+	sensor->setDestroyCallback(&LinuxSensorProviderCgroup::destroySensor);
+	sensor->mTag = tag;
+	tag->refCount++;
+	tag->sensorNames.push_back(name);
+	mSensorNames.insert(name);
+	sensors[name] = sensor;
+	return sensor;
+}
+
+void LinuxSensorProviderCgroup::removeGroup(const string& group, map<string, ISensor*>& added, vector<string>& removed) {
+	map<string, GroupInfo*>::iterator info = mGroups.find(group);
+	if (info == mGroups.end()) {
+		return;
+	}
+	LOG_INFO(logger, "cgroup " << group << " removed");
+	// Deleting the last sensor deletes the group info
+	vector<string> sensorNames = info->second->sensorNames;
+	mGroups.erase(info);
+	mCapLogged = false;
+	for (vector<string>::iterator name = sensorNames.begin(); name != sensorNames.end(); ++name) {
+		mSensorNames.erase(*name);
+		// Group created in this poll, the SensorSet has never seen its sensors
+		map<string, ISensor*>::iterator sensor = added.find(*name);
+		if (sensor != added.end()) {
+			delete sensor->second;
+			added.erase(sensor);
+		} else {
+			removed.push_back(*name);
+		}
+	}
+}
+
+string LinuxSensorProviderCgroup::shortName(const string& group) {
+	// systemd unit suffixes carry no information here
+	static const char* suffixes[] = { ".slice", ".scope", ".service" };
+	string name = group;
+	for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); ++i) {
+		size_t length = strlen(suffixes[i]);
+		if (name.length() > length && name.compare(name.length() - length, length, suffixes[i]) == 0) {
+			name.resize(name.length() - length);
+			break;
+		}
+	}
+	// Room for the longest sensor suffix " IO write"
+	if (name.length() > SENSOR_NAME_LENGTH - 9) {
+		name.resize(SENSOR_NAME_LENGTH - 9);
+	}
+	return name;
+}
+
+void LinuxSensorProviderCgroup::updateCpu(SensorBean* sensor) {
+	GroupInfo* tag = static_cast<GroupInfo*>(sensor->mTag);
+	if (!tag->cpuStat.read()) {
+		return;
+	}
+	const char* p = tag->cpuStat.data();
+	uint64_t usage;
+	if (!procFindLine(p, tag->cpuStat.end(), "usage_usec ") || !procScanUint64(p, tag->cpuStat.end(), usage)) {
+		return;
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	// On first update only get current time and values
+	if (tag->lastCpuUpdate.tv_sec != 0 && usage >= tag->lastCpuUsage) {
+		double diff = (now.tv_sec - tag->lastCpuUpdate.tv_sec) * 1000000.0 + (now.tv_nsec - tag->lastCpuUpdate.tv_nsec) / 1000.0;
+		if (diff > 0.0) {
+			// Percent of all cpus of the node, like the node's "CPU" sensor
+			sensor->setData((double)(usage - tag->lastCpuUsage) * 100.0 / (diff * cpuCount));
+		}
+	}
+	tag->lastCpuUpdate = now;
+	tag->lastCpuUsage = usage;
+}
+
+void LinuxSensorProviderCgroup::updateMemory(SensorBean* sensor) {
+	GroupInfo* tag = static_cast<GroupInfo*>(sensor->mTag);
+	if (!tag->memoryCurrent.read()) {
+		return;
+	}
+	const char* p = tag->memoryCurrent.data();
+	uint64_t current;
+	if (procScanUint64(p, tag->memoryCurrent.end(), current)) {
+		sensor->setData(current);
+	}
+}
+
+void LinuxSensorProviderCgroup::updateIo(SensorBean* sensor) {
+	GroupInfo* tag = static_cast<GroupInfo*>(sensor->mTag);
+	if (!tag->ioStat.read()) {
+		return;
+	}
+	// One line per device: "<major>:<minor> rbytes=<n> wbytes=<n> rios=<n> ..."
+	uint64_t readBytes = 0;
+	uint64_t writeBytes = 0;
+	const char* p = tag->ioStat.data();
+	const char* end = tag->ioStat.end();
+	while (p < end) {
+		if (*p == 'r' && end - p > 7 && memcmp(p, "rbytes=", 7) == 0) {
+			p += 7;
+			uint64_t value;
+			if (procScanUint64(p, end, value)) {
+				readBytes += value;
+			}
+		} else if (*p == 'w' && end - p > 7 && memcmp(p, "wbytes=", 7) == 0) {
+			p += 7;
+			uint64_t value;
+			if (procScanUint64(p, end, value)) {
+				writeBytes += value;
+			}
+		} else {
+			++p;
+		}
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	// Devices disappearing from io.stat make the sums go backwards
+	if (tag->lastIoUpdate.tv_sec != 0 && readBytes >= tag->lastReadBytes && writeBytes >= tag->lastWriteBytes) {
+		double diff = (now.tv_sec - tag->lastIoUpdate.tv_sec) + (now.tv_nsec - tag->lastIoUpdate.tv_nsec) / 1000000000.0;
+		if (diff > 0.0) {
+			sensor->setData((uint32_t)((double)(readBytes - tag->lastReadBytes) / diff));
+			tag->ioWriteSensor->setData((uint32_t)((double)(writeBytes - tag->lastWriteBytes) / diff));
+		}
+	}
+	tag->lastIoUpdate = now;
+	tag->lastReadBytes = readBytes;
+	tag->lastWriteBytes = writeBytes;
+}
+
+void LinuxSensorProviderCgroup::destroySensor(SensorBean* sensor) {
+	GroupInfo* tag = static_cast<GroupInfo*>(sensor->mTag);
+	if (--tag->refCount == 0) {
+		delete tag;
+	}
+}
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LINUXSENSORPROVIDERCGROUP_H
+#define LINUXSENSORPROVIDERCGROUP_H
+
+#include <object_model.h>
+#include <string>
+#include <map>
+#include <set>
+#include <vector>
+#include <time.h>
+#include <logger.h>
+#include <c_object_model.h>
+#include <SensorBean.h>
+#include <IConfig.h>
+#include <ProcFile.h>
+
+struct PF_ObjectParams;
+
+// CPU, memory and IO use of the child groups of a cgroup v2 directory.
+// Groups are added when they become populated and removed when they become
+// empty or are deleted, driven by inotify on their cgroup.events files.
+class LinuxSensorProviderCgroup: public IDynamicSensorProvider {
+public:
+	class GroupInfo {
+		public:
+		GroupInfo(const std::string& path);
+
+		ProcFile cpuStat;
+		ProcFile memoryCurrent;
+		ProcFile ioStat;
+		std::vector<std::string> sensorNames;
+		SensorBean* ioWriteSensor;
+		struct timespec lastCpuUpdate;
+		uint64_t lastCpuUsage; // µs
+		struct timespec lastIoUpdate;
+		uint64_t lastReadBytes;
+		uint64_t lastWriteBytes;
+		int refCount;
+	};
+
+	// static plugin interface
+	static void * create(PF_ObjectParams *);
+	static int32_t destroy(void *);
+	~LinuxSensorProviderCgroup();
+
+	// ISensorProvider methods
+	virtual std::map<std::string, ISensor*> getSensors(void);
+
+	// IDynamicSensorProvider methods
+	virtual bool pollSensorChanges(std::map<std::string, ISensor*>& added, std::vector<std::string>& removed);
+
+	static LoggerPtr logger;
+	static IConfig* config;
+private:
+	LinuxSensorProviderCgroup();
+	void scan(std::map<std::string, ISensor*>& added, std::vector<std::string>& removed);
+	void watchGroup(const std::string& group);
+	void unwatchGroup(const std::string& group, std::map<std::string, ISensor*>& added, std::vector<std::string>& removed);
+	void checkGroup(const std::string& group, std::map<std::string, ISensor*>& added, std::vector<std::string>& removed);
+	void addGroup(const std::string& group, std::map<std::string, ISensor*>& sensors);
+	void removeGroup(const std::string& group, std::map<std::string, ISensor*>& added, std::vector<std::string>& removed);
+	SensorBean* addSensor(GroupInfo* tag, const std::string& name, ISensorDataType dataType, ISensorUnit unit, SensorBean::updateSensorCallback_t callback, std::map<std::string, ISensor*>& sensors);
+	static std::string shortName(const std::string& group);
+	static void updateCpu(SensorBean* sensor);
+	static void updateMemory(SensorBean* sensor);
+	static void updateIo(SensorBean* sensor);
+	static void destroySensor(SensorBean* sensor);
+
+	std::map<std::string, ISensor*> mSensors;
+	std::string mPath;
+	size_t mMaxGroups;
+	int mInotify;
+	int mDirectoryWatch;
+	std::map<int, std::string> mWatches; // cgroup.events watch -> group
+	std::map<std::string, GroupInfo*> mGroups; // Currently exposed groups, owned by their sensors
+	std::set<std::string> mSensorNames; // Of the exposed groups, shortened names may clash
+	bool mCapLogged;
+};
+
+#endif
@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "DiskStats.h"
+
+// About 100 bytes per line, enough for more than a thousand devices
+#define DISKSTATS_BUFFER_SIZE	(128 * 1024)
+
+DiskStats::DiskStats() :
+	mFile("/proc/diskstats", DISKSTATS_BUFFER_SIZE), mTracked(), mLines(), mCurrent(0), mGeneration(0), mRefCount(0) {
+	for (int i = 0; i < 2; ++i) {
+		mSnapshots[i].timestamp.tv_sec = 0;
+		mSnapshots[i].timestamp.tv_nsec = 0;
+	}
+}
+
+void DiskStats::acquire(void) {
+	mRefCount++;
+}
+
+void DiskStats::release(void) {
+	if (--mRefCount == 0) {
+		delete this;
+	}
+}
+
+std::vector<std::string> DiskStats::getDeviceNames(void) {
+	if (mLines.empty()) {
+		read();
+	}
+	std::vector<std::string> names;
+	for (std::vector<std::pair<std::string, long> >::iterator line = mLines.begin(); line != mLines.end(); ++line) {
+		names.push_back(line->first);
+	}
+	return names;
+}
+
+size_t DiskStats::track(const std::string& name) {
+	std::map<std::string, size_t>::iterator it = mTracked.find(name);
+	if (it != mTracked.end()) {
+		return it->second;
+	}
+	size_t index = mTracked.size();
+	mTracked[name] = index;
+	for (int i = 0; i < 2; ++i) {
+		mSnapshots[i].values.resize((index + 1) * FIELD_COUNT, 0);
+		mSnapshots[i].valid.resize(index + 1, false);
+	}
+	// Line cache has to learn the new index
+	mLines.clear();
+	return index;
+}
+
+bool DiskStats::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		read();
+	}
+	seenGeneration = mGeneration;
+	return mGeneration >= 2;
+}
+
+void DiskStats::read(void) {
+	mCurrent ^= 1;
+	mGeneration++;
+	Snapshot& snapshot = mSnapshots[mCurrent];
+	clock_gettime(CLOCK_MONOTONIC, &snapshot.timestamp);
+	snapshot.valid.assign(mTracked.size(), false);
+
+	if (!mFile.read()) {
+		return;
+	}
+	// <major> <minor> <name> <reads> <merged> <sectors> <ms> <writes> <merged> <sectors> <ms> <in flight> <io ms> ...
+	const char* p = mFile.data();
+	const char* end = mFile.end();
+	size_t line = 0;
+	while (p < end) {
+		uint64_t number;
+		if (!procScanUint64(p, end, number) || !procScanUint64(p, end, number)) {
+			procNextLine(p, end);
+			continue;
+		}
+		procSkipBlanks(p, end);
+		const char* name = p;
+		while (p < end && *p != ' ' && *p != '\n') {
+			++p;
+		}
+		size_t nameLength = p - name;
+
+		if (line >= mLines.size() || mLines[line].first.compare(0, std::string::npos, name, nameLength) != 0) {
+			// Device list changed (or first read), remember the new device on this line
+			std::string deviceName(name, nameLength);
+			std::map<std::string, size_t>::iterator tracked = mTracked.find(deviceName);
+			std::pair<std::string, long> entry(deviceName, tracked != mTracked.end() ? (long)tracked->second : -1);
+			if (line >= mLines.size()) {
+				mLines.push_back(entry);
+			} else {
+				mLines[line] = entry;
+			}
+		}
+		long index = mLines[line].second;
+		++line;
+		if (index < 0) {
+			procNextLine(p, end);
+			continue;
+		}
+
+		uint64_t fields[11];
+		bool complete = true;
+		for (int i = 0; i < 11; ++i) {
+			if (!procScanUint64(p, end, fields[i])) {
+				complete = false;
+				break;
+			}
+		}
+		if (complete) {
+			uint64_t* values = &snapshot.values[index * FIELD_COUNT];
+			values[READS] = fields[0];
+			values[READ_SECTORS] = fields[2];
+			values[READ_TIME] = fields[3];
+			values[WRITES] = fields[4];
+			values[WRITE_SECTORS] = fields[6];
+			values[WRITE_TIME] = fields[7];
+			values[IO_TIME] = fields[9];
+			snapshot.valid[index] = true;
+		}
+		procNextLine(p, end);
+	}
+	mLines.resize(line);
+}
+
+bool DiskStats::getDelta(size_t index, uint64_t* delta, double& elapsed) const {
+	const Snapshot& current = mSnapshots[mCurrent];
+	const Snapshot& last = mSnapshots[mCurrent ^ 1];
+	if (index >= current.valid.size() || !current.valid[index] || !last.valid[index]) {
+		return false;
+	}
+	elapsed = (double)(current.timestamp.tv_sec - last.timestamp.tv_sec) + (double)(current.timestamp.tv_nsec - last.timestamp.tv_nsec) / 1e9;
+	if (elapsed <= 0.0) {
+		return false;
+	}
+	for (int i = 0; i < FIELD_COUNT; ++i) {
+		uint64_t now = current.values[index * FIELD_COUNT + i];
+		uint64_t before = last.values[index * FIELD_COUNT + i];
+		// Counters restart when a device is removed and added again
+		delta[i] = now >= before ? now - before : 0;
+	}
+	return true;
+}
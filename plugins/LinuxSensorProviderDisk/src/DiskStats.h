@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DISKSTATS_H_
+#define DISKSTATS_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <ProcFile.h>
+
+// Snapshot of /proc/diskstats shared by all device sensors. The file is read
+// once per tick: the first sensor that already consumed the current snapshot
+// triggers the next read, all others reuse it.
+class DiskStats {
+public:
+	enum Field { READS, READ_SECTORS, READ_TIME, WRITES, WRITE_SECTORS, WRITE_TIME, IO_TIME, FIELD_COUNT };
+
+	DiskStats();
+
+	void acquire(void);
+	void release(void);
+
+	// All devices listed in the last snapshot
+	std::vector<std::string> getDeviceNames(void);
+	// Device values to keep in the snapshots, returns the index to query them
+	size_t track(const std::string& name);
+
+	// Returns false until two snapshots are available
+	bool update(uint32_t& seenGeneration);
+
+	// Deltas since the last snapshot, false if the device vanished or nothing elapsed
+	bool getDelta(size_t index, uint64_t* delta, double& elapsed) const;
+
+private:
+	//lint -e(1704)
+	DiskStats(const DiskStats& cSource);
+	DiskStats& operator=(const DiskStats& cSource);
+
+	struct Snapshot {
+		std::vector<uint64_t> values; // FIELD_COUNT values per tracked device
+		std::vector<bool> valid;
+		struct timespec timestamp;
+	};
+
+	void read(void);
+
+	ProcFile mFile;
+	std::map<std::string, size_t> mTracked;
+	// Device name and tracked index (or -1) per line of the last read, to
+	// match lines without allocating as long as the device list is unchanged
+	std::vector<std::pair<std::string, long> > mLines;
+	Snapshot mSnapshots[2];
+	int mCurrent;
+	uint32_t mGeneration;
+	int mRefCount;
+};
+
+#endif /* DISKSTATS_H_ */
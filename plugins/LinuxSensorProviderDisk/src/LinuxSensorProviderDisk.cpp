@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LinuxSensorProviderDisk.h"
+#include "DiskStats.h"
+
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+#include <unistd.h>
+#include <fnmatch.h>
+#include <sys/statvfs.h>
+#include <daemon_msgs.h>
+
+using namespace std;
+
+#define SECTOR_SIZE	512 // /proc/diskstats always counts 512 byte sectors
+
+LoggerPtr LinuxSensorProviderDisk::logger;
+IConfig* LinuxSensorProviderDisk::config;
+
+void * LinuxSensorProviderDisk::create(PF_ObjectParams *) {
+	return new LinuxSensorProviderDisk();
+}
+
+int32_t LinuxSensorProviderDisk::destroy(void * p) {
+	if (!p)
+		return -1;
+	delete static_cast<LinuxSensorProviderDisk*>(p);
+	return 0;
+}
+
+LinuxSensorProviderDisk::LinuxSensorProviderDisk() :
+	mSensors() {
+	vector<string> include = splitPatterns(config->GetString("Plugins", "diskInclude", "*"));
+	vector<string> exclude = splitPatterns(config->GetString("Plugins", "diskExclude", "loop*,ram*,zram*,sr*,fd*"));
+	bool partitions = config->GetBoolean("Plugins", "diskPartitions", false);
+	size_t maxDevices = config->GetInt("Plugins", "diskMaxDevices", 16);
+
+	DiskStats* stats = new DiskStats();
+	stats->acquire();
+	vector<string> devices = stats->getDeviceNames();
+	size_t count = 0;
+	for (vector<string>::iterator device = devices.begin(); device != devices.end(); ++device) {
+		if (!matches(*device, include) || matches(*device, exclude)) {
+			continue;
+		}
+		// Only whole disks are listed in /sys/block
+		if (!partitions && access(("/sys/block/" + *device).c_str(), F_OK) != 0) {
+			continue;
+		}
+		if (count >= maxDevices) {
+			LOG_WARN(logger, "Maximum of " << maxDevices << " devices reached, ignoring " << *device << " and further ones (Plugins->diskMaxDevices)");
+			break;
+		}
+		LOG_INFO(logger, "Found block device " << *device);
+		size_t index = stats->track(*device);
+		// Room for the longest sensor suffix " latency"
+		string name = device->substr(0, SENSOR_NAME_LENGTH - 8);
+		addDiskSensor(stats, name + " read", TYPE_U64, UNIT_BYTE_SECOND, DISK_READ, index);
+		addDiskSensor(stats, name + " write", TYPE_U64, UNIT_BYTE_SECOND, DISK_WRITE, index);
+		addDiskSensor(stats, name + " IOPS", TYPE_FLOAT, UNIT_DIMENSIONLESS, DISK_IOPS, index);
+		addDiskSensor(stats, name + " latency", TYPE_FLOAT, UNIT_DIMENSIONLESS, DISK_LATENCY, index);
+		addDiskSensor(stats, name + " util.", TYPE_FLOAT, UNIT_PERCENT, DISK_UTILIZATION, index);
+		count++;
+	}
+	stats->release();
+
+	vector<string> mounts = splitPatterns(config->GetString("Plugins", "diskMounts", ""));
+	for (vector<string>::iterator mount = mounts.begin(); mount != mounts.end(); ++mount) {
+		addMountSensor(*mount);
+	}
+}
+
+LinuxSensorProviderDisk::~LinuxSensorProviderDisk() {
+}
+
+map<string, ISensor*> LinuxSensorProviderDisk::getSensors(void) {
+	return mSensors;
+}
+
+vector<string> LinuxSensorProviderDisk::splitPatterns(const string& patterns) {
+	vector<string> result;
+	std::stringstream ss(patterns);
+	string pattern;
+	while (std::getline(ss, pattern, ',')) {
+		if (!pattern.empty()) {
+			result.push_back(pattern);
+		}
+	}
+	return result;
+}
+
+bool LinuxSensorProviderDisk::matches(const string& name, const vector<string>& patterns) {
+	for (vector<string>::const_iterator iterator = patterns.begin(); iterator != patterns.end(); ++iterator) {
+		if (fnmatch(iterator->c_str(), name.c_str(), 0) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void LinuxSensorProviderDisk::addDiskSensor(DiskStats* stats, const string& name, ISensorDataType dataType, ISensorUnit unit, DiskKind kind, size_t index) {
+	DiskSensor* tag = new DiskSensor();
+	tag->stats = stats;
+	tag->kind = kind;
+	tag->index = index;
+	tag->generation = 0;
+	stats->acquire();
+
+	SensorBean* sensor = new SensorBean(name, dataType, 8, 1, unit, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	if (dataType == TYPE_U64) {
+		sensor->setData((uint64_t)0);
+	} else {
+		sensor->setData(0.0);
+	}
+	sensor->mTag = tag;
+	sensor->setUpdateCallback(&LinuxSensorProviderDisk::updateDiskSensor);
+	sensor->setDestroyCallback(&LinuxSensorProviderDisk::destroyDiskSensor);
+	mSensors[name] = sensor;
+}
+
+void LinuxSensorProviderDisk::updateDiskSensor(SensorBean* sensor) {
+	DiskSensor* tag = static_cast<DiskSensor*>(sensor->mTag);
+	// On first update only get current values
+	if (!tag->stats->update(tag->generation)) {
+		return;
+	}
+	uint64_t delta[DiskStats::FIELD_COUNT];
+	double elapsed;
+	if (!tag->stats->getDelta(tag->index, delta, elapsed)) {
+		return;
+	}
+	uint64_t ios = delta[DiskStats::READS] + delta[DiskStats::WRITES];
+	switch (tag->kind) {
+		case DISK_READ:
+			sensor->setData((uint64_t)((double)(delta[DiskStats::READ_SECTORS] * SECTOR_SIZE) / elapsed));
+			break;
+		case DISK_WRITE:
+			sensor->setData((uint64_t)((double)(delta[DiskStats::WRITE_SECTORS] * SECTOR_SIZE) / elapsed));
+			break;
+		case DISK_IOPS:
+			sensor->setData((double)ios / elapsed);
+			break;
+		case DISK_LATENCY:
+			// Average time per completed request in ms
+			sensor->setData(ios > 0 ? (double)(delta[DiskStats::READ_TIME] + delta[DiskStats::WRITE_TIME]) / (double)ios : 0.0);
+			break;
+		case DISK_UTILIZATION:
+			sensor->setData(min((double)delta[DiskStats::IO_TIME] / (elapsed * 10.0), 100.0));
+			break;
+	}
+}
+
+void LinuxSensorProviderDisk::destroyDiskSensor(SensorBean* sensor) {
+	DiskSensor* tag = static_cast<DiskSensor*>(sensor->mTag);
+	tag->stats->release();
+	delete tag;
+}
+
+void LinuxSensorProviderDisk::addMountSensor(const string& mountPoint) {
+	struct statvfs stat;
+	if (statvfs(mountPoint.c_str(), &stat) != 0) {
+		LOG_WARN(logger, "Could not stat mount point " << mountPoint << ", ignoring");
+		return;
+	}
+	string name = mountPoint + " free";
+	if (name.length() > SENSOR_NAME_LENGTH) {
+		// Keep the distinguishing end of long paths
+		name = name.substr(name.length() - SENSOR_NAME_LENGTH);
+	}
+	SensorBean* sensor = new SensorBean(name, TYPE_U64, 8, 1, UNIT_BYTE, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData((uint64_t)0);
+	sensor->mTag = new string(mountPoint);
+	sensor->setUpdateCallback(&LinuxSensorProviderDisk::updateMountSensor);
+	sensor->setDestroyCallback(&LinuxSensorProviderDisk::destroyMountSensor);
+	mSensors[name] = sensor;
+}
+
+void LinuxSensorProviderDisk::updateMountSensor(SensorBean* sensor) {
+	string* mountPoint = static_cast<string*>(sensor->mTag);
+	struct statvfs stat;
+	if (statvfs(mountPoint->c_str(), &stat) == 0) {
+		sensor->setData((uint64_t)stat.f_bavail * stat.f_frsize);
+	}
+}
+
+void LinuxSensorProviderDisk::destroyMountSensor(SensorBean* sensor) {
+	delete static_cast<string*>(sensor->mTag);
+}
@@ -0,0 +1,76 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LINUXSENSORPROVIDERDISK_H
+#define LINUXSENSORPROVIDERDISK_H
+
+#include <object_model.h>
+#include <string>
+#include <map>
+#include <vector>
+#include <logger.h>
+#include <c_object_model.h>
+#include <SensorBean.h>
+#include <IConfig.h>
+
+struct PF_ObjectParams;
+class DiskStats;
+
+// Per block device throughput, IOPS, latency and utilization from
+// /proc/diskstats and free space of configured mount points
+class LinuxSensorProviderDisk: public ISensorProvider {
+public:
+	// static plugin interface
+	static void * create(PF_ObjectParams *);
+	static int32_t destroy(void *);
+	~LinuxSensorProviderDisk();
+
+	// ISensorProvider methods
+	virtual std::map<std::string, ISensor*> getSensors(void);
+
+	static LoggerPtr logger;
+	static IConfig* config;
+private:
+	enum DiskKind { DISK_READ, DISK_WRITE, DISK_IOPS, DISK_LATENCY, DISK_UTILIZATION };
+	struct DiskSensor {
+		DiskStats* stats;
+		DiskKind kind;
+		size_t index;
+		uint32_t generation;
+	};
+
+	LinuxSensorProviderDisk();
+	static std::vector<std::string> splitPatterns(const std::string& patterns);
+	static bool matches(const std::string& name, const std::vector<std::string>& patterns);
+	void addDiskSensor(DiskStats* stats, const std::string& name, ISensorDataType dataType, ISensorUnit unit, DiskKind kind, size_t index);
+	void addMountSensor(const std::string& mountPoint);
+	static void updateDiskSensor(SensorBean* sensor);
+	static void destroyDiskSensor(SensorBean* sensor);
+	static void updateMountSensor(SensorBean* sensor);
+	static void destroyMountSensor(SensorBean* sensor);
+
+	std::map<std::string, ISensor*> mSensors;
+};
+
+#endif
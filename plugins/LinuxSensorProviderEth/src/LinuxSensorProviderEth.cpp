@@ -26,8 +26,6 @@
 
 #include <cstring>
 #include <cstdlib>
-#include <iostream>
-#include <fstream>
 #include <stdio.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -40,11 +38,16 @@
 #include <net/if.h>
 #include <netinet/in.h>
 #include <sys/reboot.h>
+#include <fnmatch.h>
+#include <sstream>
 #include <time.h>
+#include <ProcFile.h>
+#include "NetlinkLinkMonitor.h"
 
 using namespace std;
 
 LoggerPtr LinuxSensorProviderEth::logger;
+IConfig* LinuxSensorProviderEth::config;
 
 void * LinuxSensorProviderEth::create(PF_ObjectParams *) {
 	return new LinuxSensorProviderEth();
@@ -58,146 +61,181 @@ int32_t LinuxSensorProviderEth::destroy(void * p) {
 }
 
 LinuxSensorProviderEth::LinuxSensorProviderEth() :
-	mSensors() {
+	mSensors(), mAdapters(), mMonitor(new NetlinkLinkMonitor()), mGeneration(0), mCapLogged(false) {
+	mMonitor->acquire();
+	mInclude = splitPatterns(config->GetString("Plugins", "ethInclude", "*"));
+	mExclude = splitPatterns(config->GetString("Plugins", "ethExclude", "veth*,docker*,br-*,virbr*"));
+	mMaxInterfaces = config->GetInt("Plugins", "ethMaxInterfaces", 16);
 
-	struct ifreq ifr;
-	struct ifconf ifc;
-	char buf[1024];
-
-	int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
-	if (sock == -1) {
-		LOG_ERROR(logger, "Could not create socket");
-		return;
-	};
-
-	ifc.ifc_len = sizeof(buf);
-	ifc.ifc_buf = buf;
-	if (ioctl(sock, SIOCGIFCONF, &ifc) == -1) {
-		LOG_ERROR(logger, "Could not get list of interface addresses (SIOCGIFCONF)");
+	if (!mMonitor->isOpen()) {
 		return;
 	}
-
-	struct ifreq* it = ifc.ifc_req;
-	const struct ifreq* const end = it + (ifc.ifc_len / sizeof(struct ifreq));
-
-	for (; it != end; ++it) {
-		strcpy(ifr.ifr_name, it->ifr_name);
-		if (ioctl(sock, SIOCGIFFLAGS, &ifr) == 0) {
-			if (! (ifr.ifr_flags & IFF_LOOPBACK)) { // don't count loopback
-
-				string ifaceName(it->ifr_name);
-				LOG_INFO(logger, "Found Ethernet interface " << ifaceName);
-
-				AdapterInfo* tag = new AdapterInfo();
-				tag->name = ifaceName;
-				tag->lastUpdate.tv_nsec = 0;
-				tag->lastUpdate.tv_sec = 0;
-				tag->lastCountRx = 0;
-				tag->lastCountTx = 0;
-
-				SensorBean* sensor = new SensorBean(ifaceName + " link", TYPE_STR, 6 + 8, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
-				sensor->setData((uint32_t)0);
-				sensor->setUpdateCallback(&LinuxSensorProviderEth::updateLinkStatus);
-				sensor->setDestroyCallback(&LinuxSensorProviderEth::destroySensor);
-				sensor->mTag = tag;
-				mSensors[ifaceName + " link"] = sensor;
-
-				sensor = new SensorBean(ifaceName + " util. RX", TYPE_U32, 4, 1, UNIT_BYTE_SECOND, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
-				sensor->setData((uint32_t)0);
-				sensor->setUpdateCallback(&LinuxSensorProviderEth::updateUtilization);
-				sensor->mTag = tag;
-				mSensors[ifaceName + " util. RX"] = sensor;
-
-				sensor = new SensorBean(ifaceName + " util. TX", TYPE_U32, 4, 1, UNIT_BYTE_SECOND, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
-				sensor->setData((uint32_t)0);
-				sensor->mTag = tag;
-				mSensors[ifaceName + " util. TX"] = sensor;
-				tag->txSensor = sensor;
-			}
-		} else {
-			LOG_ERROR(logger, "Could not get interface flags (SIOCGIFFLAGS)");
-		}
-	}
+	vector<string> removed;
+	discover(mSensors, removed);
 }
 
 LinuxSensorProviderEth::~LinuxSensorProviderEth() {
+	// Adapters are owned by their sensors
+	mMonitor->release();
 }
 
 map<string, ISensor*> LinuxSensorProviderEth::getSensors(void) {
 	return mSensors;
 }
 
-void LinuxSensorProviderEth::updateLinkStatus(SensorBean* sensor) {
-	AdapterInfo* tag = static_cast<AdapterInfo*>(sensor->mTag);
+bool LinuxSensorProviderEth::pollSensorChanges(map<string, ISensor*>& added, vector<string>& removed) {
+	if (!mMonitor->isOpen()) {
+		return false;
+	}
+	return discover(added, removed);
+}
 
-	string line;
-	sensor->setData("Unknown");
+vector<string> LinuxSensorProviderEth::splitPatterns(const string& patterns) {
+	vector<string> result;
+	std::stringstream ss(patterns);
+	string pattern;
+	while (std::getline(ss, pattern, ',')) {
+		if (!pattern.empty()) {
+			result.push_back(pattern);
+		}
+	}
+	return result;
+}
 
-	ifstream myfile(("/sys/class/net/" + tag->name + "/carrier").c_str());
-	if (myfile.is_open()) {
-		getline(myfile, line);
-		myfile.close();
-	} else {
-		LOG_ERROR(logger, "Could not open file '/sys/class/net/" << tag->name << "/carrier'");
-		return;
+bool LinuxSensorProviderEth::matches(const string& name) const {
+	bool included = false;
+	for (vector<string>::const_iterator iterator = mInclude.begin(); iterator != mInclude.end(); ++iterator) {
+		if (fnmatch(iterator->c_str(), name.c_str(), 0) == 0) {
+			included = true;
+			break;
+		}
+	}
+	if (!included) {
+		return false;
+	}
+	for (vector<string>::const_iterator iterator = mExclude.begin(); iterator != mExclude.end(); ++iterator) {
+		if (fnmatch(iterator->c_str(), name.c_str(), 0) == 0) {
+			return false;
+		}
 	}
+	return true;
+}
 
-	if (line == "1") {
-		ifstream myfile2(("/sys/class/net/" + tag->name + "/speed").c_str());
-		if (myfile2.is_open()) {
-			getline(myfile2, line);
-			sensor->setData(line + " MBit/s");
-			myfile2.close();
+bool LinuxSensorProviderEth::discover(map<string, ISensor*>& added, vector<string>& removed) {
+	mMonitor->update(mGeneration);
+
+	// Interfaces that vanished or were renamed
+	map<string, AdapterInfo*>::iterator adapter = mAdapters.begin();
+	while (adapter != mAdapters.end()) {
+		if (mMonitor->getLink(adapter->first) == NULL) {
+			LOG_INFO(logger, "Ethernet interface " << adapter->first << " removed");
+			removed.push_back(adapter->first + " link");
+			removed.push_back(adapter->first + " util. RX");
+			removed.push_back(adapter->first + " util. TX");
+			mAdapters.erase(adapter++);
+			mCapLogged = false;
 		} else {
-			LOG_ERROR(logger, "Could not open file '/sys/class/net/" << tag->name << "/speed'");
-			return;
+			++adapter;
 		}
-	} else {
-		sensor->setData("Down");
 	}
-}
 
-void LinuxSensorProviderEth::updateUtilization(SensorBean* sensor) {
-	AdapterInfo* tag = static_cast<AdapterInfo*>(sensor->mTag);
+	const map<int, NetlinkLinkMonitor::Link>& links = mMonitor->getLinks();
+	for (map<int, NetlinkLinkMonitor::Link>::const_iterator link = links.begin(); link != links.end(); ++link) {
+		const string& ifaceName = link->second.name;
+		if ((link->second.flags & IFF_LOOPBACK) || ifaceName.empty() || mAdapters.find(ifaceName) != mAdapters.end() || !matches(ifaceName)) {
+			continue;
+		}
+		if (mAdapters.size() >= (size_t)mMaxInterfaces) {
+			if (!mCapLogged) {
+				LOG_WARN(logger, "Maximum of " << mMaxInterfaces << " interfaces reached, ignoring " << ifaceName << " and further ones (Plugins->ethMaxInterfaces)");
+				mCapLogged = true;
+			}
+			continue;
+		}
+		LOG_INFO(logger, "Found Ethernet interface " << ifaceName);
+		addAdapter(ifaceName, added);
+	}
 
-	uint64_t rxBytes = 0;
-	uint64_t txBytes = 0;
+	return !added.empty() || !removed.empty();
+}
 
-	string line;
+void LinuxSensorProviderEth::addAdapter(const string& ifaceName, map<string, ISensor*>& sensors) {
+	AdapterInfo* tag = new AdapterInfo();
+	tag->name = ifaceName;
+	tag->lastUpdate.tv_nsec = 0;
+	tag->lastUpdate.tv_sec = 0;
+	tag->lastCountRx = 0;
+	tag->lastCountTx = 0;
+	tag->monitor = mMonitor;
+	tag->linkGeneration = 0;
+	tag->statsGeneration = 0;
+	tag->carrierChanges = 0;
+	tag->speedValid = false;
+	mMonitor->acquire();
+	mAdapters[ifaceName] = tag;
+
+	SensorBean* sensor = new SensorBean(ifaceName + " link", TYPE_STR, 6 + 8, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData((uint32_t)0);
+	sensor->setUpdateCallback(&LinuxSensorProviderEth::updateLinkStatus);
+	sensor->setDestroyCallback(&LinuxSensorProviderEth::destroySensor);
+	sensor->mTag = tag;
+	sensors[ifaceName + " link"] = sensor;
+
+	sensor = new SensorBean(ifaceName + " util. RX", TYPE_U32, 4, 1, UNIT_BYTE_SECOND, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData((uint32_t)0);
+	sensor->setUpdateCallback(&LinuxSensorProviderEth::updateUtilization);
+	sensor->mTag = tag;
+	sensors[ifaceName + " util. RX"] = sensor;
+
+	sensor = new SensorBean(ifaceName + " util. TX", TYPE_U32, 4, 1, UNIT_BYTE_SECOND, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData((uint32_t)0);
+	sensor->mTag = tag;
+	sensors[ifaceName + " util. TX"] = sensor;
+	tag->txSensor = sensor;
+}
 
-	ifstream myfile(("/sys/class/net/" + tag->name + "/statistics/rx_bytes").c_str());
-	if (myfile.is_open()) {
-		getline(myfile, line);
-		std::istringstream i(line);
-		uint64_t value;
-		if ((i >> value)) {
-			rxBytes = value;
-		} else {
-			LOG_WARN(logger, "Could not parse rx_bytes");
-			return;
-		}
-		myfile.close();
-	} else {
-		LOG_ERROR(logger, "Could not read file '/sys/class/net/" << tag->name << "/statistics/rx_bytes'");
+void LinuxSensorProviderEth::updateLinkStatus(SensorBean* sensor) {
+	AdapterInfo* tag = static_cast<AdapterInfo*>(sensor->mTag);
+
+	tag->monitor->update(tag->linkGeneration);
+	const NetlinkLinkMonitor::Link* link = tag->monitor->getLink(tag->name);
+	if (link == NULL) {
+		sensor->setData("Unknown");
+		return;
+	}
+	if (!link->up) {
+		sensor->setData("Down");
+		tag->speedValid = false;
 		return;
 	}
 
-	ifstream myfile2(("/sys/class/net/" + tag->name + "/statistics/tx_bytes").c_str());
-	if (myfile2.is_open()) {
-		getline(myfile2, line);
-		std::istringstream i(line);
-		uint64_t value;
-		if ((i >> value)) {
-			txBytes = value;
-		} else {
-			LOG_WARN(logger, "Could not parse tx_bytes");
+	// Speed is not part of netlink link messages, only read it again after carrier changes
+	if (!tag->speedValid || tag->carrierChanges != link->carrierChanges) {
+		string path = "/sys/class/net/" + tag->name + "/speed";
+		ProcFile file(path.c_str(), 32);
+		if (!file.read()) {
+			LOG_ERROR(logger, "Could not read file '" << path << "'");
+			sensor->setData("Unknown");
 			return;
 		}
-		myfile2.close();
-	} else {
-		LOG_ERROR(logger, "Could not read file '/sys/class/net/" << tag->name << "/statistics/tx_bytes'");
+		string line(file.data(), strcspn(file.data(), "\n"));
+		tag->speed = line + " MBit/s";
+		tag->speedValid = true;
+		tag->carrierChanges = link->carrierChanges;
+	}
+	sensor->setData(tag->speed);
+}
+
+void LinuxSensorProviderEth::updateUtilization(SensorBean* sensor) {
+	AdapterInfo* tag = static_cast<AdapterInfo*>(sensor->mTag);
+
+	tag->monitor->update(tag->statsGeneration);
+	const NetlinkLinkMonitor::Link* link = tag->monitor->getLink(tag->name);
+	if (link == NULL) {
 		return;
 	}
+	uint64_t rxBytes = link->rxBytes;
+	uint64_t txBytes = link->txBytes;
 
 	struct timespec now;
 	clock_gettime(CLOCK_MONOTONIC, &now);
@@ -228,5 +266,7 @@ void LinuxSensorProviderEth::updateUtilization(SensorBean* sensor) {
 }
 
 void LinuxSensorProviderEth::destroySensor(SensorBean* sensor) {
-	delete static_cast<AdapterInfo*>(sensor->mTag);
+	AdapterInfo* tag = static_cast<AdapterInfo*>(sensor->mTag);
+	tag->monitor->release();
+	delete tag;
 }
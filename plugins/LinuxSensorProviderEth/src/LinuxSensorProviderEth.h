@@ -28,13 +28,16 @@
 #include <object_model.h>
 #include <string>
 #include <map>
+#include <vector>
 #include <logger.h>
 #include <c_object_model.h>
 #include <SensorBean.h>
+#include <IConfig.h>
 
 struct PF_ObjectParams;
+class NetlinkLinkMonitor;
 
-class LinuxSensorProviderEth: public ISensorProvider {
+class LinuxSensorProviderEth: public IDynamicSensorProvider {
 public:
 	class AdapterInfo {
 		public:
@@ -43,6 +46,12 @@ public:
 		uint64_t lastCountRx;
 		uint64_t lastCountTx;
 		SensorBean* txSensor;
+		NetlinkLinkMonitor* monitor;
+		uint32_t linkGeneration;
+		uint32_t statsGeneration;
+		uint32_t carrierChanges;
+		bool speedValid;
+		string speed;
 	};
 
 	// static plugin interface
@@ -53,14 +62,29 @@ public:
 	// ISensorProvider methods
 	virtual std::map<std::string, ISensor*> getSensors(void);
 
+	// IDynamicSensorProvider methods
+	virtual bool pollSensorChanges(std::map<std::string, ISensor*>& added, std::vector<std::string>& removed);
+
 	static LoggerPtr logger;
+	static IConfig* config;
 private:
 	LinuxSensorProviderEth();
+	static std::vector<std::string> splitPatterns(const std::string& patterns);
+	bool matches(const std::string& name) const;
+	bool discover(std::map<std::string, ISensor*>& added, std::vector<std::string>& removed);
+	void addAdapter(const std::string& ifaceName, std::map<std::string, ISensor*>& sensors);
 	static void updateLinkStatus(SensorBean* sensor);
 	static void updateUtilization(SensorBean* sensor);
 	static void destroySensor(SensorBean* sensor);
 
 	std::map<std::string, ISensor*> mSensors;
+	std::map<std::string, AdapterInfo*> mAdapters; // Currently exposed interfaces, owned by their sensors
+	NetlinkLinkMonitor* mMonitor;
+	uint32_t mGeneration;
+	std::vector<std::string> mInclude;
+	std::vector<std::string> mExclude;
+	int mMaxInterfaces;
+	bool mCapLogged;
 };
 
 #endif
@@ -0,0 +1,274 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NetlinkLinkMonitor.h"
+#include "LinuxSensorProviderEth.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_link.h>
+#include <net/if.h>
+
+#ifndef IFF_LOWER_UP
+#define IFF_LOWER_UP	0x10000
+#endif
+
+// Enough for a batch of RTM_NEWLINK messages, the kernel splits dumps accordingly
+#define NETLINK_BUFFER_SIZE	32768
+
+NetlinkLinkMonitor::NetlinkLinkMonitor() :
+	mDumpSocket(-1), mEventSocket(-1), mSequence(0), mResync(true), mGeneration(0), mRefCount(0), mLinks(), mBuffer((char*)malloc(NETLINK_BUFFER_SIZE)) {
+	mDumpSocket = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (mDumpSocket < 0) {
+		LOG_ERROR(LinuxSensorProviderEth::logger, "Could not create netlink socket: " << strerror(errno));
+		return;
+	}
+	// A dump the kernel never finishes must not hang the sensor thread
+	struct timeval timeout = {1, 0};
+	setsockopt(mDumpSocket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	mEventSocket = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+	if (mEventSocket >= 0) {
+		struct sockaddr_nl addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.nl_family = AF_NETLINK;
+		addr.nl_groups = RTMGRP_LINK;
+		if (bind(mEventSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+			close(mEventSocket);
+			mEventSocket = -1;
+		}
+	}
+	if (mEventSocket < 0) {
+		// Still works, carrier state is then taken from every dump
+		LOG_WARN(LinuxSensorProviderEth::logger, "Could not subscribe to netlink link events: " << strerror(errno));
+	}
+}
+
+NetlinkLinkMonitor::~NetlinkLinkMonitor() {
+	if (mDumpSocket >= 0) {
+		close(mDumpSocket);
+	}
+	if (mEventSocket >= 0) {
+		close(mEventSocket);
+	}
+	free(mBuffer);
+}
+
+void NetlinkLinkMonitor::acquire(void) {
+	mRefCount++;
+}
+
+void NetlinkLinkMonitor::release(void) {
+	if (--mRefCount == 0) {
+		delete this;
+	}
+}
+
+bool NetlinkLinkMonitor::isOpen(void) const {
+	return mDumpSocket >= 0;
+}
+
+void NetlinkLinkMonitor::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		processEvents();
+		dump();
+		mGeneration++;
+	}
+	seenGeneration = mGeneration;
+}
+
+const NetlinkLinkMonitor::Link* NetlinkLinkMonitor::getLink(const string& name) const {
+	for (map<int, Link>::const_iterator iterator = mLinks.begin(); iterator != mLinks.end(); ++iterator) {
+		if (iterator->second.name == name) {
+			return &iterator->second;
+		}
+	}
+	return NULL;
+}
+
+const map<int, NetlinkLinkMonitor::Link>& NetlinkLinkMonitor::getLinks(void) const {
+	return mLinks;
+}
+
+void NetlinkLinkMonitor::processEvents(void) {
+	if (mEventSocket < 0) {
+		return;
+	}
+	while (true) {
+		ssize_t length = recv(mEventSocket, mBuffer, NETLINK_BUFFER_SIZE, 0);
+		if (length < 0) {
+			if (errno == ENOBUFS) {
+				// Events were lost, take carrier state from the next dump
+				mResync = true;
+				continue;
+			}
+			break; // EAGAIN, nothing pending
+		}
+		for (struct nlmsghdr* nh = (struct nlmsghdr*)mBuffer; NLMSG_OK(nh, (size_t)length); nh = NLMSG_NEXT(nh, length)) {
+			if (nh->nlmsg_type == RTM_NEWLINK) {
+				parseLink(nh, nh->nlmsg_len, true);
+			} else if (nh->nlmsg_type == RTM_DELLINK) {
+				struct ifinfomsg* ifi = (struct ifinfomsg*)NLMSG_DATA(nh);
+				mLinks.erase(ifi->ifi_index);
+			}
+		}
+	}
+}
+
+void NetlinkLinkMonitor::dump(void) {
+	if (mDumpSocket < 0) {
+		return;
+	}
+	struct {
+		struct nlmsghdr nh;
+		struct ifinfomsg ifi;
+	} request;
+	memset(&request, 0, sizeof(request));
+	request.nh.nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	request.nh.nlmsg_type = RTM_GETLINK;
+	request.nh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	request.nh.nlmsg_seq = ++mSequence;
+	request.ifi.ifi_family = AF_UNSPEC;
+
+	if (send(mDumpSocket, &request, request.nh.nlmsg_len, 0) < 0) {
+		LOG_ERROR(LinuxSensorProviderEth::logger, "Could not send RTM_GETLINK request: " << strerror(errno));
+		return;
+	}
+
+	bool complete = false;
+	bool done = false;
+	while (!done) {
+		ssize_t length = recv(mDumpSocket, mBuffer, NETLINK_BUFFER_SIZE, 0);
+		if (length < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			LOG_ERROR(LinuxSensorProviderEth::logger, "Could not receive RTM_GETLINK response: " << strerror(errno));
+			break;
+		}
+		for (struct nlmsghdr* nh = (struct nlmsghdr*)mBuffer; NLMSG_OK(nh, (size_t)length); nh = NLMSG_NEXT(nh, length)) {
+			if (nh->nlmsg_seq != mSequence) {
+				continue; // Left over from an aborted dump
+			}
+			if (nh->nlmsg_type == NLMSG_DONE) {
+				complete = true;
+				done = true;
+				break;
+			}
+			if (nh->nlmsg_type == NLMSG_ERROR) {
+				const struct nlmsgerr* error = (const struct nlmsgerr*)NLMSG_DATA(nh);
+				LOG_ERROR(LinuxSensorProviderEth::logger, "RTM_GETLINK request failed: " << strerror(-error->error));
+				done = true;
+				break;
+			}
+			if (nh->nlmsg_type == RTM_NEWLINK) {
+				parseLink(nh, nh->nlmsg_len, false);
+			}
+		}
+	}
+	if (!complete) {
+		return; // Keep the previous state, next tick dumps again
+	}
+	mResync = false;
+
+	// Interfaces that vanished without us seeing RTM_DELLINK
+	map<int, Link>::iterator iterator = mLinks.begin();
+	while (iterator != mLinks.end()) {
+		if (iterator->second.dumpSequence != mSequence) {
+			mLinks.erase(iterator++);
+		} else {
+			++iterator;
+		}
+	}
+}
+
+void NetlinkLinkMonitor::parseLink(const void* message, size_t length, bool fromEvent) {
+	const struct nlmsghdr* nh = (const struct nlmsghdr*)message;
+	const struct ifinfomsg* ifi = (const struct ifinfomsg*)NLMSG_DATA(nh);
+	int attributesLength = (int)length - NLMSG_LENGTH(sizeof(struct ifinfomsg));
+	if (attributesLength < 0) {
+		return;
+	}
+
+	map<int, Link>::iterator iterator = mLinks.find(ifi->ifi_index);
+	bool isNew = iterator == mLinks.end();
+	Link& link = mLinks[ifi->ifi_index];
+	if (isNew) {
+		link.up = false;
+		link.carrierChanges = 0;
+		link.rxBytes = 0;
+		link.txBytes = 0;
+		link.dumpSequence = mSequence;
+	}
+	if (!fromEvent) {
+		link.dumpSequence = mSequence;
+	}
+	link.flags = ifi->ifi_flags;
+
+	bool carrier = (ifi->ifi_flags & IFF_LOWER_UP) != 0;
+	bool has64BitStats = false;
+	for (const struct rtattr* attr = IFLA_RTA(ifi); RTA_OK(attr, attributesLength); attr = RTA_NEXT(attr, attributesLength)) {
+		switch (attr->rta_type) {
+			case IFLA_IFNAME:
+				link.name.assign((const char*)RTA_DATA(attr), strnlen((const char*)RTA_DATA(attr), RTA_PAYLOAD(attr)));
+				break;
+			case IFLA_CARRIER:
+				carrier = *(const uint8_t*)RTA_DATA(attr) != 0;
+				break;
+			case IFLA_STATS64:
+				if (RTA_PAYLOAD(attr) >= sizeof(struct rtnl_link_stats64)) {
+					struct rtnl_link_stats64 stats;
+					memcpy(&stats, RTA_DATA(attr), sizeof(stats)); // Attribute is only 4 byte aligned
+					link.rxBytes = stats.rx_bytes;
+					link.txBytes = stats.tx_bytes;
+					has64BitStats = true;
+				}
+				break;
+			case IFLA_STATS:
+				if (!has64BitStats && RTA_PAYLOAD(attr) >= sizeof(struct rtnl_link_stats)) {
+					const struct rtnl_link_stats* stats = (const struct rtnl_link_stats*)RTA_DATA(attr);
+					link.rxBytes = stats->rx_bytes;
+					link.txBytes = stats->tx_bytes;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	// Carrier of an interface that is administratively down reads as down, like sysfs
+	bool up = (ifi->ifi_flags & IFF_UP) && carrier;
+	if (isNew || fromEvent || mResync || mEventSocket < 0) {
+		if (up != link.up && !isNew) {
+			link.carrierChanges++;
+		}
+		link.up = up;
+	}
+}
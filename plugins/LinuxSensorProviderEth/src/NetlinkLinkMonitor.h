@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NETLINKLINKMONITOR_H_
+#define NETLINKLINKMONITOR_H_
+
+#include <stdint.h>
+#include <string>
+#include <map>
+
+using namespace std;
+
+// Link state and 64 bit byte counters of all interfaces, fetched with one
+// RTM_GETLINK dump per tick over a persistent netlink socket. Carrier
+// changes are taken from RTMGRP_LINK multicast events. Shared by all sensors
+// of the provider, the first sensor updated in a tick triggers the dump.
+class NetlinkLinkMonitor {
+public:
+	struct Link {
+		string name;
+		uint32_t flags; // IFF_*
+		bool up;
+		uint32_t carrierChanges; // Incremented on every up/down transition
+		uint64_t rxBytes;
+		uint64_t txBytes;
+		uint32_t dumpSequence; // Request sequence of the last dump that listed the link
+	};
+
+	NetlinkLinkMonitor();
+
+	void acquire(void);
+	void release(void);
+
+	bool isOpen(void) const;
+	void update(uint32_t& seenGeneration);
+	const Link* getLink(const string& name) const;
+	const map<int, Link>& getLinks(void) const;
+
+private:
+	//lint -e(1704)
+	NetlinkLinkMonitor(const NetlinkLinkMonitor& cSource);
+	NetlinkLinkMonitor& operator=(const NetlinkLinkMonitor& cSource);
+	~NetlinkLinkMonitor();
+
+	void dump(void);
+	void processEvents(void);
+	void parseLink(const void* message, size_t length, bool fromEvent);
+
+	int mDumpSocket;
+	int mEventSocket;
+	uint32_t mSequence;
+	bool mResync;
+	uint32_t mGeneration;
+	int mRefCount;
+	map<int, Link> mLinks; // By interface index
+	char* mBuffer;
+};
+
+#endif /* NETLINKLINKMONITOR_H_ */
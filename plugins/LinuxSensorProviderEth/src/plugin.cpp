@@ -52,6 +52,7 @@ extern "C" PLUGIN_API PF_ExitFunc PF_initPlugin(const PF_PlatformServices * para
 		return NULL;
 	}
 	LinuxSensorProviderEth::logger = *((LoggerPtr*)params->invokeService((const uint8_t *)"getLogger", (void*)"LinuxSensorProviderEth"));
+	LinuxSensorProviderEth::config = static_cast<IConfig*>(params->invokeService((const uint8_t *)"getConfig", NULL));
 
 	return ExitFunc;
 }
@@ -0,0 +1,353 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LinuxSensorProviderHwmon.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <sstream>
+#include <dirent.h>
+#include <daemon_msgs.h>
+
+using namespace std;
+
+LoggerPtr LinuxSensorProviderHwmon::logger;
+IConfig* LinuxSensorProviderHwmon::config;
+
+void * LinuxSensorProviderHwmon::create(PF_ObjectParams *) {
+	return new LinuxSensorProviderHwmon();
+}
+
+int32_t LinuxSensorProviderHwmon::destroy(void * p) {
+	if (!p)
+		return -1;
+	delete static_cast<LinuxSensorProviderHwmon*>(p);
+	return 0;
+}
+
+LinuxSensorProviderHwmon::LinuxSensorProviderHwmon() :
+	mSensors() {
+	mRoot = config->GetString("Plugins", "hwmonSysfsRoot", "/sys");
+	mMaxSensors = config->GetInt("Plugins", "hwmonMaxSensors", 64);
+
+	scanHwmon();
+	scanThermal();
+	scanIio();
+}
+
+LinuxSensorProviderHwmon::~LinuxSensorProviderHwmon() {
+}
+
+map<string, ISensor*> LinuxSensorProviderHwmon::getSensors(void) {
+	return mSensors;
+}
+
+void LinuxSensorProviderHwmon::scanHwmon(void) {
+	// Unit, conversion from sysfs units and threshold attributes per hwmon sensor type
+	static const struct {
+		const char* prefix;
+		ISensorUnit unit;
+		double scale;
+		const char* lowerCritical;
+		const char* lowerWarning;
+		const char* upperWarning;
+		const char* upperCritical;
+	} types[] = {
+		{ "temp", UNIT_TEMPERATURE, 0.001, "_lcrit", "_min", "_max", "_crit" },	// m°C
+		{ "in", UNIT_VOLTAGE, 0.001, "_lcrit", "_min", "_max", "_crit" },		// mV
+		{ "curr", UNIT_CURRENT, 0.001, "_lcrit", "_min", "_max", "_crit" },		// mA
+		{ "power", UNIT_POWER, 0.000001, NULL, NULL, "_max", "_crit" },			// µW
+		{ "fan", UNIT_ROTATIONAL_SPEED, 1.0, NULL, "_min", "_max", NULL }		// RPM
+	};
+
+	string classPath = mRoot + "/class/hwmon";
+	vector<string> chips = listDirectory(classPath);
+	for (vector<string>::iterator chip = chips.begin(); chip != chips.end(); ++chip) {
+		string chipPath = classPath + "/" + *chip;
+		// Older drivers keep their attributes in the device directory
+		vector<string> attributes = listDirectory(chipPath);
+		if (find(attributes.begin(), attributes.end(), "name") == attributes.end() || attributes.size() <= 3) {
+			vector<string> deviceAttributes = listDirectory(chipPath + "/device");
+			if (!deviceAttributes.empty()) {
+				chipPath += "/device";
+				attributes = deviceAttributes;
+			}
+		}
+		string chipName = readString(chipPath + "/name");
+		if (chipName.empty()) {
+			chipName = *chip;
+		}
+
+		for (vector<string>::iterator attribute = attributes.begin(); attribute != attributes.end(); ++attribute) {
+			size_t suffix = attribute->rfind("_input");
+			if (suffix == string::npos || suffix + 6 != attribute->length()) {
+				continue;
+			}
+			string base = attribute->substr(0, suffix); // e.g. temp1
+			for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+				size_t prefixLength = strlen(types[i].prefix);
+				if (base.compare(0, prefixLength, types[i].prefix) != 0 || base.length() == prefixLength || base.find_first_not_of("0123456789", prefixLength) != string::npos) {
+					continue;
+				}
+				string label = readString(chipPath + "/" + base + "_label");
+				Thresholds thresholds = readThresholds(chipPath + "/" + base, types[i].scale, types[i].lowerCritical, types[i].lowerWarning, types[i].upperWarning, types[i].upperCritical);
+				addSensor(chipName + " " + (label.empty() ? base : label), chipPath + "/" + *attribute, types[i].unit, types[i].scale, 0.0, thresholds);
+				break;
+			}
+		}
+	}
+}
+
+void LinuxSensorProviderHwmon::scanThermal(void) {
+	string classPath = mRoot + "/class/thermal";
+	vector<string> zones = listDirectory(classPath);
+	for (vector<string>::iterator zone = zones.begin(); zone != zones.end(); ++zone) {
+		if (zone->compare(0, 12, "thermal_zone") != 0) {
+			continue;
+		}
+		string zonePath = classPath + "/" + *zone;
+		string type = readString(zonePath + "/type");
+
+		// Trip points: critical is the upper critical, the lowest hot/passive one the upper warning threshold
+		Thresholds thresholds = { false, false, 0.0, 0.0, 0.0, 0.0 };
+		bool haveWarning = false;
+		bool haveCritical = false;
+		for (int trip = 0; ; ++trip) {
+			std::ostringstream tripPath;
+			tripPath << zonePath << "/trip_point_" << trip;
+			string tripType = readString(tripPath.str() + "_type");
+			double temp;
+			if (tripType.empty() || !readNumber(tripPath.str() + "_temp", temp)) {
+				break;
+			}
+			temp *= 0.001;
+			if (tripType == "critical") {
+				thresholds.upperCritical = temp;
+				haveCritical = true;
+			} else if ((tripType == "hot" || tripType == "passive") && (!haveWarning || temp < thresholds.upperWarning)) {
+				thresholds.upperWarning = temp;
+				haveWarning = true;
+			}
+		}
+		if (haveWarning || haveCritical) {
+			thresholds.useUpper = true;
+			if (!haveWarning) {
+				thresholds.upperWarning = thresholds.upperCritical;
+			} else if (!haveCritical) {
+				thresholds.upperCritical = thresholds.upperWarning;
+			}
+		}
+		addSensor((type.empty() ? *zone : type), zonePath + "/temp", UNIT_TEMPERATURE, 0.001, 0.0, thresholds);
+	}
+}
+
+void LinuxSensorProviderHwmon::scanIio(void) {
+	// Processed values are in milli units, raw values give them after applying offset and scale
+	static const struct {
+		const char* type;
+		ISensorUnit unit;
+	} types[] = {
+		{ "temp", UNIT_TEMPERATURE },
+		{ "voltage", UNIT_VOLTAGE },
+		{ "current", UNIT_CURRENT },
+		{ "power", UNIT_POWER }
+	};
+	static const Thresholds noThresholds = { false, false, 0.0, 0.0, 0.0, 0.0 };
+
+	string busPath = mRoot + "/bus/iio/devices";
+	vector<string> devices = listDirectory(busPath);
+	for (vector<string>::iterator device = devices.begin(); device != devices.end(); ++device) {
+		string devicePath = busPath + "/" + *device;
+		string deviceName = readString(devicePath + "/name");
+		if (deviceName.empty()) {
+			deviceName = *device;
+		}
+		vector<string> attributes = listDirectory(devicePath);
+		for (vector<string>::iterator attribute = attributes.begin(); attribute != attributes.end(); ++attribute) {
+			if (attribute->compare(0, 3, "in_") != 0) {
+				continue;
+			}
+			bool processed = attribute->length() > 9 && attribute->compare(attribute->length() - 6, 6, "_input") == 0;
+			bool raw = attribute->length() > 7 && attribute->compare(attribute->length() - 4, 4, "_raw") == 0;
+			if (!processed && !raw) {
+				continue;
+			}
+			string channel = attribute->substr(3, attribute->length() - 3 - (processed ? 6 : 4)); // e.g. voltage0
+			for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); ++i) {
+				size_t typeLength = strlen(types[i].type);
+				if (channel.compare(0, typeLength, types[i].type) != 0) {
+					continue;
+				}
+				double scale = 1.0;
+				double offset = 0.0;
+				if (raw) {
+					if (find(attributes.begin(), attributes.end(), "in_" + channel + "_input") != attributes.end()) {
+						break; // Processed value of the same channel preferred
+					}
+					// Channel specific scale and offset, else shared per type
+					if (!readNumber(devicePath + "/in_" + channel + "_scale", scale) && !readNumber(devicePath + "/in_" + string(types[i].type) + "_scale", scale)) {
+						break; // Unitless without scale
+					}
+					if (!readNumber(devicePath + "/in_" + channel + "_offset", offset)) {
+						readNumber(devicePath + "/in_" + string(types[i].type) + "_offset", offset);
+					}
+				}
+				addSensor(deviceName + " " + channel, devicePath + "/" + *attribute, types[i].unit, scale * 0.001, offset, noThresholds);
+				break;
+			}
+		}
+	}
+}
+
+void LinuxSensorProviderHwmon::addSensor(string name, const string& path, ISensorUnit unit, double scale, double offset, const Thresholds& thresholds) {
+	if (mSensors.size() >= mMaxSensors) {
+		LOG_WARN(logger, "Maximum of " << mMaxSensors << " sensors reached, ignoring " << path << " (Plugins->hwmonMaxSensors)");
+		return;
+	}
+	if (name.length() > SENSOR_NAME_LENGTH) {
+		name.resize(SENSOR_NAME_LENGTH);
+	}
+	// Several chips of the same type
+	for (int i = 2; mSensors.find(name) != mSensors.end(); ++i) {
+		std::ostringstream suffix;
+		suffix << " " << i;
+		name = name.substr(0, min(name.length(), SENSOR_NAME_LENGTH - suffix.str().length())) + suffix.str();
+	}
+
+	SysfsValue* tag = new SysfsValue();
+	tag->file = new ProcFile(path.c_str(), 32);
+	tag->scale = scale;
+	tag->offset = offset;
+	if (!tag->file->isOpen()) {
+		LOG_WARN(logger, "Could not open " << path);
+		delete tag->file;
+		delete tag;
+		return;
+	}
+	LOG_INFO(logger, "Found sensor '" << name << "' at " << path);
+
+	SensorBean* sensor = new SensorBean(name, TYPE_FLOAT, 8, 1, unit, thresholds.useLower, thresholds.useUpper, thresholds.lowerCritical, thresholds.lowerWarning, thresholds.upperWarning, thresholds.upperCritical, "", RENDERING_TEXTUAL);
+	sensor->setData(0.0);
+	sensor->setUpdateCallback(&LinuxSensorProviderHwmon::updateSensor);
+	sensor->setDestroyCallback(&LinuxSensorProviderHwmon::destroySensor);
+	sensor->mTag = tag;
+	mSensors[name] = sensor;
+}
+
+void LinuxSensorProviderHwmon::updateSensor(SensorBean* sensor) {
+	SysfsValue* tag = static_cast<SysfsValue*>(sensor->mTag);
+	if (!tag->file->read()) {
+		// e.g. EIO while the device is powered down, keep last value
+		return;
+	}
+	const char* p = tag->file->data();
+	int64_t value;
+	if (procScanInt64(p, tag->file->end(), value) && (p == tag->file->end() || *p == '\n')) {
+		sensor->setData(((double)value + tag->offset) * tag->scale);
+	} else {
+		char* end;
+		double number = strtod(tag->file->data(), &end);
+		if (end != tag->file->data()) {
+			sensor->setData((number + tag->offset) * tag->scale);
+		}
+	}
+}
+
+void LinuxSensorProviderHwmon::destroySensor(SensorBean* sensor) {
+	SysfsValue* tag = static_cast<SysfsValue*>(sensor->mTag);
+	delete tag->file;
+	delete tag;
+}
+
+vector<string> LinuxSensorProviderHwmon::listDirectory(const string& path) {
+	vector<string> entries;
+	DIR* dir = opendir(path.c_str());
+	if (dir == NULL) {
+		return entries;
+	}
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (entry->d_name[0] != '.') {
+			entries.push_back(entry->d_name);
+		}
+	}
+	closedir(dir);
+	// Stable sensor order independent of directory order
+	sort(entries.begin(), entries.end());
+	return entries;
+}
+
+bool LinuxSensorProviderHwmon::readNumber(const string& path, double& value) {
+	ProcFile file(path.c_str(), 64);
+	if (!file.read()) {
+		return false;
+	}
+	char* end;
+	double number = strtod(file.data(), &end);
+	if (end == file.data()) {
+		return false;
+	}
+	value = number;
+	return true;
+}
+
+string LinuxSensorProviderHwmon::readString(const string& path) {
+	ProcFile file(path.c_str(), 64);
+	if (!file.read()) {
+		return "";
+	}
+	return string(file.data(), strcspn(file.data(), "\n"));
+}
+
+LinuxSensorProviderHwmon::Thresholds LinuxSensorProviderHwmon::readThresholds(const string& base, double scale, const char* lowerCritical, const char* lowerWarning, const char* upperWarning, const char* upperCritical) {
+	Thresholds thresholds = { false, false, 0.0, 0.0, 0.0, 0.0 };
+	bool haveLowerCritical = lowerCritical != NULL && readNumber(base + lowerCritical, thresholds.lowerCritical);
+	bool haveLowerWarning = lowerWarning != NULL && readNumber(base + lowerWarning, thresholds.lowerWarning);
+	bool haveUpperWarning = upperWarning != NULL && readNumber(base + upperWarning, thresholds.upperWarning);
+	bool haveUpperCritical = upperCritical != NULL && readNumber(base + upperCritical, thresholds.upperCritical);
+
+	// Management expects both levels, use the one that exists for both
+	if (haveLowerCritical || haveLowerWarning) {
+		thresholds.useLower = true;
+		if (!haveLowerCritical) {
+			thresholds.lowerCritical = thresholds.lowerWarning;
+		} else if (!haveLowerWarning) {
+			thresholds.lowerWarning = thresholds.lowerCritical;
+		}
+		thresholds.lowerCritical *= scale;
+		thresholds.lowerWarning *= scale;
+	}
+	if (haveUpperWarning || haveUpperCritical) {
+		thresholds.useUpper = true;
+		if (!haveUpperCritical) {
+			thresholds.upperCritical = thresholds.upperWarning;
+		} else if (!haveUpperWarning) {
+			thresholds.upperWarning = thresholds.upperCritical;
+		}
+		thresholds.upperWarning *= scale;
+		thresholds.upperCritical *= scale;
+	}
+	return thresholds;
+}
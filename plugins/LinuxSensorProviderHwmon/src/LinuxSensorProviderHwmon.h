@@ -0,0 +1,89 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LINUXSENSORPROVIDERHWMON_H
+#define LINUXSENSORPROVIDERHWMON_H
+
+#include <object_model.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <logger.h>
+#include <c_object_model.h>
+#include <SensorBean.h>
+#include <IConfig.h>
+#include <ProcFile.h>
+
+struct PF_ObjectParams;
+
+// Discovers hwmon, thermal zone and IIO sensors below a configurable sysfs
+// root at startup. Values are read through persistent fds.
+class LinuxSensorProviderHwmon: public ISensorProvider {
+public:
+	// static plugin interface
+	static void * create(PF_ObjectParams *);
+	static int32_t destroy(void *);
+	~LinuxSensorProviderHwmon();
+
+	// ISensorProvider methods
+	virtual std::map<std::string, ISensor*> getSensors(void);
+
+	static LoggerPtr logger;
+	static IConfig* config;
+private:
+	struct SysfsValue {
+		ProcFile* file;
+		double scale;
+		double offset; // Added before scaling
+	};
+
+	struct Thresholds {
+		bool useLower;
+		bool useUpper;
+		double lowerCritical;
+		double lowerWarning;
+		double upperWarning;
+		double upperCritical;
+	};
+
+	LinuxSensorProviderHwmon();
+	void scanHwmon(void);
+	void scanThermal(void);
+	void scanIio(void);
+	void addSensor(std::string name, const std::string& path, ISensorUnit unit, double scale, double offset, const Thresholds& thresholds);
+
+	static void updateSensor(SensorBean* sensor);
+	static void destroySensor(SensorBean* sensor);
+
+	static std::vector<std::string> listDirectory(const std::string& path);
+	static bool readNumber(const std::string& path, double& value);
+	static std::string readString(const std::string& path);
+	static Thresholds readThresholds(const std::string& base, double scale, const char* lowerCritical, const char* lowerWarning, const char* upperWarning, const char* upperCritical);
+
+	std::map<std::string, ISensor*> mSensors;
+	std::string mRoot;
+	size_t mMaxSensors;
+};
+
+#endif
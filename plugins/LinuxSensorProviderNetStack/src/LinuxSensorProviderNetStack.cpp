@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LinuxSensorProviderNetStack.h"
+
+using namespace std;
+
+LoggerPtr LinuxSensorProviderNetStack::logger;
+IConfig* LinuxSensorProviderNetStack::config;
+
+void * LinuxSensorProviderNetStack::create(PF_ObjectParams *) {
+	return new LinuxSensorProviderNetStack();
+}
+
+int32_t LinuxSensorProviderNetStack::destroy(void * p) {
+	if (!p)
+		return -1;
+	delete static_cast<LinuxSensorProviderNetStack*>(p);
+	return 0;
+}
+
+LinuxSensorProviderNetStack::LinuxSensorProviderNetStack() :
+	mSensors() {
+	// Counters are published as rate per second, socket counts as they are
+	static const struct {
+		NetStack::Table table;
+		const char* prefix;
+		const char* field;
+		const char* name;
+		bool rate;
+	} sensors[] = {
+		{ NetStack::SNMP, "Tcp:", "RetransSegs", "TCP retransmits", true },
+		{ NetStack::NETSTAT, "TcpExt:", "TCPTimeouts", "TCP timeouts", true },
+		{ NetStack::NETSTAT, "TcpExt:", "ListenOverflows", "TCP listen overflows", true },
+		{ NetStack::NETSTAT, "TcpExt:", "ListenDrops", "TCP listen drops", true },
+		{ NetStack::SNMP, "Udp:", "InErrors", "UDP receive errors", true },
+		{ NetStack::SNMP, "Udp:", "RcvbufErrors", "UDP buffer errors", true },
+		{ NetStack::SOCKSTAT, "sockets:", "used", "Sockets used", false },
+		{ NetStack::SOCKSTAT, "TCP:", "inuse", "TCP sockets", false },
+		{ NetStack::SOCKSTAT, "TCP:", "tw", "TCP time wait", false },
+		{ NetStack::SOCKSTAT, "TCP:", "orphan", "TCP orphans", false },
+		{ NetStack::SOCKSTAT, "UDP:", "inuse", "UDP sockets", false }
+	};
+	const size_t count = sizeof(sensors) / sizeof(sensors[0]);
+
+	NetStack* stack = new NetStack();
+	stack->acquire();
+	size_t fields[count];
+	for (size_t i = 0; i < count; ++i) {
+		fields[i] = stack->addField(sensors[i].table, sensors[i].prefix, sensors[i].field);
+	}
+	for (size_t i = 0; i < count; ++i) {
+		if (!stack->resolve(sensors[i].table, fields[i])) {
+			LOG_WARN(logger, "Field " << sensors[i].prefix << " " << sensors[i].field << " not found, no sensor '" << sensors[i].name << "'");
+			continue;
+		}
+		NetStackSensor* tag = new NetStackSensor();
+		tag->stack = stack;
+		tag->table = sensors[i].table;
+		tag->field = fields[i];
+		tag->rate = sensors[i].rate;
+		tag->generation = 0;
+		stack->acquire();
+
+		SensorBean* sensor;
+		if (sensors[i].rate) {
+			sensor = new SensorBean(sensors[i].name, TYPE_FLOAT, 8, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+			sensor->setData(0.0);
+		} else {
+			sensor = new SensorBean(sensors[i].name, TYPE_U32, 4, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+			sensor->setData((uint32_t)0);
+		}
+		sensor->mTag = tag;
+		sensor->setUpdateCallback(&LinuxSensorProviderNetStack::updateSensor);
+		sensor->setDestroyCallback(&LinuxSensorProviderNetStack::destroySensor);
+		mSensors[sensors[i].name] = sensor;
+	}
+	stack->release();
+}
+
+LinuxSensorProviderNetStack::~LinuxSensorProviderNetStack() {
+}
+
+map<string, ISensor*> LinuxSensorProviderNetStack::getSensors(void) {
+	return mSensors;
+}
+
+void LinuxSensorProviderNetStack::updateSensor(SensorBean* sensor) {
+	NetStackSensor* tag = static_cast<NetStackSensor*>(sensor->mTag);
+	bool complete = tag->stack->update(tag->generation);
+	if (!tag->rate) {
+		sensor->setData((uint32_t)tag->stack->getValue(tag->table, tag->field));
+	} else if (complete) {
+		sensor->setData(tag->stack->getRate(tag->table, tag->field));
+	}
+}
+
+void LinuxSensorProviderNetStack::destroySensor(SensorBean* sensor) {
+	NetStackSensor* tag = static_cast<NetStackSensor*>(sensor->mTag);
+	tag->stack->release();
+	delete tag;
+}
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "NetStack.h"
+
+NetStack::NetStack() :
+	mCurrent(0), mGeneration(0), mRefCount(0) {
+	mTables[SNMP] = new ProcTable("/proc/net/snmp", ProcTable::HEADER_VALUES);
+	mTables[NETSTAT] = new ProcTable("/proc/net/netstat", ProcTable::HEADER_VALUES);
+	mTables[SOCKSTAT] = new ProcTable("/proc/net/sockstat", ProcTable::KEY_VALUES);
+	for (int i = 0; i < 2; ++i) {
+		for (int table = 0; table < TABLE_COUNT; ++table) {
+			mValid[i][table] = false;
+		}
+		mTimestamps[i].tv_sec = 0;
+		mTimestamps[i].tv_nsec = 0;
+	}
+	for (int table = 0; table < TABLE_COUNT; ++table) {
+		mResolved[table] = false;
+	}
+}
+
+NetStack::~NetStack() {
+	for (int table = 0; table < TABLE_COUNT; ++table) {
+		delete mTables[table];
+	}
+}
+
+size_t NetStack::addField(Table table, const std::string& prefix, const std::string& name) {
+	size_t field = mTables[table]->addField(prefix, name);
+	mValues[0][table].resize(field + 1, 0);
+	mValues[1][table].resize(field + 1, 0);
+	mResolved[table] = false;
+	return field;
+}
+
+bool NetStack::resolve(Table table, size_t field) {
+	// Column positions are looked up once per table
+	if (!mResolved[table]) {
+		mTables[table]->resolve();
+		mResolved[table] = true;
+	}
+	return mTables[table]->isResolved(field);
+}
+
+void NetStack::acquire(void) {
+	mRefCount++;
+}
+
+void NetStack::release(void) {
+	if (--mRefCount == 0) {
+		delete this;
+	}
+}
+
+bool NetStack::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		read();
+	}
+	seenGeneration = mGeneration;
+	return mGeneration >= 2;
+}
+
+void NetStack::read(void) {
+	mCurrent ^= 1;
+	mGeneration++;
+	clock_gettime(CLOCK_MONOTONIC, &mTimestamps[mCurrent]);
+	for (int table = 0; table < TABLE_COUNT; ++table) {
+		mValid[mCurrent][table] = !mValues[mCurrent][table].empty() && mTables[table]->read(&mValues[mCurrent][table][0]);
+	}
+}
+
+int64_t NetStack::getValue(Table table, size_t field) const {
+	return mValid[mCurrent][table] ? mValues[mCurrent][table][field] : 0;
+}
+
+double NetStack::getRate(Table table, size_t field) const {
+	if (!mValid[mCurrent][table] || !mValid[mCurrent ^ 1][table]) {
+		return 0.0;
+	}
+	const struct timespec& now = mTimestamps[mCurrent];
+	const struct timespec& before = mTimestamps[mCurrent ^ 1];
+	double elapsed = (double)(now.tv_sec - before.tv_sec) + (double)(now.tv_nsec - before.tv_nsec) / 1e9;
+	int64_t delta = mValues[mCurrent][table][field] - mValues[mCurrent ^ 1][table][field];
+	if (elapsed <= 0.0 || delta < 0) {
+		return 0.0;
+	}
+	return (double)delta / elapsed;
+}
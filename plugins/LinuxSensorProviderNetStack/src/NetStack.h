@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef NETSTACK_H_
+#define NETSTACK_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+#include "ProcTable.h"
+
+// /proc/net/snmp, netstat and sockstat shared by all network stack sensors,
+// read once per tick like ProcStat
+class NetStack {
+public:
+	enum Table { SNMP, NETSTAT, SOCKSTAT, TABLE_COUNT };
+
+	NetStack();
+
+	size_t addField(Table table, const std::string& prefix, const std::string& name);
+	// Returns false if a field could not be found
+	bool resolve(Table table, size_t field);
+
+	void acquire(void);
+	void release(void);
+
+	// Returns false until two snapshots are available
+	bool update(uint32_t& seenGeneration);
+
+	int64_t getValue(Table table, size_t field) const;
+	// Change per second since the last snapshot
+	double getRate(Table table, size_t field) const;
+
+private:
+	//lint -e(1704)
+	NetStack(const NetStack& cSource);
+	NetStack& operator=(const NetStack& cSource);
+	~NetStack();
+
+	void read(void);
+
+	ProcTable* mTables[TABLE_COUNT];
+	bool mResolved[TABLE_COUNT];
+	std::vector<int64_t> mValues[2][TABLE_COUNT];
+	bool mValid[2][TABLE_COUNT];
+	struct timespec mTimestamps[2];
+	int mCurrent;
+	uint32_t mGeneration;
+	int mRefCount;
+};
+
+#endif /* NETSTACK_H_ */
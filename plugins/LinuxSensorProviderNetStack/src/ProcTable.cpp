@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ProcTable.h"
+
+#include <algorithm>
+
+ProcTable::ProcTable(const char* path, Layout layout) :
+	mFile(path, 16384), mLayout(layout), mFields(), mPositions() {
+}
+
+size_t ProcTable::addField(const std::string& prefix, const std::string& name) {
+	Field field;
+	field.prefix = prefix;
+	field.name = name;
+	field.line = -1;
+	field.token = 0;
+	mFields.push_back(field);
+	return mFields.size() - 1;
+}
+
+bool ProcTable::resolve(void) {
+	if (!mFile.read()) {
+		return false;
+	}
+	std::vector<std::vector<std::string> > lines;
+	const char* p = mFile.data();
+	const char* end = mFile.end();
+	while (p < end) {
+		lines.push_back(splitLine(p, end));
+	}
+
+	mPositions.clear();
+	for (size_t i = 0; i < mFields.size(); ++i) {
+		Field& field = mFields[i];
+		field.line = -1;
+		for (size_t line = 0; line < lines.size() && field.line < 0; ++line) {
+			const std::vector<std::string>& tokens = lines[line];
+			if (tokens.empty() || tokens[0] != field.prefix) {
+				continue;
+			}
+			std::vector<std::string>::const_iterator name = std::find(tokens.begin() + 1, tokens.end(), field.name);
+			if (name == tokens.end()) {
+				continue;
+			}
+			if (mLayout == HEADER_VALUES) {
+				// Value is in the same column of the next line
+				field.line = line + 1;
+				field.token = name - tokens.begin();
+			} else {
+				field.line = line;
+				field.token = name - tokens.begin() + 1;
+			}
+		}
+		if (field.line >= 0) {
+			Position position;
+			position.line = field.line;
+			position.token = field.token;
+			position.field = i;
+			mPositions.push_back(position);
+		}
+	}
+	std::sort(mPositions.begin(), mPositions.end());
+	return true;
+}
+
+bool ProcTable::isResolved(size_t field) const {
+	return field < mFields.size() && mFields[field].line >= 0;
+}
+
+size_t ProcTable::getFieldCount(void) const {
+	return mFields.size();
+}
+
+bool ProcTable::read(int64_t* values) {
+	if (!mFile.read()) {
+		return false;
+	}
+	const char* p = mFile.data();
+	const char* end = mFile.end();
+	long line = 0;
+	size_t token = 0;
+	for (std::vector<Position>::iterator position = mPositions.begin(); position != mPositions.end(); ++position) {
+		while (line < position->line && p < end) {
+			procNextLine(p, end);
+			line++;
+			token = 0;
+		}
+		if (p >= end) {
+			return false;
+		}
+		// Skip tokens before the wanted one, the values are numbers in both layouts
+		while (token < position->token) {
+			procSkipBlanks(p, end);
+			while (p < end && *p != ' ' && *p != '\t' && *p != '\n') {
+				++p;
+			}
+			token++;
+		}
+		if (!procScanInt64(p, end, values[position->field])) {
+			return false;
+		}
+		token++;
+	}
+	return true;
+}
+
+std::vector<std::string> ProcTable::splitLine(const char*& p, const char* end) {
+	std::vector<std::string> tokens;
+	while (p < end && *p != '\n') {
+		procSkipBlanks(p, end);
+		const char* begin = p;
+		while (p < end && *p != ' ' && *p != '\t' && *p != '\n') {
+			++p;
+		}
+		if (p > begin) {
+			tokens.push_back(std::string(begin, p - begin));
+		}
+	}
+	if (p < end) {
+		++p;
+	}
+	return tokens;
+}
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROCTABLE_H_
+#define PROCTABLE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ProcFile.h>
+
+// Selected values of a /proc/net statistics file. Field positions (line and
+// token) are looked up by name once in resolve(), read() then only skips to
+// those positions.
+//
+// HEADER_VALUES: "Tcp: RtoAlgorithm ... RetransSegs ..." followed by a line
+//                "Tcp: 1 ... 42 ..." (/proc/net/snmp, /proc/net/netstat)
+// KEY_VALUES:    "TCP: inuse 5 orphan 0 tw 2 ..." (/proc/net/sockstat)
+class ProcTable {
+public:
+	enum Layout { HEADER_VALUES, KEY_VALUES };
+
+	ProcTable(const char* path, Layout layout);
+
+	// Returns the index of the field in the values passed to read()
+	size_t addField(const std::string& prefix, const std::string& name);
+	// Returns false if the file could not be read, unknown fields are logged by the caller
+	bool resolve(void);
+	bool isResolved(size_t field) const;
+	size_t getFieldCount(void) const;
+
+	bool read(int64_t* values);
+
+private:
+	struct Field {
+		std::string prefix;
+		std::string name;
+		long line; // -1 while not resolved
+		size_t token;
+	};
+	// Fields sorted by line and token
+	struct Position {
+		long line;
+		size_t token;
+		size_t field;
+		bool operator<(const Position& other) const {
+			return line < other.line || (line == other.line && token < other.token);
+		}
+	};
+
+	static std::vector<std::string> splitLine(const char*& p, const char* end);
+
+	ProcFile mFile;
+	Layout mLayout;
+	std::vector<Field> mFields;
+	std::vector<Position> mPositions;
+};
+
+#endif /* PROCTABLE_H_ */
@@ -0,0 +1,133 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LinuxSensorProviderPerf.h"
+#include "PerfCounters.h"
+
+#include <cstring>
+#include <errno.h>
+
+using namespace std;
+
+LoggerPtr LinuxSensorProviderPerf::logger;
+IConfig* LinuxSensorProviderPerf::config;
+
+void * LinuxSensorProviderPerf::create(PF_ObjectParams *) {
+	return new LinuxSensorProviderPerf();
+}
+
+int32_t LinuxSensorProviderPerf::destroy(void * p) {
+	if (!p)
+		return -1;
+	delete static_cast<LinuxSensorProviderPerf*>(p);
+	return 0;
+}
+
+LinuxSensorProviderPerf::LinuxSensorProviderPerf() :
+	mSensors() {
+	PerfCounters* counters = new PerfCounters();
+	counters->acquire();
+	if (!counters->open()) {
+		// System wide counters need CAP_PERFMON or kernel.perf_event_paranoid <= 0
+		LOG_ERROR(logger, "Could not open perf_event counters: " << strerror(errno));
+		counters->release();
+		return;
+	}
+	if (counters->hasCounter(PerfCounters::CYCLES) && counters->hasCounter(PerfCounters::INSTRUCTIONS)) {
+		addSensor(counters, "perf IPC", UNIT_DIMENSIONLESS, PERF_IPC);
+	}
+	if (counters->hasCounter(PerfCounters::CACHE_REFERENCES) && counters->hasCounter(PerfCounters::CACHE_MISSES)) {
+		addSensor(counters, "perf cache misses", UNIT_PERCENT, PERF_CACHE_MISSES);
+	}
+	if (!counters->hasCounter(PerfCounters::CYCLES)) {
+		LOG_INFO(logger, "No hardware counters available, using software events only");
+	}
+	if (counters->hasCounter(PerfCounters::CONTEXT_SWITCHES)) {
+		addSensor(counters, "perf context switches", UNIT_DIMENSIONLESS, PERF_CONTEXT_SWITCHES);
+	}
+	if (counters->hasCounter(PerfCounters::PAGE_FAULTS)) {
+		addSensor(counters, "perf page faults", UNIT_DIMENSIONLESS, PERF_PAGE_FAULTS);
+	}
+	counters->release();
+}
+
+LinuxSensorProviderPerf::~LinuxSensorProviderPerf() {
+}
+
+map<string, ISensor*> LinuxSensorProviderPerf::getSensors(void) {
+	return mSensors;
+}
+
+void LinuxSensorProviderPerf::addSensor(PerfCounters* counters, const string& name, ISensorUnit unit, PerfKind kind) {
+	PerfSensor* tag = new PerfSensor();
+	tag->counters = counters;
+	tag->kind = kind;
+	tag->generation = 0;
+	counters->acquire();
+
+	SensorBean* sensor = new SensorBean(name, TYPE_FLOAT, 8, 1, unit, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData(0.0);
+	sensor->mTag = tag;
+	sensor->setUpdateCallback(&LinuxSensorProviderPerf::updateSensor);
+	sensor->setDestroyCallback(&LinuxSensorProviderPerf::destroySensor);
+	mSensors[name] = sensor;
+}
+
+void LinuxSensorProviderPerf::updateSensor(SensorBean* sensor) {
+	PerfSensor* tag = static_cast<PerfSensor*>(sensor->mTag);
+	// On first update only get current values
+	if (!tag->counters->update(tag->generation)) {
+		return;
+	}
+	PerfCounters* counters = tag->counters;
+	double elapsed = counters->getElapsed();
+	switch (tag->kind) {
+		case PERF_IPC: {
+			uint64_t cycles = counters->getDelta(PerfCounters::CYCLES);
+			sensor->setData(cycles > 0 ? (double)counters->getDelta(PerfCounters::INSTRUCTIONS) / (double)cycles : 0.0);
+			break;
+		}
+		case PERF_CACHE_MISSES: {
+			uint64_t references = counters->getDelta(PerfCounters::CACHE_REFERENCES);
+			sensor->setData(references > 0 ? (double)counters->getDelta(PerfCounters::CACHE_MISSES) * 100.0 / (double)references : 0.0);
+			break;
+		}
+		case PERF_CONTEXT_SWITCHES:
+			if (elapsed > 0.0) {
+				sensor->setData((double)counters->getDelta(PerfCounters::CONTEXT_SWITCHES) / elapsed);
+			}
+			break;
+		case PERF_PAGE_FAULTS:
+			if (elapsed > 0.0) {
+				sensor->setData((double)counters->getDelta(PerfCounters::PAGE_FAULTS) / elapsed);
+			}
+			break;
+	}
+}
+
+void LinuxSensorProviderPerf::destroySensor(SensorBean* sensor) {
+	PerfSensor* tag = static_cast<PerfSensor*>(sensor->mTag);
+	tag->counters->release();
+	delete tag;
+}
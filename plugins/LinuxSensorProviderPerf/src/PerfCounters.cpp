@@ -0,0 +1,186 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "PerfCounters.h"
+
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+static const struct {
+	uint32_t type;
+	uint64_t config;
+} events[PerfCounters::COUNTER_COUNT] = {
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+	{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+	{ PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES },
+	{ PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS }
+};
+
+// Software events can be members of a hardware group, the group is scheduled with its leader
+static const PerfCounters::Counter hardwareGroup[] = { PerfCounters::CYCLES, PerfCounters::INSTRUCTIONS, PerfCounters::CACHE_REFERENCES, PerfCounters::CACHE_MISSES, PerfCounters::CONTEXT_SWITCHES, PerfCounters::PAGE_FAULTS };
+static const PerfCounters::Counter softwareGroup[] = { PerfCounters::CONTEXT_SWITCHES, PerfCounters::PAGE_FAULTS };
+
+static int perfEventOpen(struct perf_event_attr* attr, int cpu, int groupFd) {
+	return syscall(__NR_perf_event_open, attr, -1, cpu, groupFd, PERF_FLAG_FD_CLOEXEC);
+}
+
+PerfCounters::PerfCounters() :
+	mGroups(), mBuffer(), mElapsed(0.0), mGeneration(0), mRefCount(0) {
+	for (int i = 0; i < COUNTER_COUNT; ++i) {
+		mHasCounter[i] = false;
+		mDelta[i] = 0;
+	}
+	mLastTimestamp.tv_sec = 0;
+	mLastTimestamp.tv_nsec = 0;
+}
+
+PerfCounters::~PerfCounters() {
+	for (std::vector<Group>::iterator group = mGroups.begin(); group != mGroups.end(); ++group) {
+		for (std::vector<int>::iterator fd = group->fds.begin(); fd != group->fds.end(); ++fd) {
+			close(*fd);
+		}
+	}
+}
+
+bool PerfCounters::open(void) {
+	long cpuCount = sysconf(_SC_NPROCESSORS_CONF);
+	for (int cpu = 0; cpu < cpuCount; ++cpu) {
+		if (!openGroup(cpu, hardwareGroup, sizeof(hardwareGroup) / sizeof(hardwareGroup[0]))) {
+			// No hardware PMU, offline cpu or not permitted
+			openGroup(cpu, softwareGroup, sizeof(softwareGroup) / sizeof(softwareGroup[0]));
+		}
+	}
+	if (mGroups.empty()) {
+		return false;
+	}
+	// All groups have to provide a counter for its sum to be meaningful
+	for (int i = 0; i < COUNTER_COUNT; ++i) {
+		mHasCounter[i] = true;
+	}
+	size_t maxCount = 0;
+	for (std::vector<Group>::iterator group = mGroups.begin(); group != mGroups.end(); ++group) {
+		for (int i = 0; i < COUNTER_COUNT; ++i) {
+			bool found = false;
+			for (std::vector<Counter>::iterator counter = group->counters.begin(); counter != group->counters.end(); ++counter) {
+				found |= *counter == i;
+			}
+			mHasCounter[i] &= found;
+		}
+		maxCount = std::max(maxCount, group->counters.size());
+	}
+	// nr, time_enabled, time_running, values
+	mBuffer.resize(3 + maxCount);
+	return true;
+}
+
+bool PerfCounters::openGroup(int cpu, const Counter* counters, size_t count) {
+	Group group;
+	group.leader = -1;
+	for (size_t i = 0; i < count; ++i) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = events[counters[i]].type;
+		attr.config = events[counters[i]].config;
+		attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		int fd = perfEventOpen(&attr, cpu, group.leader);
+		if (fd < 0) {
+			if (i == 0) {
+				return false;
+			}
+			continue; // Group without this counter
+		}
+		if (i == 0) {
+			group.leader = fd;
+		}
+		group.fds.push_back(fd);
+		group.counters.push_back(counters[i]);
+	}
+	group.last.resize(group.counters.size(), 0);
+	mGroups.push_back(group);
+	return true;
+}
+
+bool PerfCounters::hasCounter(Counter counter) const {
+	return mHasCounter[counter];
+}
+
+void PerfCounters::acquire(void) {
+	mRefCount++;
+}
+
+void PerfCounters::release(void) {
+	if (--mRefCount == 0) {
+		delete this;
+	}
+}
+
+bool PerfCounters::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		read();
+	}
+	seenGeneration = mGeneration;
+	return mGeneration >= 2;
+}
+
+void PerfCounters::read(void) {
+	mGeneration++;
+	for (int i = 0; i < COUNTER_COUNT; ++i) {
+		mDelta[i] = 0;
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	mElapsed = (double)(now.tv_sec - mLastTimestamp.tv_sec) + (double)(now.tv_nsec - mLastTimestamp.tv_nsec) / 1e9;
+	mLastTimestamp = now;
+
+	for (std::vector<Group>::iterator group = mGroups.begin(); group != mGroups.end(); ++group) {
+		ssize_t length = ::read(group->leader, &mBuffer[0], (3 + group->counters.size()) * sizeof(uint64_t));
+		if (length < (ssize_t)(3 * sizeof(uint64_t)) || mBuffer[0] != group->counters.size()) {
+			continue;
+		}
+		uint64_t enabled = mBuffer[1];
+		uint64_t running = mBuffer[2];
+		for (size_t i = 0; i < group->counters.size(); ++i) {
+			// Estimate for the time the group was multiplexed out
+			uint64_t value = running > 0 && running < enabled ? (uint64_t)((double)mBuffer[3 + i] * enabled / running) : mBuffer[3 + i];
+			if (value >= group->last[i]) {
+				mDelta[group->counters[i]] += value - group->last[i];
+			}
+			group->last[i] = value;
+		}
+	}
+}
+
+uint64_t PerfCounters::getDelta(Counter counter) const {
+	return mDelta[counter];
+}
+
+double PerfCounters::getElapsed(void) const {
+	return mElapsed;
+}
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PERFCOUNTERS_H_
+#define PERFCOUNTERS_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+
+// One perf_event group per cpu, all counters of a group are read with a
+// single read() through PERF_FORMAT_GROUP. Without hardware PMU (e.g. in
+// VMs) the groups only contain software events. Read once per tick like
+// ProcStat.
+class PerfCounters {
+public:
+	enum Counter { CYCLES, INSTRUCTIONS, CACHE_REFERENCES, CACHE_MISSES, CONTEXT_SWITCHES, PAGE_FAULTS, COUNTER_COUNT };
+
+	PerfCounters();
+
+	// Returns false if no group could be opened on any cpu
+	bool open(void);
+	bool hasCounter(Counter counter) const;
+
+	void acquire(void);
+	void release(void);
+
+	// Returns false until two samples are available
+	bool update(uint32_t& seenGeneration);
+
+	// Sum over all cpus since the last sample, scaled for multiplexing
+	uint64_t getDelta(Counter counter) const;
+	double getElapsed(void) const; // s
+
+private:
+	//lint -e(1704)
+	PerfCounters(const PerfCounters& cSource);
+	PerfCounters& operator=(const PerfCounters& cSource);
+	~PerfCounters();
+
+	struct Group {
+		int leader;
+		std::vector<int> fds;
+		std::vector<Counter> counters; // In group order
+		std::vector<uint64_t> last; // Scaled values of the previous read
+	};
+
+	bool openGroup(int cpu, const Counter* counters, size_t count);
+	void read(void);
+
+	std::vector<Group> mGroups;
+	std::vector<uint64_t> mBuffer;
+	bool mHasCounter[COUNTER_COUNT];
+	uint64_t mDelta[COUNTER_COUNT];
+	struct timespec mLastTimestamp;
+	double mElapsed;
+	uint32_t mGeneration;
+	int mRefCount;
+};
+
+#endif /* PERFCOUNTERS_H_ */
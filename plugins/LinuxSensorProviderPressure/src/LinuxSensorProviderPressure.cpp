@@ -0,0 +1,251 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LinuxSensorProviderPressure.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+
+using namespace std;
+
+LoggerPtr LinuxSensorProviderPressure::logger;
+IConfig* LinuxSensorProviderPressure::config;
+PF_InvokeServiceFunc LinuxSensorProviderPressure::invokeService;
+
+void * LinuxSensorProviderPressure::create(PF_ObjectParams *) {
+	return new LinuxSensorProviderPressure();
+}
+
+int32_t LinuxSensorProviderPressure::destroy(void * p) {
+	if (!p)
+		return -1;
+	delete static_cast<LinuxSensorProviderPressure*>(p);
+	return 0;
+}
+
+LinuxSensorProviderPressure::LinuxSensorProviderPressure() :
+	mSensors() {
+	// Stall time in µs per window that fires the trigger, 0 to disable
+	int stall = config->GetInt("Plugins", "psiTriggerStall", 100000);
+	int window = config->GetInt("Plugins", "psiTriggerWindow", 2000000);
+
+	static const char* names[] = { "cpu", "memory", "io" };
+	for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+		Resource* resource = new Resource(names[i]);
+		resource->acquire();
+		uint32_t generation = 0;
+		resource->update(generation);
+		if (!resource->valid[LINE_SOME]) {
+			LOG_WARN(logger, "Could not read /proc/pressure/" << names[i] << ", kernel without PSI support?");
+			resource->release();
+			continue;
+		}
+		addSensor(resource, LINE_SOME, VALUE_AVG10);
+		addSensor(resource, LINE_SOME, VALUE_AVG60);
+		addSensor(resource, LINE_SOME, VALUE_TOTAL);
+		// "full" is always zero for cpu on system level
+		if (i > 0 && resource->valid[LINE_FULL]) {
+			addSensor(resource, LINE_FULL, VALUE_AVG10);
+			addSensor(resource, LINE_FULL, VALUE_AVG60);
+			addSensor(resource, LINE_FULL, VALUE_TOTAL);
+		}
+		if (stall > 0) {
+			resource->addTrigger(stall, window);
+		}
+		resource->release();
+	}
+}
+
+LinuxSensorProviderPressure::~LinuxSensorProviderPressure() {
+}
+
+map<string, ISensor*> LinuxSensorProviderPressure::getSensors(void) {
+	return mSensors;
+}
+
+void LinuxSensorProviderPressure::addSensor(Resource* resource, Line line, Value value) {
+	static const char* lines[] = { "some", "full" };
+	static const char* values[] = { "avg10", "avg60", "total" };
+	string name = "PSI " + resource->name + " " + lines[line] + " " + values[value];
+
+	PressureSensor* tag = new PressureSensor();
+	tag->resource = resource;
+	tag->line = line;
+	tag->value = value;
+	tag->generation = 0;
+	resource->acquire();
+
+	SensorBean* sensor;
+	if (value == VALUE_TOTAL) {
+		// Accumulated stall time in µs
+		sensor = new SensorBean(name, TYPE_U64, 8, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+		sensor->setData((uint64_t)0);
+	} else {
+		sensor = new SensorBean(name, TYPE_FLOAT, 8, 1, UNIT_PERCENT, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+		sensor->setData(0.0);
+	}
+	sensor->setUpdateCallback(&LinuxSensorProviderPressure::updateSensor);
+	sensor->setDestroyCallback(&LinuxSensorProviderPressure::destroySensor);
+	sensor->mTag = tag;
+	mSensors[name] = sensor;
+}
+
+void LinuxSensorProviderPressure::updateSensor(SensorBean* sensor) {
+	PressureSensor* tag = static_cast<PressureSensor*>(sensor->mTag);
+	Resource* resource = tag->resource;
+	resource->update(tag->generation);
+	if (!resource->valid[tag->line]) {
+		return;
+	}
+	switch (tag->value) {
+		case VALUE_AVG10:
+			sensor->setData(resource->avg10[tag->line]);
+			break;
+		case VALUE_AVG60:
+			sensor->setData(resource->avg60[tag->line]);
+			break;
+		case VALUE_TOTAL:
+			sensor->setData(resource->total[tag->line]);
+			break;
+	}
+}
+
+void LinuxSensorProviderPressure::destroySensor(SensorBean* sensor) {
+	PressureSensor* tag = static_cast<PressureSensor*>(sensor->mTag);
+	tag->resource->release();
+	delete tag;
+}
+
+LinuxSensorProviderPressure::Resource::Resource(const string& resourceName) :
+	name(resourceName), file(("/proc/pressure/" + resourceName).c_str(), 256), triggerFd(-1), mGeneration(0), mRefCount(0) {
+	for (int i = 0; i < LINE_COUNT; ++i) {
+		valid[i] = false;
+		avg10[i] = 0.0;
+		avg60[i] = 0.0;
+		total[i] = 0;
+	}
+}
+
+LinuxSensorProviderPressure::Resource::~Resource() {
+	if (triggerFd >= 0) {
+		if (invokeService != NULL) {
+			invokeService((const uint8_t *)"removeWakeupFd", &triggerFd);
+		}
+		close(triggerFd);
+	}
+}
+
+void LinuxSensorProviderPressure::Resource::acquire(void) {
+	mRefCount++;
+}
+
+void LinuxSensorProviderPressure::Resource::release(void) {
+	if (--mRefCount == 0) {
+		delete this;
+	}
+}
+
+void LinuxSensorProviderPressure::Resource::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		read();
+	}
+	seenGeneration = mGeneration;
+}
+
+void LinuxSensorProviderPressure::Resource::read(void) {
+	mGeneration++;
+	valid[LINE_SOME] = false;
+	valid[LINE_FULL] = false;
+	if (!file.read()) {
+		return;
+	}
+	// some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+	const char* p = file.data();
+	const char* end = file.end();
+	while (p < end) {
+		Line line;
+		if (end - p > 5 && memcmp(p, "some ", 5) == 0) {
+			line = LINE_SOME;
+		} else if (end - p > 5 && memcmp(p, "full ", 5) == 0) {
+			line = LINE_FULL;
+		} else {
+			procNextLine(p, end);
+			continue;
+		}
+		p += 5;
+		char* next;
+		if (end - p > 6 && memcmp(p, "avg10=", 6) == 0) {
+			avg10[line] = strtod(p + 6, &next);
+			p = next;
+		}
+		procSkipBlanks(p, end);
+		if (end - p > 6 && memcmp(p, "avg60=", 6) == 0) {
+			avg60[line] = strtod(p + 6, &next);
+			p = next;
+		}
+		// avg300 is not exposed
+		const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+		if (lineEnd == NULL) {
+			lineEnd = end;
+		}
+		const char* totalValue = (const char*)memmem(p, lineEnd - p, "total=", 6);
+		if (totalValue != NULL) {
+			totalValue += 6;
+			valid[line] = procScanUint64(totalValue, lineEnd, total[line]);
+		}
+		p = lineEnd;
+		procNextLine(p, end);
+	}
+}
+
+void LinuxSensorProviderPressure::Resource::addTrigger(int stall, int window) {
+	string path = "/proc/pressure/" + name;
+	triggerFd = open(path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (triggerFd < 0) {
+		LOG_WARN(logger, "Could not open " << path << " for writing, no trigger: " << strerror(errno));
+		return;
+	}
+	char trigger[64];
+	int length = snprintf(trigger, sizeof(trigger), "some %d %d", stall, window);
+	// Unprivileged triggers need a window that is a multiple of 2 s
+	if (write(triggerFd, trigger, length + 1) < 0) {
+		LOG_WARN(logger, "Could not register trigger '" << trigger << "' on " << path << ": " << strerror(errno));
+		close(triggerFd);
+		triggerFd = -1;
+		return;
+	}
+	if (invokeService != NULL) {
+		struct pollfd fd;
+		fd.fd = triggerFd;
+		fd.events = POLLPRI;
+		fd.revents = 0;
+		invokeService((const uint8_t *)"addWakeupFd", &fd);
+	}
+	LOG_INFO(logger, "Registered trigger '" << trigger << "' on " << path);
+}
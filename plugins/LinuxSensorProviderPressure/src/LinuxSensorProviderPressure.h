@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LINUXSENSORPROVIDERPRESSURE_H
+#define LINUXSENSORPROVIDERPRESSURE_H
+
+#include <object_model.h>
+#include <string>
+#include <map>
+#include <logger.h>
+#include <c_object_model.h>
+#include <SensorBean.h>
+#include <IConfig.h>
+#include <ProcFile.h>
+
+struct PF_ObjectParams;
+typedef void* (*PF_InvokeServiceFunc)(const uint8_t * serviceName, void * serviceParams);
+
+// Pressure stall information of /proc/pressure/{cpu,memory,io}. A PSI trigger
+// per resource wakes the daemon's update loop as soon as stalls exceed the
+// configured threshold.
+class LinuxSensorProviderPressure: public ISensorProvider {
+public:
+	// static plugin interface
+	static void * create(PF_ObjectParams *);
+	static int32_t destroy(void *);
+	~LinuxSensorProviderPressure();
+
+	// ISensorProvider methods
+	virtual std::map<std::string, ISensor*> getSensors(void);
+
+	static LoggerPtr logger;
+	static IConfig* config;
+	static PF_InvokeServiceFunc invokeService;
+private:
+	enum Line { LINE_SOME, LINE_FULL, LINE_COUNT };
+	enum Value { VALUE_AVG10, VALUE_AVG60, VALUE_TOTAL };
+
+	// One pressure file, read once per tick by the first of its sensors
+	class Resource {
+		public:
+		Resource(const std::string& name);
+		void acquire(void);
+		void release(void);
+		void update(uint32_t& seenGeneration);
+		void addTrigger(int stall, int window);
+
+		std::string name;
+		ProcFile file;
+		bool valid[LINE_COUNT];
+		double avg10[LINE_COUNT];
+		double avg60[LINE_COUNT];
+		uint64_t total[LINE_COUNT]; // µs
+		int triggerFd;
+		private:
+		//lint -e(1704)
+		Resource(const Resource& cSource);
+		Resource& operator=(const Resource& cSource);
+		~Resource();
+		void read(void);
+		uint32_t mGeneration;
+		int mRefCount;
+	};
+
+	struct PressureSensor {
+		Resource* resource;
+		Line line;
+		Value value;
+		uint32_t generation;
+	};
+
+	LinuxSensorProviderPressure();
+	void addSensor(Resource* resource, Line line, Value value);
+	static void updateSensor(SensorBean* sensor);
+	static void destroySensor(SensorBean* sensor);
+
+	std::map<std::string, ISensor*> mSensors;
+};
+
+#endif
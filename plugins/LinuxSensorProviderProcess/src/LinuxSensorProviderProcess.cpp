@@ -0,0 +1,159 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LinuxSensorProviderProcess.h"
+#include "ProcessTarget.h"
+
+#include <cstring>
+#include <sstream>
+#include <daemon_msgs.h>
+
+using namespace std;
+
+LoggerPtr LinuxSensorProviderProcess::logger;
+IConfig* LinuxSensorProviderProcess::config;
+
+void * LinuxSensorProviderProcess::create(PF_ObjectParams *) {
+	return new LinuxSensorProviderProcess();
+}
+
+int32_t LinuxSensorProviderProcess::destroy(void * p) {
+	if (!p)
+		return -1;
+	delete static_cast<LinuxSensorProviderProcess*>(p);
+	return 0;
+}
+
+LinuxSensorProviderProcess::LinuxSensorProviderProcess() :
+	mSensors() {
+	// <label>=name:<comm>|pidfile:<path>|unit:<systemd unit>, comma separated
+	string targets = config->GetString("Plugins", "processTargets", "");
+	string cgroupRoot = config->GetString("Plugins", "processUnitCgroupRoot", "/sys/fs/cgroup/system.slice");
+	int resolveInterval = config->GetInt("Plugins", "processResolveInterval", 10);
+
+	std::stringstream ss(targets);
+	string definition;
+	while (std::getline(ss, definition, ',')) {
+		if (!definition.empty()) {
+			addTarget(definition, cgroupRoot, resolveInterval);
+		}
+	}
+}
+
+LinuxSensorProviderProcess::~LinuxSensorProviderProcess() {
+}
+
+map<string, ISensor*> LinuxSensorProviderProcess::getSensors(void) {
+	return mSensors;
+}
+
+void LinuxSensorProviderProcess::addTarget(const string& definition, const string& cgroupRoot, int resolveInterval) {
+	size_t equals = definition.find('=');
+	size_t colon = definition.find(':', equals);
+	if (equals == string::npos || equals == 0 || colon == string::npos || colon + 1 == definition.length()) {
+		LOG_ERROR(logger, "Invalid process target '" << definition << "', expected <label>=<name|pidfile|unit>:<value>");
+		return;
+	}
+	string label = definition.substr(0, equals);
+	string type = definition.substr(equals + 1, colon - equals - 1);
+	string value = definition.substr(colon + 1);
+	ProcessTarget::Kind kind;
+	if (type == "name") {
+		kind = ProcessTarget::BY_NAME;
+	} else if (type == "pidfile") {
+		kind = ProcessTarget::BY_PIDFILE;
+	} else if (type == "unit") {
+		kind = ProcessTarget::BY_UNIT;
+	} else {
+		LOG_ERROR(logger, "Unknown process target type '" << type << "' in '" << definition << "'");
+		return;
+	}
+	// The kernel truncates /proc/<pid>/comm to 15 characters, a longer name would never match
+	if (kind == ProcessTarget::BY_NAME && value.length() > 15) {
+		LOG_WARN(logger, "Process name '" << value << "' is longer than 15 characters, matching only '" << value.substr(0, 15) << "'");
+		value = value.substr(0, 15);
+	}
+	// Room for the longest sensor suffix " restarts"
+	label = label.substr(0, SENSOR_NAME_LENGTH - 9);
+	if (mSensors.find(label + " CPU") != mSensors.end()) {
+		LOG_ERROR(logger, "Duplicate process target label '" << label << "', ignoring");
+		return;
+	}
+	LOG_INFO(logger, "Watching process '" << label << "' by " << type << " " << value);
+
+	ProcessTarget* target = new ProcessTarget(kind, value, cgroupRoot, resolveInterval);
+	target->acquire();
+	addSensor(target, label + " CPU", TYPE_FLOAT, UNIT_PERCENT, PROCESS_CPU);
+	addSensor(target, label + " RSS", TYPE_U64, UNIT_BYTE, PROCESS_RSS);
+	addSensor(target, label + " threads", TYPE_U32, UNIT_DIMENSIONLESS, PROCESS_THREADS);
+	addSensor(target, label + " restarts", TYPE_U32, UNIT_DIMENSIONLESS, PROCESS_RESTARTS);
+	target->release();
+}
+
+void LinuxSensorProviderProcess::addSensor(ProcessTarget* target, const string& name, ISensorDataType dataType, ISensorUnit unit, ProcessKind kind) {
+	ProcessSensor* tag = new ProcessSensor();
+	tag->target = target;
+	tag->kind = kind;
+	tag->generation = 0;
+	target->acquire();
+
+	SensorBean* sensor = new SensorBean(name, dataType, dataType == TYPE_U32 ? 4 : 8, 1, unit, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	if (dataType == TYPE_FLOAT) {
+		sensor->setData(0.0);
+	} else if (dataType == TYPE_U64) {
+		sensor->setData((uint64_t)0);
+	} else {
+		sensor->setData((uint32_t)0);
+	}
+	sensor->mTag = tag;
+	sensor->setUpdateCallback(&LinuxSensorProviderProcess::updateSensor);
+	sensor->setDestroyCallback(&LinuxSensorProviderProcess::destroySensor);
+	mSensors[name] = sensor;
+}
+
+void LinuxSensorProviderProcess::updateSensor(SensorBean* sensor) {
+	ProcessSensor* tag = static_cast<ProcessSensor*>(sensor->mTag);
+	// Values are zero while the process is not running
+	tag->target->update(tag->generation);
+	switch (tag->kind) {
+		case PROCESS_CPU:
+			sensor->setData(tag->target->getCpuUtilization());
+			break;
+		case PROCESS_RSS:
+			sensor->setData(tag->target->getResidentSize());
+			break;
+		case PROCESS_THREADS:
+			sensor->setData(tag->target->getThreads());
+			break;
+		case PROCESS_RESTARTS:
+			sensor->setData(tag->target->getRestarts());
+			break;
+	}
+}
+
+void LinuxSensorProviderProcess::destroySensor(SensorBean* sensor) {
+	ProcessSensor* tag = static_cast<ProcessSensor*>(sensor->mTag);
+	tag->target->release();
+	delete tag;
+}
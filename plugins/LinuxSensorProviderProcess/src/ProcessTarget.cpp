@@ -0,0 +1,257 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ProcessTarget.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+#include <unistd.h>
+#include <dirent.h>
+
+static long clockTicks = sysconf(_SC_CLK_TCK);
+static long pageSize = sysconf(_SC_PAGESIZE);
+static long cpuCount = sysconf(_SC_NPROCESSORS_ONLN);
+
+ProcessTarget::ProcessTarget(Kind kind, const std::string& value, const std::string& cgroupRoot, int resolveInterval) :
+	mKind(kind), mValue(value), mCgroupRoot(cgroupRoot), mResolveInterval(resolveInterval), mPid(0), mStat(NULL), mStatm(NULL),
+	mStartTime(0), mEverRunning(false), mLastCpuTime(0), mCpuUtilization(0.0), mResidentSize(0), mThreads(0), mRestarts(0),
+	mGeneration(0), mRefCount(0) {
+	mLastResolve.tv_sec = 0;
+	mLastResolve.tv_nsec = 0;
+	mLastUpdate.tv_sec = 0;
+	mLastUpdate.tv_nsec = 0;
+}
+
+ProcessTarget::~ProcessTarget() {
+	closeFiles();
+}
+
+void ProcessTarget::acquire(void) {
+	mRefCount++;
+}
+
+void ProcessTarget::release(void) {
+	if (--mRefCount == 0) {
+		delete this;
+	}
+}
+
+bool ProcessTarget::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		read();
+	}
+	seenGeneration = mGeneration;
+	return mStat != NULL;
+}
+
+double ProcessTarget::getCpuUtilization(void) const {
+	return mCpuUtilization;
+}
+
+uint64_t ProcessTarget::getResidentSize(void) const {
+	return mResidentSize;
+}
+
+uint32_t ProcessTarget::getThreads(void) const {
+	return mThreads;
+}
+
+uint32_t ProcessTarget::getRestarts(void) const {
+	return mRestarts;
+}
+
+void ProcessTarget::read(void) {
+	mGeneration++;
+	if (mStat != NULL && readStat()) {
+		return;
+	}
+	// Process is gone (or was never found), reads of its fds fail with ESRCH
+	closeFiles();
+	mCpuUtilization = 0.0;
+	mResidentSize = 0;
+	mThreads = 0;
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	// Failed lookups are only repeated every mResolveInterval
+	if (mLastResolve.tv_sec != 0 && now.tv_sec - mLastResolve.tv_sec < mResolveInterval) {
+		return;
+	}
+	// Only a process whose stat could be read counts as (re)started, not a zombie
+	if (resolve() && readStat()) {
+		if (mEverRunning) {
+			mRestarts++;
+		}
+		mEverRunning = true;
+		mLastResolve.tv_sec = 0;
+	} else {
+		closeFiles();
+		mLastResolve = now;
+	}
+}
+
+bool ProcessTarget::readStat(void) {
+	if (!mStat->read()) {
+		return false;
+	}
+	// <pid> (<comm>) <state> ... comm may contain spaces and parentheses
+	const char* end = mStat->end();
+	const char* p = (const char*)memrchr(mStat->data(), ')', end - mStat->data());
+	if (p == NULL) {
+		return false;
+	}
+	++p;
+	// Fields 3 (state) to 22 (starttime), 1-based as in proc(5)
+	uint64_t utime = 0, stime = 0, threads = 0, startTime = 0;
+	procSkipBlanks(p, end);
+	// A zombie is not running anymore, even if not yet reaped by its parent
+	if (p >= end || *p == 'Z' || *p == 'X') {
+		return false;
+	}
+	++p;
+	for (int field = 4; field <= 22; ++field) {
+		int64_t value;
+		if (!procScanInt64(p, end, value)) {
+			return false;
+		}
+		switch (field) {
+			case 14: utime = value; break;
+			case 15: stime = value; break;
+			case 20: threads = value; break;
+			case 22: startTime = value; break;
+			default: break;
+		}
+	}
+	if (mStartTime != 0 && startTime != mStartTime) {
+		return false;
+	}
+	mStartTime = startTime;
+	mThreads = threads;
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	uint64_t cpuTime = utime + stime;
+	// On first update only get current time and values
+	if (mLastUpdate.tv_sec != 0 && cpuTime >= mLastCpuTime) {
+		double diff = (now.tv_sec - mLastUpdate.tv_sec) + (now.tv_nsec - mLastUpdate.tv_nsec) / 1000000000.0;
+		if (diff > 0.0) {
+			mCpuUtilization = (double)(cpuTime - mLastCpuTime) * 100.0 / (diff * clockTicks * cpuCount);
+		}
+	}
+	mLastUpdate = now;
+	mLastCpuTime = cpuTime;
+
+	// <size> <resident> <shared> ... in pages
+	if (mStatm->read()) {
+		const char* q = mStatm->data();
+		uint64_t size, resident;
+		if (procScanUint64(q, mStatm->end(), size) && procScanUint64(q, mStatm->end(), resident)) {
+			mResidentSize = resident * pageSize;
+		}
+	}
+	return true;
+}
+
+bool ProcessTarget::resolve(void) {
+	pid_t pid = 0;
+	switch (mKind) {
+		case BY_NAME:
+			pid = findByName();
+			break;
+		case BY_PIDFILE:
+			pid = findByPidfile();
+			break;
+		case BY_UNIT:
+			pid = findByUnit();
+			break;
+	}
+	if (pid <= 0) {
+		return false;
+	}
+	std::ostringstream path;
+	path << "/proc/" << pid << "/";
+	mStat = new ProcFile((path.str() + "stat").c_str(), 1024);
+	mStatm = new ProcFile((path.str() + "statm").c_str(), 128);
+	if (!mStat->isOpen() || !mStatm->isOpen()) {
+		closeFiles();
+		return false;
+	}
+	mPid = pid;
+	mStartTime = 0;
+	mLastUpdate.tv_sec = 0;
+	mLastUpdate.tv_nsec = 0;
+	return true;
+}
+
+pid_t ProcessTarget::findByName(void) const {
+	// Only scanned while the target is not running, at most every mResolveInterval
+	DIR* dir = opendir("/proc");
+	if (dir == NULL) {
+		return 0;
+	}
+	pid_t found = 0;
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL) {
+		char* end;
+		long pid = strtol(entry->d_name, &end, 10);
+		if (*end != '\0' || pid <= 0 || (found != 0 && pid >= found)) {
+			continue;
+		}
+		std::string path = std::string("/proc/") + entry->d_name + "/comm";
+		ProcFile comm(path.c_str(), 32);
+		if (comm.read() && mValue.compare(0, std::string::npos, comm.data(), strcspn(comm.data(), "\n")) == 0) {
+			// Lowest pid is the main process of forking services
+			found = pid;
+		}
+	}
+	closedir(dir);
+	return found;
+}
+
+pid_t ProcessTarget::findByPidfile(void) const {
+	ProcFile file(mValue.c_str(), 32);
+	if (!file.read()) {
+		return 0;
+	}
+	return (pid_t)strtol(file.data(), NULL, 10);
+}
+
+pid_t ProcessTarget::findByUnit(void) const {
+	// First process of the unit's cgroup is its main process
+	std::string path = mCgroupRoot + "/" + mValue + "/cgroup.procs";
+	ProcFile file(path.c_str(), 4096);
+	if (!file.read()) {
+		return 0;
+	}
+	return (pid_t)strtol(file.data(), NULL, 10);
+}
+
+void ProcessTarget::closeFiles(void) {
+	delete mStat;
+	delete mStatm;
+	mStat = NULL;
+	mStatm = NULL;
+	mPid = 0;
+}
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROCESSTARGET_H_
+#define PROCESSTARGET_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include <string>
+#include <ProcFile.h>
+
+// A watched process, found by name, pidfile or systemd unit. Only its
+// /proc/<pid>/stat and statm are read per tick, the target is resolved
+// again when the process is gone.
+class ProcessTarget {
+public:
+	enum Kind { BY_NAME, BY_PIDFILE, BY_UNIT };
+
+	ProcessTarget(Kind kind, const std::string& value, const std::string& cgroupRoot, int resolveInterval);
+
+	void acquire(void);
+	void release(void);
+
+	// Returns true if the process is running
+	bool update(uint32_t& seenGeneration);
+
+	double getCpuUtilization(void) const; // Percent of all cpus
+	uint64_t getResidentSize(void) const; // Bytes
+	uint32_t getThreads(void) const;
+	uint32_t getRestarts(void) const;
+
+private:
+	//lint -e(1704)
+	ProcessTarget(const ProcessTarget& cSource);
+	ProcessTarget& operator=(const ProcessTarget& cSource);
+	~ProcessTarget();
+
+	void read(void);
+	bool readStat(void);
+	bool resolve(void);
+	pid_t findByName(void) const;
+	pid_t findByPidfile(void) const;
+	pid_t findByUnit(void) const;
+	void closeFiles(void);
+
+	Kind mKind;
+	std::string mValue;
+	std::string mCgroupRoot;
+	int mResolveInterval; // s
+	pid_t mPid;
+	ProcFile* mStat;
+	ProcFile* mStatm;
+	uint64_t mStartTime; // Tells a restarted process from the old one
+	bool mEverRunning;
+	struct timespec mLastResolve;
+	struct timespec mLastUpdate;
+	uint64_t mLastCpuTime; // Clock ticks
+	double mCpuUtilization;
+	uint64_t mResidentSize;
+	uint32_t mThreads;
+	uint32_t mRestarts;
+	uint32_t mGeneration;
+	int mRefCount;
+};
+
+#endif /* PROCESSTARGET_H_ */
@@ -0,0 +1,168 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "LinuxSensorProviderRapl.h"
+#include "RaplZone.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <dirent.h>
+#include <ProcFile.h>
+#include <daemon_msgs.h>
+
+using namespace std;
+
+LoggerPtr LinuxSensorProviderRapl::logger;
+IConfig* LinuxSensorProviderRapl::config;
+
+void * LinuxSensorProviderRapl::create(PF_ObjectParams *) {
+	return new LinuxSensorProviderRapl();
+}
+
+int32_t LinuxSensorProviderRapl::destroy(void * p) {
+	if (!p)
+		return -1;
+	delete static_cast<LinuxSensorProviderRapl*>(p);
+	return 0;
+}
+
+LinuxSensorProviderRapl::LinuxSensorProviderRapl() :
+	mSensors() {
+	mRoot = config->GetString("Plugins", "raplSysfsRoot", "/sys");
+
+	// Top level zones are intel-rapl:<package>, sub zones intel-rapl:<package>:<n>.
+	// intel-rapl-mmio exposes the same package counters again and is skipped.
+	string classPath = mRoot + "/class/powercap";
+	vector<string> zones;
+	DIR* dir = opendir(classPath.c_str());
+	if (dir != NULL) {
+		struct dirent* entry;
+		while ((entry = readdir(dir)) != NULL) {
+			if (strncmp(entry->d_name, "intel-rapl:", 11) == 0) {
+				zones.push_back(entry->d_name);
+			}
+		}
+		closedir(dir);
+	}
+	if (zones.empty()) {
+		LOG_WARN(logger, "No RAPL zones found in " << classPath);
+	}
+	sort(zones.begin(), zones.end());
+
+	for (vector<string>::iterator it = zones.begin(); it != zones.end(); ++it) {
+		string name = readString(classPath + "/" + *it + "/name");
+		if (name.empty()) {
+			name = *it;
+		}
+		size_t parentEnd = it->rfind(':');
+		if (parentEnd > 10) {
+			// Sub zone, e.g. "package-0 dram"
+			string parent = readString(classPath + "/" + it->substr(0, parentEnd) + "/name");
+			if (!parent.empty()) {
+				name = parent + " " + name;
+			}
+		}
+		addZone(classPath + "/" + *it, name);
+	}
+}
+
+LinuxSensorProviderRapl::~LinuxSensorProviderRapl() {
+}
+
+map<string, ISensor*> LinuxSensorProviderRapl::getSensors(void) {
+	return mSensors;
+}
+
+void LinuxSensorProviderRapl::addZone(const string& zonePath, const string& name) {
+	string range = readString(zonePath + "/max_energy_range_uj");
+	uint64_t maxEnergyRange = strtoull(range.c_str(), NULL, 10);
+	if (maxEnergyRange == 0) {
+		LOG_WARN(logger, "Could not read " << zonePath << "/max_energy_range_uj, ignoring zone '" << name << "'");
+		return;
+	}
+	RaplZone* zone = new RaplZone(zonePath + "/energy_uj", maxEnergyRange);
+	if (!zone->isOpen()) {
+		// Only readable by root on kernels with the PLATYPUS mitigation
+		LOG_WARN(logger, "Could not open " << zonePath << "/energy_uj, ignoring zone '" << name << "'");
+		delete zone;
+		return;
+	}
+	LOG_INFO(logger, "Found RAPL zone '" << name << "' at " << zonePath);
+
+	zone->acquire();
+	addSensor(zone, name + " power", ZONE_POWER);
+	addSensor(zone, name + " energy", ZONE_ENERGY);
+	zone->release();
+}
+
+void LinuxSensorProviderRapl::addSensor(RaplZone* zone, const string& name, ZoneValue value) {
+	string sensorName = name.substr(0, SENSOR_NAME_LENGTH);
+	if (mSensors.find(sensorName) != mSensors.end()) {
+		LOG_WARN(logger, "Duplicate sensor name '" << sensorName << "', ignoring");
+		return;
+	}
+	ZoneSensor* tag = new ZoneSensor();
+	tag->zone = zone;
+	tag->value = value;
+	tag->generation = 0;
+	zone->acquire();
+
+	// Energy has no unit of its own in the management protocol, it is sent in J
+	SensorBean* sensor = new SensorBean(sensorName, TYPE_FLOAT, 8, 1, value == ZONE_POWER ? UNIT_POWER : UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData(0.0);
+	sensor->setUpdateCallback(&LinuxSensorProviderRapl::updateSensor);
+	sensor->setDestroyCallback(&LinuxSensorProviderRapl::destroySensor);
+	sensor->mTag = tag;
+	mSensors[sensorName] = sensor;
+}
+
+void LinuxSensorProviderRapl::updateSensor(SensorBean* sensor) {
+	ZoneSensor* tag = static_cast<ZoneSensor*>(sensor->mTag);
+	if (!tag->zone->update(tag->generation)) {
+		return;
+	}
+	if (tag->value == ZONE_ENERGY) {
+		sensor->setData(tag->zone->getEnergy());
+	} else {
+		double power;
+		if (tag->zone->getPower(power)) {
+			sensor->setData(power);
+		}
+	}
+}
+
+void LinuxSensorProviderRapl::destroySensor(SensorBean* sensor) {
+	ZoneSensor* tag = static_cast<ZoneSensor*>(sensor->mTag);
+	tag->zone->release();
+	delete tag;
+}
+
+string LinuxSensorProviderRapl::readString(const string& path) {
+	ProcFile file(path.c_str(), 64);
+	if (!file.read()) {
+		return "";
+	}
+	return string(file.data(), strcspn(file.data(), "\n"));
+}
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "RaplZone.h"
+
+RaplZone::RaplZone(const std::string& path, uint64_t maxEnergyRange) :
+	mFile(path.c_str(), 32), mMaxEnergyRange(maxEnergyRange), mLastCounter(0), mEnergy(0), mDelta(0),
+	mElapsed(0.0), mValid(false), mSamples(0), mGeneration(0), mRefCount(0) {
+	mLastTimestamp.tv_sec = 0;
+	mLastTimestamp.tv_nsec = 0;
+}
+
+bool RaplZone::isOpen(void) const {
+	return mFile.isOpen();
+}
+
+void RaplZone::acquire(void) {
+	mRefCount++;
+}
+
+void RaplZone::release(void) {
+	if (--mRefCount == 0) {
+		delete this;
+	}
+}
+
+bool RaplZone::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		read();
+	}
+	seenGeneration = mGeneration;
+	return mValid;
+}
+
+void RaplZone::read(void) {
+	mGeneration++;
+	mValid = false;
+	if (!mFile.read()) {
+		return;
+	}
+	const char* p = mFile.data();
+	uint64_t counter;
+	if (!procScanUint64(p, mFile.end(), counter)) {
+		return;
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	if (mSamples > 0) {
+		if (counter >= mLastCounter) {
+			mDelta = counter - mLastCounter;
+		} else {
+			// Counter wrapped at max_energy_range_uj
+			mDelta = counter + mMaxEnergyRange - mLastCounter;
+		}
+		mEnergy += mDelta;
+		mElapsed = (double)(now.tv_sec - mLastTimestamp.tv_sec) + (double)(now.tv_nsec - mLastTimestamp.tv_nsec) / 1e9;
+	}
+	mLastCounter = counter;
+	mLastTimestamp = now;
+	mSamples++;
+	mValid = true;
+}
+
+double RaplZone::getEnergy(void) const {
+	return (double)mEnergy / 1e6;
+}
+
+bool RaplZone::getPower(double& power) const {
+	if (!mValid || mSamples < 2 || mElapsed <= 0.0) {
+		return false;
+	}
+	power = (double)mDelta / 1e6 / mElapsed;
+	return true;
+}
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef RAPLZONE_H_
+#define RAPLZONE_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <ProcFile.h>
+
+// Energy counter of one powercap zone shared by its energy and power sensors.
+// The counter is read once per tick, like ProcStat.
+class RaplZone {
+public:
+	RaplZone(const std::string& path, uint64_t maxEnergyRange);
+
+	bool isOpen(void) const;
+	void acquire(void);
+	void release(void);
+
+	// Returns false if the counter could not be read
+	bool update(uint32_t& seenGeneration);
+
+	// Energy consumed since the first sample in J
+	double getEnergy(void) const;
+	// Average power since the last sample in W, false until two samples are available
+	bool getPower(double& power) const;
+
+private:
+	//lint -e(1704)
+	RaplZone(const RaplZone& cSource);
+	RaplZone& operator=(const RaplZone& cSource);
+
+	void read(void);
+
+	ProcFile mFile;
+	uint64_t mMaxEnergyRange;
+	uint64_t mLastCounter;
+	uint64_t mEnergy; // µJ, accumulated over wraparounds
+	uint64_t mDelta; // µJ
+	struct timespec mLastTimestamp;
+	double mElapsed; // s
+	bool mValid;
+	uint32_t mSamples;
+	uint32_t mGeneration;
+	int mRefCount;
+};
+
+#endif /* RAPLZONE_H_ */
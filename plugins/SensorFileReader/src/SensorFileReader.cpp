@@ -23,11 +23,10 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "SensorFileReader.h"
+#include "SharedFile.h"
 
 #include <cstring>
 #include <cstdlib>
-#include <iostream>
-#include <fstream>
 #include "daemon_msgs.h"
 
 using namespace std;
@@ -45,10 +44,23 @@ int32_t SensorFileReader::destroy(void * p) {
 	return 0;
 }
 
-SensorFileReader::SensorFileReader() : mPath(""), mDataType(TYPE_NONE), mUnit(UNIT_DIMENSIONLESS), mMultiplier(1.0) {
+#define MAX_STRING_SIZE		255
+#define DEFAULT_STRING_SIZE	32
+
+SensorFileReader::SensorFileReader() : mPath(""), mDataType(TYPE_NONE), mUnit(UNIT_DIMENSIONLESS), mMultiplier(1.0), mStringSize(0),
+		mExtraction(EXTRACT_START), mField(0), mKey(""), mRegexValid(false), mFile(NULL), mGeneration(0), mNotify(false), mCache(NULL), mCacheValid(false) {
 }
 
 SensorFileReader::~SensorFileReader() {
+#ifndef WIN32
+	if (mRegexValid) {
+		regfree(&mRegex);
+	}
+#endif
+	if (mFile != NULL) {
+		mFile->release();
+	}
+	free(mCache);
 }
 
 bool SensorFileReader::configure(const char* data) {
@@ -65,6 +77,22 @@ bool SensorFileReader::configure(const char* data) {
 		mDataType = TYPE_U8;
 	} else if (dataType == "U16") {
 		mDataType = TYPE_U16;
+	} else if (dataType == "U32") {
+		mDataType = TYPE_U32;
+	} else if (dataType == "U64") {
+		mDataType = TYPE_U64;
+	} else if (dataType == "string") {
+		mDataType = TYPE_STR;
+		mStringSize = DEFAULT_STRING_SIZE;
+		string size = getOption(options, "size");
+		if (size != "") {
+			int value = atoi(size.c_str());
+			if (value > 1 && value <= MAX_STRING_SIZE) {
+				mStringSize = value;
+			} else {
+				LOG_WARN(logger, "Invalid 'size' attribute '" << size << "', using " << DEFAULT_STRING_SIZE);
+			}
+		}
 	} else if (dataType == "double") {
 		mDataType = TYPE_FLOAT;
 
@@ -83,6 +111,41 @@ bool SensorFileReader::configure(const char* data) {
 		return false;
 	}
 
+	// Where in the file the value is, default is the beginning
+	string field = getOption(options, "field");
+	string key = getOption(options, "key");
+	string regex = getOption(options, "regex");
+	if (field != "") {
+		mField = atoi(field.c_str());
+		if (mField < 1) {
+			LOG_ERROR(logger, "Invalid 'field' attribute '" << field << "', fields are counted from 1");
+			return false;
+		}
+		mExtraction = EXTRACT_FIELD;
+	} else if (key != "") {
+		mKey = key;
+		mExtraction = EXTRACT_KEY;
+	} else if (regex != "") {
+#ifndef WIN32
+		int ret = regcomp(&mRegex, regex.c_str(), REG_EXTENDED | REG_NEWLINE);
+		if (ret != 0) {
+			char error[128];
+			regerror(ret, &mRegex, error, sizeof(error));
+			LOG_ERROR(logger, "Invalid 'regex' attribute '" << regex << "': " << error);
+			return false;
+		}
+		mRegexValid = true;
+		mExtraction = EXTRACT_REGEX;
+#else
+		LOG_ERROR(logger, "'regex' attribute is not supported on this platform");
+		return false;
+#endif
+	}
+
+	mNotify = getOption(options, "notify") == "true";
+	mFile = SharedFile::acquire(mPath, mNotify);
+	mCache = (uint8_t*)calloc(1, getMaxDataSize());
+
 	string unit = getOption(options, "unit");
 	if (unit == "C") {
 		mUnit = UNIT_TEMPERATURE;
@@ -99,71 +162,155 @@ size_t SensorFileReader::getMaxDataSize(void) {
 	switch (mDataType) {
 		case TYPE_U8: return 1;
 		case TYPE_U16: return 2;
+		case TYPE_U32: return 4;
+		case TYPE_U64: return 8;
 		case TYPE_FLOAT: return 8;
+		case TYPE_STR: return mStringSize;
 		default: return 0;
 	}
 }
 
-bool SensorFileReader::getData(uint8_t* data) {
-	string fileContent = "";
-
-	string line;
-	ifstream myfile(mPath.c_str());
-	bool first = true;
-	if (myfile.is_open()) {
-		while ( getline (myfile, line) ) {
-			if (first) {
-				fileContent += line;
-				first = false;
-			} else {
-				fileContent += "/n" + line;
+bool SensorFileReader::findValue(const char*& begin, const char*& end) {
+	const char* p = mFile->data();
+	const char* fileEnd = mFile->end();
+
+	if (mExtraction == EXTRACT_FIELD) {
+		// Whitespace separated, across lines
+		for (int i = 1; ; ++i) {
+			while (p < fileEnd && (*p == ' ' || *p == '\t' || *p == '\n')) {
+				++p;
 			}
+			if (p >= fileEnd) {
+				return false;
+			}
+			if (i == mField) {
+				break;
+			}
+			while (p < fileEnd && *p != ' ' && *p != '\t' && *p != '\n') {
+				++p;
+			}
+		}
+	} else if (mExtraction == EXTRACT_KEY) {
+		// "key value", "key: value" or "key=value", key at the start of a word
+		size_t keyLength = mKey.length();
+		while (true) {
+			p = strstr(p, mKey.c_str());
+			if (p == NULL) {
+				return false;
+			}
+			bool wordStart = p == mFile->data() || p[-1] == ' ' || p[-1] == '\t' || p[-1] == '\n';
+			char next = p[keyLength];
+			if (wordStart && (next == ' ' || next == '\t' || next == ':' || next == '=')) {
+				p += keyLength;
+				break;
+			}
+			p++;
+		}
+		while (p < fileEnd && (*p == ' ' || *p == '\t' || *p == ':' || *p == '=')) {
+			++p;
+		}
+	} else if (mExtraction == EXTRACT_REGEX) {
+#ifndef WIN32
+		regmatch_t match[2];
+		if (regexec(&mRegex, p, 2, match, 0) != 0) {
+			return false;
+		}
+		int group = match[1].rm_so >= 0 ? 1 : 0;
+		begin = p + match[group].rm_so;
+		end = p + match[group].rm_eo;
+		return true;
+#endif
+	}
+
+	begin = p;
+	end = p;
+	if (mDataType == TYPE_STR && mExtraction == EXTRACT_START) {
+		// Whole first line
+		while (end < fileEnd && *end != '\n') {
+			++end;
 		}
-		myfile.close();
 	} else {
-		LOG_ERROR(logger, "Could not read file '" << mPath << "'");
+		while (end < fileEnd && *end != ' ' && *end != '\t' && *end != '\n') {
+			++end;
+		}
+	}
+	return true;
+}
+
+bool SensorFileReader::getData(uint8_t* data) {
+	size_t size = getMaxDataSize();
+	if (mFile == NULL) {
+		return false;
+	}
+	if (!mFile->update(mGeneration)) {
+		// Unchanged since last read (notify=true) or read error
+		if (mNotify && mCacheValid) {
+			memcpy(data, mCache, size);
+			return true;
+		}
 		return false;
 	}
 
-	if (mDataType != TYPE_STR) {
-		std::istringstream i(fileContent);
+	const char* begin;
+	const char* end;
+	if (!findValue(begin, end)) {
+		LOG_WARN(logger, "Value not found in file '" << mPath << "'");
+		mCacheValid = false;
+		return false;
+	}
+	const char* p = begin;
 
-		if (mDataType == TYPE_U8) {
-			int value;
-			if ((i >> value)) {
-				data[0] = (uint8_t)(value & 0xff);
-				return true;
-			} else {
-				LOG_WARN(logger, "Could not parse file content as uint8_t");
-				return false;
-			}
-		} else if (mDataType == TYPE_U16) {
-			uint16_t value;
-			if ((i >> value)) {
-				data[0] = (value >> 8) & 0xff;
-				data[1] = value & 0xff;
-				return true;
-			} else {
-				LOG_WARN(logger, "Could not parse file content as uint16_t");
-				return false;
-			}
-		} else if (mDataType == TYPE_FLOAT) {
-			double value;
-			if ((i >> value)) {
-				value *= mMultiplier;
+	if (mDataType == TYPE_U8) {
+		int64_t value;
+		if (procScanInt64(p, end, value)) {
+			data[0] = (uint8_t)(value & 0xff);
+		} else {
+			LOG_WARN(logger, "Could not parse file content as uint8_t");
+			return false;
+		}
+	} else if (mDataType == TYPE_U16 || mDataType == TYPE_U32 || mDataType == TYPE_U64) {
+		uint64_t value;
+		if (!procScanUint64(p, end, value) || (size < 8 && value >> (size * 8) != 0)) {
+			LOG_WARN(logger, "Could not parse file content as " << size * 8 << " bit unsigned integer");
+			return false;
+		}
+		for (int i = size - 1; i >= 0; --i) { // Big endian
+			data[i] = value & 0xff;
+			value >>= 8;
+		}
+	} else if (mDataType == TYPE_FLOAT) {
+		// strtod must not read past the value, e.g. beyond a regex capture group
+		char buffer[64];
+		size_t length = end - begin;
+		char* parseEnd;
+		if (length < sizeof(buffer)) {
+			memcpy(buffer, begin, length);
+			buffer[length] = '\0';
+		} else {
+			buffer[0] = '\0';
+		}
+		double value = strtod(buffer, &parseEnd);
+		if (parseEnd != buffer) {
+			value *= mMultiplier;
 
-				double* pToDouble = &value;
-				char* bytes = reinterpret_cast<char*>(pToDouble);
-				memcpy(data, bytes, 8);
-				return true;
-			} else {
-				LOG_WARN(logger, "Could not parse file content as double");
-				return false;
-			}
+			double* pToDouble = &value;
+			char* bytes = reinterpret_cast<char*>(pToDouble);
+			memcpy(data, bytes, 8);
+		} else {
+			LOG_WARN(logger, "Could not parse file content as double");
+			return false;
 		}
+	} else if (mDataType == TYPE_STR) {
+		size_t length = min((size_t)(end - begin), size - 1);
+		memset(data, 0, size);
+		memcpy(data, begin, length);
+	} else {
+		return false;
 	}
 
-	return false;
+	memcpy(mCache, data, size);
+	mCacheValid = true;
+	return true;
 }
 
 const char* SensorFileReader::getDescription(void) {
@@ -30,8 +30,12 @@
 #include <string>
 #include <logger.h>
 #include <c_object_model.h>
+#ifndef WIN32
+#include <regex.h>
+#endif
 
 struct PF_ObjectParams;
+class SharedFile;
 
 class SensorFileReader: public BaseSensor {
 public:
@@ -54,12 +58,28 @@ public:
 	static LoggerPtr logger;
 
 private:
+	enum Extraction { EXTRACT_START, EXTRACT_FIELD, EXTRACT_KEY, EXTRACT_REGEX };
+
 	SensorFileReader();
+	bool findValue(const char*& begin, const char*& end);
 
 	string mPath;
 	ISensorDataType mDataType;
 	ISensorUnit mUnit;
 	double mMultiplier;
+	size_t mStringSize;
+	Extraction mExtraction;
+	int mField;
+	string mKey;
+#ifndef WIN32
+	regex_t mRegex;
+#endif
+	bool mRegexValid;
+	SharedFile* mFile;
+	uint32_t mGeneration;
+	bool mNotify;
+	uint8_t* mCache; // Last value in message encoding
+	bool mCacheValid;
 };
 
 #endif
@@ -0,0 +1,206 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "SharedFile.h"
+#include "SensorFileReader.h"
+
+#include <cstring>
+#include <errno.h>
+#ifndef WIN32
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#endif
+
+// Values in sysfs and small status files, longer content is truncated
+#define FILE_BUFFER_SIZE	4096
+#define INOTIFY_MASK		(IN_MODIFY | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF)
+// Seconds between checks whether a regular file was replaced by rename
+#define INODE_CHECK_INTERVAL	5
+
+map<string, SharedFile*> SharedFile::sFiles;
+
+SharedFile* SharedFile::acquire(const string& path, bool notify) {
+	SharedFile* file;
+	map<string, SharedFile*>::iterator iterator = sFiles.find(path);
+	if (iterator != sFiles.end()) {
+		file = iterator->second;
+		if (notify != (file->mNotifyMode != NOTIFY_NONE)) {
+			LOG_WARN(SensorFileReader::logger, "File '" << path << "' is configured with different 'notify' options, using the first one");
+		}
+	} else {
+		file = new SharedFile(path, notify);
+		sFiles[path] = file;
+	}
+	file->mRefCount++;
+	return file;
+}
+
+void SharedFile::release(void) {
+	if (--mRefCount == 0) {
+		sFiles.erase(mPath);
+		delete this;
+	}
+}
+
+SharedFile::SharedFile(const string& path, bool notify) :
+	mPath(path), mFile(NULL), mNotifyMode(NOTIFY_NONE), mInotifyFd(-1), mGeneration(0), mRefCount(0) {
+	// procfs and sysfs entries are never replaced, other files might be written by rename
+	bool pseudoFile = mPath.compare(0, 6, "/proc/") == 0 || mPath.compare(0, 5, "/sys/") == 0;
+	mCheckInode = !pseudoFile;
+	mInode = 0;
+	mLastInodeCheck = 0;
+	reopen();
+	if (!mFile->isOpen()) {
+		// Keep going, the file might appear later
+		LOG_WARN(SensorFileReader::logger, "Could not open file '" << mPath << "'");
+	}
+
+	if (notify) {
+#ifndef WIN32
+		if (mPath.compare(0, 6, "/proc/") == 0) {
+			// procfs neither wakes up pollers nor generates inotify events
+			LOG_WARN(SensorFileReader::logger, "'notify' is not supported for file '" << mPath << "', reading it on every update");
+		} else if (mPath.compare(0, 5, "/sys/") == 0) {
+			// sysfs attributes that support it wake up pollers with POLLPRI when the value changes
+			mNotifyMode = NOTIFY_POLLPRI;
+		} else {
+			mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (mInotifyFd >= 0 && inotify_add_watch(mInotifyFd, mPath.c_str(), INOTIFY_MASK) >= 0) {
+				mNotifyMode = NOTIFY_INOTIFY;
+				mCheckInode = false; // inotify reports the rename
+			} else {
+				LOG_WARN(SensorFileReader::logger, "Could not watch file '" << mPath << "' (" << strerror(errno) << "), reading it on every update");
+			}
+		}
+#else
+		LOG_WARN(SensorFileReader::logger, "'notify' is not supported on this platform, reading file on every update");
+#endif
+	}
+}
+
+SharedFile::~SharedFile() {
+#ifndef WIN32
+	if (mInotifyFd >= 0) {
+		close(mInotifyFd);
+	}
+#endif
+	delete mFile;
+}
+
+bool SharedFile::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		// Initial read happens regardless of notifications
+		if (mGeneration != 0 && !hasChanged()) {
+			return false;
+		}
+		if (!mFile->isOpen() || isReplaced()) {
+			reopen();
+		}
+		if (!mFile->read()) {
+			// Device or process behind the file went away (ENODEV, ESRCH), try the path again
+			reopen();
+			if (!mFile->read()) {
+				LOG_ERROR(SensorFileReader::logger, "Could not read file '" << mPath << "'");
+				return false;
+			}
+		}
+		mGeneration++;
+	}
+	seenGeneration = mGeneration;
+	return true;
+}
+
+const char* SharedFile::data(void) const {
+	return mFile->data();
+}
+
+const char* SharedFile::end(void) const {
+	return mFile->end();
+}
+
+const string& SharedFile::getPath(void) const {
+	return mPath;
+}
+
+bool SharedFile::hasChanged(void) {
+#ifndef WIN32
+	if (mNotifyMode == NOTIFY_POLLPRI) {
+		struct pollfd pfd;
+		pfd.fd = mFile->getFd();
+		pfd.events = POLLPRI;
+		pfd.revents = 0;
+		return poll(&pfd, 1, 0) != 0;
+	} else if (mNotifyMode == NOTIFY_INOTIFY) {
+		char buffer[sizeof(struct inotify_event) * 8] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+		bool changed = false;
+		bool replaced = false;
+		ssize_t length;
+		while ((length = read(mInotifyFd, buffer, sizeof(buffer))) > 0) {
+			changed = true;
+			for (char* p = buffer; p < buffer + length; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len) {
+				if (((struct inotify_event*)p)->mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) {
+					replaced = true;
+				}
+			}
+		}
+		if (replaced) {
+			// Written by rename or recreated, follow the path
+			reopen();
+			inotify_add_watch(mInotifyFd, mPath.c_str(), INOTIFY_MASK);
+		}
+		return changed;
+	}
+#endif
+	return true;
+}
+
+bool SharedFile::isReplaced(void) {
+#ifndef WIN32
+	if (!mCheckInode) {
+		return false;
+	}
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	if (mLastInodeCheck != 0 && now.tv_sec - mLastInodeCheck < INODE_CHECK_INTERVAL) {
+		return false;
+	}
+	mLastInodeCheck = now.tv_sec;
+	struct stat st;
+	return stat(mPath.c_str(), &st) == 0 && st.st_ino != mInode;
+#else
+	return false;
+#endif
+}
+
+void SharedFile::reopen(void) {
+	delete mFile;
+	mFile = new ProcFile(mPath.c_str(), FILE_BUFFER_SIZE);
+#ifndef WIN32
+	struct stat st;
+	if (mFile->isOpen() && fstat(mFile->getFd(), &st) == 0) {
+		mInode = st.st_ino;
+	}
+#endif
+}
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SHAREDFILE_H_
+#define SHAREDFILE_H_
+
+#include <string>
+#include <map>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#include <ProcFile.h>
+
+using namespace std;
+
+// File read by one or more SensorFileReader instances. All readers of the
+// same path share one fd and one buffer, the file is read at most once per
+// update: the first reader that already parsed the current content
+// triggers the next read. With change notification, the file is only read
+// again after the kernel reported a change.
+class SharedFile {
+public:
+	static SharedFile* acquire(const string& path, bool notify);
+	void release(void);
+
+	// Returns true if content was read since the caller last looked at it
+	bool update(uint32_t& seenGeneration);
+
+	const char* data(void) const;
+	const char* end(void) const;
+	const string& getPath(void) const;
+
+private:
+	enum NotifyMode { NOTIFY_NONE, NOTIFY_POLLPRI, NOTIFY_INOTIFY };
+
+	SharedFile(const string& path, bool notify);
+	~SharedFile();
+	//lint -e(1704)
+	SharedFile(const SharedFile& cSource);
+	SharedFile& operator=(const SharedFile& cSource);
+
+	bool hasChanged(void);
+	bool isReplaced(void);
+	void reopen(void);
+
+	string mPath;
+	ProcFile* mFile;
+	NotifyMode mNotifyMode;
+	int mInotifyFd;
+	bool mCheckInode;
+	ino_t mInode;
+	time_t mLastInodeCheck;
+	uint32_t mGeneration;
+	int mRefCount;
+
+	static map<string, SharedFile*> sFiles;
+};
+
+#endif /* SHAREDFILE_H_ */
@@ -85,7 +85,7 @@ SensorProviderJetson::SensorProviderJetson() :
 
 		sensor = new SensorBean("Power DDR", TYPE_FLOAT, 8, 1, UNIT_POWER, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
 		sensor->setData((uint32_t)0);
-		sensor->setUpdateCallback(&SensorProviderJetson::updatePowerSoC);
+		sensor->setUpdateCallback(&SensorProviderJetson::updatePowerDDR);
 		mSensors["Power DDR"] = sensor;
 
 		sensor = new SensorBean("Power SYS5V", TYPE_FLOAT, 8, 1, UNIT_POWER, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WIN32
+
+#include "ProcStat.h"
+
+// intr line alone can be tens of kB on large systems, ctxt and processes follow it
+#define PROC_STAT_BUFFER_SIZE	(256 * 1024)
+
+ProcStat::ProcStat(size_t cpuCount) :
+	mFile("/proc/stat", PROC_STAT_BUFFER_SIZE), mCpuCount(cpuCount), mCurrent(0), mGeneration(0), mRefCount(0) {
+	for (int i = 0; i < 2; ++i) {
+		mSnapshots[i].times.resize((cpuCount + 1) * FIELD_COUNT, 0);
+		mSnapshots[i].valid.resize(cpuCount + 1, false);
+		mSnapshots[i].contextSwitches = 0;
+		mSnapshots[i].forks = 0;
+		mSnapshots[i].timestamp.tv_sec = 0;
+		mSnapshots[i].timestamp.tv_nsec = 0;
+	}
+}
+
+void ProcStat::acquire(void) {
+	mRefCount++;
+}
+
+void ProcStat::release(void) {
+	if (--mRefCount == 0) {
+		delete this;
+	}
+}
+
+bool ProcStat::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		read();
+	}
+	seenGeneration = mGeneration;
+	return mGeneration >= 2;
+}
+
+size_t ProcStat::getCpuCount(void) const {
+	return mCpuCount;
+}
+
+void ProcStat::read(void) {
+	mCurrent ^= 1;
+	mGeneration++;
+	Snapshot& snapshot = mSnapshots[mCurrent];
+	clock_gettime(CLOCK_MONOTONIC, &snapshot.timestamp);
+	snapshot.valid.assign(mCpuCount + 1, false);
+	snapshot.contextSwitches = 0;
+	snapshot.forks = 0;
+
+	if (!mFile.read()) {
+		return;
+	}
+	const char* p = mFile.data();
+	const char* end = mFile.end();
+	while (p < end) {
+		if (end - p > 3 && p[0] == 'c' && p[1] == 'p' && p[2] == 'u') {
+			p += 3;
+			size_t index = 0;
+			uint64_t cpu;
+			if (*p != ' ') {
+				if (!procScanUint64(p, end, cpu) || cpu >= mCpuCount) {
+					procNextLine(p, end);
+					continue;
+				}
+				index = cpu + 1;
+			}
+			uint64_t* times = &snapshot.times[index * FIELD_COUNT];
+			for (int i = 0; i < FIELD_COUNT; ++i) {
+				if (!procScanUint64(p, end, times[i])) {
+					times[i] = 0; // Older kernels have less fields
+				}
+			}
+			snapshot.valid[index] = true;
+		} else if (end - p > 5 && memcmp(p, "ctxt ", 5) == 0) {
+			p += 5;
+			procScanUint64(p, end, snapshot.contextSwitches);
+		} else if (end - p > 10 && memcmp(p, "processes ", 10) == 0) {
+			p += 10;
+			procScanUint64(p, end, snapshot.forks);
+		}
+		procNextLine(p, end);
+	}
+}
+
+bool ProcStat::getCpuDelta(size_t index, uint64_t* delta, uint64_t& total) const {
+	const Snapshot& current = mSnapshots[mCurrent];
+	const Snapshot& last = mSnapshots[mCurrent ^ 1];
+	if (index > mCpuCount || !current.valid[index] || !last.valid[index]) {
+		return false;
+	}
+	total = 0;
+	for (int i = 0; i < FIELD_COUNT; ++i) {
+		uint64_t now = current.times[index * FIELD_COUNT + i];
+		uint64_t before = last.times[index * FIELD_COUNT + i];
+		// Counters of a cpu that went offline and came back may restart
+		delta[i] = now >= before ? now - before : 0;
+		total += delta[i];
+	}
+	return total > 0;
+}
+
+double ProcStat::getElapsed(void) const {
+	const struct timespec& now = mSnapshots[mCurrent].timestamp;
+	const struct timespec& before = mSnapshots[mCurrent ^ 1].timestamp;
+	return (double)(now.tv_sec - before.tv_sec) + (double)(now.tv_nsec - before.tv_nsec) / 1e9;
+}
+
+double ProcStat::getContextSwitchRate(void) const {
+	double elapsed = getElapsed();
+	uint64_t now = mSnapshots[mCurrent].contextSwitches;
+	uint64_t before = mSnapshots[mCurrent ^ 1].contextSwitches;
+	if (elapsed <= 0.0 || now < before) {
+		return 0.0;
+	}
+	return (double)(now - before) / elapsed;
+}
+
+double ProcStat::getForkRate(void) const {
+	double elapsed = getElapsed();
+	uint64_t now = mSnapshots[mCurrent].forks;
+	uint64_t before = mSnapshots[mCurrent ^ 1].forks;
+	if (elapsed <= 0.0 || now < before) {
+		return 0.0;
+	}
+	return (double)(now - before) / elapsed;
+}
+
+#endif /* WIN32 */
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROCSTAT_H_
+#define PROCSTAT_H_
+
+#ifndef WIN32
+
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+#include <ProcFile.h>
+
+// Snapshot of /proc/stat shared by all sensors derived from it. The file is
+// read once per tick: the first sensor that already consumed the current
+// snapshot triggers the next read, all others reuse it.
+class ProcStat {
+public:
+	enum Field { USER, NICE, SYSTEM, IDLE, IOWAIT, IRQ, SOFTIRQ, STEAL, FIELD_COUNT };
+
+	// Index 0 is the aggregate "cpu" line, index n + 1 is "cpu<n>"
+	ProcStat(size_t cpuCount);
+
+	void acquire(void);
+	void release(void);
+
+	// Returns false until two snapshots are available
+	bool update(uint32_t& seenGeneration);
+
+	size_t getCpuCount(void) const;
+	// Deltas since the last snapshot, false if the cpu is offline or nothing elapsed
+	bool getCpuDelta(size_t index, uint64_t* delta, uint64_t& total) const;
+	double getContextSwitchRate(void) const;
+	double getForkRate(void) const;
+
+private:
+	//lint -e(1704)
+	ProcStat(const ProcStat& cSource);
+	ProcStat& operator=(const ProcStat& cSource);
+
+	struct Snapshot {
+		std::vector<uint64_t> times; // FIELD_COUNT values per cpu
+		std::vector<bool> valid;
+		uint64_t contextSwitches;
+		uint64_t forks;
+		struct timespec timestamp;
+	};
+
+	void read(void);
+	double getElapsed(void) const;
+
+	ProcFile mFile;
+	size_t mCpuCount;
+	Snapshot mSnapshots[2];
+	int mCurrent;
+	uint32_t mGeneration;
+	int mRefCount;
+};
+
+#endif /* WIN32 */
+
+#endif /* PROCSTAT_H_ */
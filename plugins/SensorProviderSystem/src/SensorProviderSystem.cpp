@@ -26,8 +26,7 @@
 
 #include <cstring>
 #include <cstdlib>
-#include <iostream>
-#include <fstream>
+#include <sstream>
 #include <stdio.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -35,6 +34,8 @@
 #include <SensorBean.h>
 #include <fcntl.h>
 #ifndef WIN32
+#include <ProcFile.h>
+#include "ProcStat.h"
 #include <sys/mman.h>
 #include <errno.h>
 #include <sys/ioctl.h>
@@ -48,8 +49,7 @@
 using namespace std;
 
 LoggerPtr SensorProviderSystem::logger;
-uint64_t SensorProviderSystem::mLastTotalTime = 0;
-uint64_t SensorProviderSystem::mLastWorkTime = 0;
+IConfig* SensorProviderSystem::config;
 
 void * SensorProviderSystem::create(PF_ObjectParams *) {
 	return new SensorProviderSystem();
@@ -64,14 +64,42 @@ int32_t SensorProviderSystem::destroy(void * p) {
 
 SensorProviderSystem::SensorProviderSystem() :
 	mSensors() {
+#ifdef WIN32
 	SensorBean* sensor = new SensorBean("CPU", TYPE_FLOAT, 8, 1, UNIT_PERCENT, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
 	sensor->setData((uint32_t)0);
 	sensor->setUpdateCallback(&SensorProviderSystem::updateCpuUtilization);
+	sensor->mTag = new CpuTimes();
+	sensor->setDestroyCallback(&SensorProviderSystem::destroyCpuSensor);
 	mSensors["CPU"] = sensor;
+#else
+	long cpuCount = sysconf(_SC_NPROCESSORS_CONF);
+	ProcStat* stat = new ProcStat(cpuCount > 0 ? (size_t)cpuCount : 1);
+	addStatSensor(stat, "CPU", UNIT_PERCENT, STAT_UTILIZATION, 0);
+	if (config->GetBoolean("Plugins", "systemExtendedCpu", false)) {
+		addStatSensor(stat, "CPU iowait", UNIT_PERCENT, STAT_IOWAIT, 0);
+		addStatSensor(stat, "CPU steal", UNIT_PERCENT, STAT_STEAL, 0);
+		addStatSensor(stat, "CPU irq", UNIT_PERCENT, STAT_IRQ, 0);
+		addStatSensor(stat, "Context switches", UNIT_DIMENSIONLESS, STAT_CONTEXT_SWITCHES, 0);
+		addStatSensor(stat, "Forks", UNIT_DIMENSIONLESS, STAT_FORKS, 0);
+	}
+	if (config->GetBoolean("Plugins", "systemPerCpuUtilization", false)) {
+		for (size_t i = 0; i < stat->getCpuCount(); ++i) {
+			std::ostringstream name;
+			name << "CPU" << i;
+			addStatSensor(stat, name.str(), UNIT_PERCENT, STAT_UTILIZATION, i + 1);
+		}
+	}
+
+	SensorBean* sensor;
+#endif
 
 	sensor = new SensorBean("Memory free", TYPE_U64, 8, 1, UNIT_BYTE, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
 	sensor->setData((uint64_t)0);
 	sensor->setUpdateCallback(&SensorProviderSystem::updateMemoryFree);
+#ifndef WIN32
+	sensor->mTag = new ProcFile("/proc/meminfo");
+	sensor->setDestroyCallback(&SensorProviderSystem::destroySensor);
+#endif
 	mSensors["Memory free"] = sensor;
 
 	sensor = new SensorBean("System disk free", TYPE_U64, 8, 1, UNIT_BYTE, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
@@ -97,67 +125,94 @@ uint64_t SensorProviderSystem::filetimeToUint64(const FILETIME &v) {
 }
 #endif
 
-void SensorProviderSystem::updateCpuUtilization(SensorBean* sensor) {
-	uint64_t totalTime = 0;
-	uint64_t workTime = 0;
-
 #ifdef WIN32
+void SensorProviderSystem::updateCpuUtilization(SensorBean* sensor) {
+	CpuTimes* last = static_cast<CpuTimes*>(sensor->mTag);
 	FILETIME idleTime;
 	FILETIME kernelTime;
 	FILETIME userTime;
 	GetSystemTimes(&idleTime, &kernelTime, &userTime);
 
-	totalTime = filetimeToUint64(kernelTime) + filetimeToUint64(userTime); // kernel includes idle
-	workTime = totalTime - filetimeToUint64(idleTime);
-#else
-	string line;
-
-	ifstream myfile("/proc/stat");
-	if (myfile.is_open()) {
-		getline(myfile, line);
-		std::istringstream stream(line);
-
-		// Skip "cpu"
-		stream.ignore(3, ' ');
-
-		for (uint8_t i = 0; i < 10; ++i) {
-			uint64_t n;
-			stream >> n;
-			if (!stream) {
-				break;
-			}
-
-			// Sum up work- and total jiffies spent. First 3 are user, nice and system
-			if (i < 3) {
-				workTime += n;
-			}
-			totalTime += n;
-		}
-		myfile.close();
-	} else {
-		LOG_ERROR(logger, "Could not read file '/proc/stat'");
-		return;
-	}
-#endif
+	uint64_t totalTime = filetimeToUint64(kernelTime) + filetimeToUint64(userTime); // kernel includes idle
+	uint64_t workTime = totalTime - filetimeToUint64(idleTime);
+
 	// On first update only get current time and values
-	if (mLastTotalTime == 0) {
-		mLastTotalTime = totalTime;
-		mLastWorkTime = workTime;
-		return;
+	if (last->totalTime != 0) {
+		double work_over_period = workTime - last->workTime;
+		double total_over_period = totalTime - last->totalTime;
+
+		sensor->setData((work_over_period / total_over_period) * 100.0);
 	}
 
-    double work_over_period = workTime - mLastWorkTime;
-    double total_over_period = totalTime - mLastTotalTime;
+	last->totalTime = totalTime;
+	last->workTime = workTime;
+}
 
-    double utilization = (work_over_period / total_over_period) * 100.0;
+void SensorProviderSystem::destroyCpuSensor(SensorBean* sensor) {
+	delete static_cast<CpuTimes*>(sensor->mTag);
+}
+#else
+void SensorProviderSystem::addStatSensor(ProcStat* stat, const string& name, ISensorUnit unit, StatKind kind, size_t index) {
+	SensorBean* sensor = new SensorBean(name, TYPE_FLOAT, 8, 1, unit, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData(0.0);
+	StatSensor* tag = new StatSensor();
+	tag->stat = stat;
+	tag->kind = kind;
+	tag->index = index;
+	tag->generation = 0;
+	stat->acquire();
+	sensor->mTag = tag;
+	sensor->setUpdateCallback(&SensorProviderSystem::updateStatSensor);
+	sensor->setDestroyCallback(&SensorProviderSystem::destroyStatSensor);
+	mSensors[name] = sensor;
+}
 
-	//LOG_DEBUG(logger, "CPU: " << utilization << " %");
+void SensorProviderSystem::updateStatSensor(SensorBean* sensor) {
+	StatSensor* tag = static_cast<StatSensor*>(sensor->mTag);
+	// On first update only get current values
+	if (!tag->stat->update(tag->generation)) {
+		return;
+	}
 
-	sensor->setData(utilization);
+	if (tag->kind == STAT_CONTEXT_SWITCHES) {
+		sensor->setData(tag->stat->getContextSwitchRate());
+		return;
+	} else if (tag->kind == STAT_FORKS) {
+		sensor->setData(tag->stat->getForkRate());
+		return;
+	}
+
+	uint64_t delta[ProcStat::FIELD_COUNT];
+	uint64_t total;
+	if (!tag->stat->getCpuDelta(tag->index, delta, total)) {
+		return;
+	}
+	uint64_t part = 0;
+	switch (tag->kind) {
+		case STAT_UTILIZATION:
+			part = delta[ProcStat::USER] + delta[ProcStat::NICE] + delta[ProcStat::SYSTEM];
+			break;
+		case STAT_IOWAIT:
+			part = delta[ProcStat::IOWAIT];
+			break;
+		case STAT_STEAL:
+			part = delta[ProcStat::STEAL];
+			break;
+		case STAT_IRQ:
+			part = delta[ProcStat::IRQ] + delta[ProcStat::SOFTIRQ];
+			break;
+		default:
+			break;
+	}
+	sensor->setData((double)part / (double)total * 100.0);
+}
 
-	mLastTotalTime = totalTime;
-	mLastWorkTime = workTime;
+void SensorProviderSystem::destroyStatSensor(SensorBean* sensor) {
+	StatSensor* tag = static_cast<StatSensor*>(sensor->mTag);
+	tag->stat->release();
+	delete tag;
 }
+#endif
 
 void SensorProviderSystem::updateMemoryFree(SensorBean* sensor) {
 	uint64_t freeMem;
@@ -168,25 +223,16 @@ void SensorProviderSystem::updateMemoryFree(SensorBean* sensor) {
 	  GlobalMemoryStatusEx(&statex);
 	  freeMem = statex.ullAvailPhys;
 #else
-	string line;
-
-	ifstream myfile("/proc/meminfo");
-	if (myfile.is_open()) {
-		while (getline(myfile, line)) {
-			std::istringstream stream(line);
-
-			string prefix;
-			stream >> prefix;
-
-			if (prefix == "MemAvailable:") {
-				stream >> freeMem;
-			}
-		}
-		myfile.close();
-	} else {
+	ProcFile* file = static_cast<ProcFile*>(sensor->mTag);
+	if (!file->read()) {
 		LOG_ERROR(logger, "Could not read file '/proc/meminfo'");
 		return;
 	}
+	const char* p = file->data();
+	if (!procFindLine(p, file->end(), "MemAvailable:") || !procScanUint64(p, file->end(), freeMem)) {
+		LOG_ERROR(logger, "No MemAvailable in '/proc/meminfo'");
+		return;
+	}
 
 	freeMem *= 1024;
 #endif
@@ -195,6 +241,12 @@ void SensorProviderSystem::updateMemoryFree(SensorBean* sensor) {
 	sensor->setData(freeMem);
 }
 
+#ifndef WIN32
+void SensorProviderSystem::destroySensor(SensorBean* sensor) {
+	delete static_cast<ProcFile*>(sensor->mTag);
+}
+#endif
+
 void SensorProviderSystem::updateDiskFree(SensorBean* sensor) {
 	uint64_t freeDisk;
 #ifdef WIN32
@@ -35,8 +35,12 @@
 #include <logger.h>
 #include <c_object_model.h>
 #include <SensorBean.h>
+#include <IConfig.h>
 
 struct PF_ObjectParams;
+#ifndef WIN32
+class ProcStat;
+#endif
 
 class SensorProviderSystem: public ISensorProvider {
 public:
@@ -49,19 +53,37 @@ public:
 	virtual std::map<std::string, ISensor*> getSensors(void);
 
 	static LoggerPtr logger;
+	static IConfig* config;
 private:
 	SensorProviderSystem();
-	static void updateCpuUtilization(SensorBean* sensor);
 	static void updateMemoryFree(SensorBean* sensor);
 	static void updateDiskFree(SensorBean* sensor);
-#ifdef WIN32
+#ifndef WIN32
+	enum StatKind { STAT_UTILIZATION, STAT_IOWAIT, STAT_STEAL, STAT_IRQ, STAT_CONTEXT_SWITCHES, STAT_FORKS };
+	struct StatSensor {
+		ProcStat* stat;
+		StatKind kind;
+		size_t index; // 0: all cpus, n + 1: cpu n
+		uint32_t generation;
+	};
+
+	void addStatSensor(ProcStat* stat, const std::string& name, ISensorUnit unit, StatKind kind, size_t index);
+	static void updateStatSensor(SensorBean* sensor);
+	static void destroyStatSensor(SensorBean* sensor);
+	static void destroySensor(SensorBean* sensor);
+#else
+	struct CpuTimes {
+		CpuTimes() : totalTime(0), workTime(0) {}
+		uint64_t totalTime;
+		uint64_t workTime;
+	};
+
+	static void updateCpuUtilization(SensorBean* sensor);
+	static void destroyCpuSensor(SensorBean* sensor);
 	static uint64_t filetimeToUint64(const FILETIME &v);
 #endif
 
-
 	std::map<std::string, ISensor*> mSensors;
-	static uint64_t mLastTotalTime;
-	static uint64_t mLastWorkTime;
 };
 
 #endif
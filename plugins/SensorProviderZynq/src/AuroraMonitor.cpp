@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "AuroraMonitor.h"
+#include "RegisterMapping.h"
+
+#include <string.h>
+#include <sstream>
+
+AuroraMonitor::AuroraMonitor(RegisterMapping* mapping) :
+	mMapping(mapping), mValid(false), mGeneration(0), mRefCount(1) {
+	memset(mRegisters, 0, sizeof(mRegisters));
+}
+
+AuroraMonitor::~AuroraMonitor() {
+	delete mMapping;
+}
+
+void AuroraMonitor::acquire(void) {
+	mRefCount++;
+}
+
+void AuroraMonitor::release(void) {
+	if (--mRefCount == 0) {
+		delete this;
+	}
+}
+
+bool AuroraMonitor::update(uint32_t& seenGeneration) {
+	if (seenGeneration == mGeneration) {
+		mValid = mMapping->read(mRegisters, REGISTER_COUNT);
+		mGeneration++;
+	}
+	seenGeneration = mGeneration;
+	return mValid;
+}
+
+uint32_t AuroraMonitor::getRegister(Register reg) const {
+	return mRegisters[reg];
+}
+
+std::string AuroraMonitor::getLinkStatus(void) const {
+	uint32_t status = mRegisters[STATUS];
+	std::stringstream ss;
+	uint8_t channel = (status & 0x20) >> 5;
+	if (channel == 1) {
+		ss << "Channel up";
+	} else {
+		uint8_t lanes_avail = (status & 0xff000000) >> 24;
+		uint8_t lanes = (status & 0xff0000) >> 16;
+		if (lanes == lanes_avail) {
+			ss << "Channel down (all lanes up)";
+		} else if (lanes == 0x0) {
+			ss << "Channel down (all lanes down)";
+		} else {
+			ss << "Channel down (lanes "; // 20 + 19 + 4 = 43 characters max.
+			uint8_t first = 1;
+			for (uint8_t i = 0; i < 8; ++i) {
+				if ((lanes_avail & (1 << i)) && (lanes & (1 << i))) {
+					if (!first) {
+						ss << ", ";
+					}
+					ss << (i + 1);
+					first = 0;
+				}
+			}
+			ss << " up)";
+		}
+	}
+	uint8_t hard_err = (status & 0x10) >> 4;
+	if (hard_err) {
+		ss << ", HardErr"; // 9 characters max.
+	}
+	uint8_t pll_not_locked = (status & 0x8) >> 3;
+	if (pll_not_locked) {
+		ss << ", PLL not locked"; // 16 characters max.
+	}
+	ss << " (0x" << std::hex << status << ")"; // 5 + 8 = 13 characters max.
+	return ss.str();
+}
+
+uint32_t AuroraMonitor::getUtilization(void) const {
+	double utilization = (double)mRegisters[BUS_UTILIZATION] / (double)(1ULL << mRegisters[DATA_WIDTH]);
+	return (uint32_t)(utilization * 100.0);
+}
+
+uint64_t AuroraMonitor::getBandwidth(void) const {
+	return (uint64_t)mRegisters[BUS_FREQUENCY] * (uint64_t)mRegisters[BUS_WIDTH] / 8; // /8 because of byte/s, not bit/s
+}
@@ -0,0 +1,77 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef AURORAMONITOR_H_
+#define AURORAMONITOR_H_
+
+#include <stdint.h>
+#include <string>
+
+class RegisterMapping;
+
+// Register snapshot of one Aurora monitor shared by all of its sensors. The
+// whole register block is read once per tick: the first sensor that already
+// consumed the current snapshot triggers the next read, all others reuse it.
+class AuroraMonitor {
+public:
+	enum Register {
+		BUS_UTILIZATION,	// 0x00
+		DATA_WIDTH,			// 0x04
+		STATUS,				// 0x08
+		SOFT_ERROR_COUNT,	// 0x0C
+		FRAME_ERROR_COUNT,	// 0x10
+		BUS_FREQUENCY,		// 0x14
+		BUS_WIDTH,			// 0x18
+		REGISTER_COUNT
+	};
+
+	// Takes ownership of mapping
+	explicit AuroraMonitor(RegisterMapping* mapping);
+
+	void acquire(void);
+	void release(void);
+
+	// Returns false if the registers could not be read
+	bool update(uint32_t& seenGeneration);
+
+	uint32_t getRegister(Register reg) const;
+
+	std::string getLinkStatus(void) const;
+	uint32_t getUtilization(void) const; // %
+	uint64_t getBandwidth(void) const; // Byte/s
+
+private:
+	//lint -e(1704)
+	AuroraMonitor(const AuroraMonitor& cSource);
+	AuroraMonitor& operator=(const AuroraMonitor& cSource);
+	~AuroraMonitor();
+
+	RegisterMapping* mMapping;
+	uint32_t mRegisters[REGISTER_COUNT];
+	bool mValid;
+	uint32_t mGeneration;
+	int mRefCount;
+};
+
+#endif /* AURORAMONITOR_H_ */
@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#include "RegisterMapping.h"
+#include "SensorProviderZynq.h"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+DevMemMapping::DevMemMapping(uint64_t baseAddress, size_t size) :
+	mBaseAddress(baseAddress), mSize(size), mMemory(NULL), mPageOffset(0), mErrorLogged(false) {
+}
+
+DevMemMapping::~DevMemMapping() {
+	if (mMemory != NULL) {
+		munmap(mMemory, mPageOffset + mSize);
+	}
+}
+
+bool DevMemMapping::read(uint32_t* registers, size_t count) {
+	if (mMemory == NULL && !map()) {
+		return false;
+	}
+	if (count * sizeof(uint32_t) > mSize) {
+		count = mSize / sizeof(uint32_t);
+	}
+	// Single 32 bit loads, the block is device memory
+	volatile uint32_t* source = (volatile uint32_t*)(mMemory + mPageOffset);
+	for (size_t i = 0; i < count; ++i) {
+		registers[i] = source[i];
+	}
+	return true;
+}
+
+bool DevMemMapping::map(void) {
+	// Truncate offset to a multiple of the page size, or mmap will fail.
+	size_t pagesize = sysconf(_SC_PAGE_SIZE);
+	off_t page_base = (mBaseAddress / pagesize) * pagesize;
+	mPageOffset = mBaseAddress - page_base;
+
+	int fd = open("/dev/mem", O_RDONLY | O_SYNC | O_CLOEXEC);
+	if (fd < 0) {
+		if (!mErrorLogged) {
+			LOG_ERROR(SensorProviderZynq::logger, "Could not open /dev/mem: " << strerror(errno));
+			mErrorLogged = true;
+		}
+		return false;
+	}
+	void* memory = mmap(NULL, mPageOffset + mSize, PROT_READ, MAP_SHARED, fd, page_base);
+	int error = errno;
+	// The mapping stays valid without the descriptor
+	close(fd);
+	if (memory == MAP_FAILED) {
+		if (!mErrorLogged) {
+			LOG_ERROR(SensorProviderZynq::logger, "Could not mmap memory address 0x" << hex << mBaseAddress << " (page 0x" << page_base << dec << "): " << strerror(error));
+			mErrorLogged = true;
+		}
+		return false;
+	}
+	mMemory = (uint8_t*)memory;
+	return true;
+}
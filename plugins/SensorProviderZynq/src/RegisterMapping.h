@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2017 christmann informationstechnik + medien GmbH & Co. KG
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+// Author: Stefan Krupop <stefan.krupop@christmann.info>
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef REGISTERMAPPING_H_
+#define REGISTERMAPPING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+// Access to the register block of one Aurora monitor
+class RegisterMapping {
+public:
+	virtual ~RegisterMapping() {}
+
+	// Copies count 32 bit registers starting at the base address, false if
+	// the registers are not accessible (yet)
+	virtual bool read(uint32_t* registers, size_t count) = 0;
+};
+
+// Registers mapped from physical memory through /dev/mem. Mapping is retried
+// on every read until it succeeds.
+class DevMemMapping: public RegisterMapping {
+public:
+	DevMemMapping(uint64_t baseAddress, size_t size);
+	virtual ~DevMemMapping();
+
+	virtual bool read(uint32_t* registers, size_t count);
+
+private:
+	//lint -e(1704)
+	DevMemMapping(const DevMemMapping& cSource);
+	DevMemMapping& operator=(const DevMemMapping& cSource);
+
+	bool map(void);
+
+	uint64_t mBaseAddress;
+	size_t mSize;
+	uint8_t* mMemory;
+	off_t mPageOffset;
+	bool mErrorLogged;
+};
+
+#endif /* REGISTERMAPPING_H_ */
@@ -23,40 +23,23 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "SensorProviderZynq.h"
+#include "AuroraMonitor.h"
+#include "RegisterMapping.h"
 
 #include <cstring>
 #include <cstdlib>
-#include <iostream>
-#include <fstream>
-#include <stdio.h>
-#include <unistd.h>
-#include <sys/types.h>
+#include <sstream>
+#include <vector>
 #include <object_model.h>
 #include <SensorBean.h>
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <errno.h>
 
 using namespace std;
 
 LoggerPtr SensorProviderZynq::logger;
 IConfig* SensorProviderZynq::config;
 
-uint64_t SensorProviderZynq::mBaseAddress = 0;
-int SensorProviderZynq::mMemoryFd = -1;
-uint8_t* SensorProviderZynq::mMemory = NULL;
-off_t SensorProviderZynq::mMemoryPageOffset = 0;
-
 #define REGISTERSPACE_SIZE			0x1C
 
-#define OFFSET_BUS_UTILIZATION		0x0
-#define OFFSET_DATA_WITH			0x4
-#define OFFSET_STATUS				0x8
-#define OFFSET_SOFT_ERRROR_COUNT	0xC
-#define OFFSET_FRAME_ERRROR_COUNT	0x10
-#define OFFSET_BUS_FREQUENCY		0x14
-#define OFFSET_BUS_WITH				0x18
-
 void * SensorProviderZynq::create(PF_ObjectParams *) {
 	return new SensorProviderZynq();
 }
@@ -71,156 +54,95 @@ int32_t SensorProviderZynq::destroy(void * p) {
 SensorProviderZynq::SensorProviderZynq() :
 	mSensors() {
 
-	mBaseAddress = config->GetInt("Plugins", "auroraMonitorBaseAddress", 0);
-	if (mBaseAddress == 0) {
+	// Comma separated, decimal or 0x prefixed hex
+	vector<uint64_t> addresses;
+	std::stringstream ss(config->GetString("Plugins", "auroraMonitorBaseAddress", ""));
+	string address;
+	while (std::getline(ss, address, ',')) {
+		uint64_t value = strtoull(address.c_str(), NULL, 0);
+		if (value != 0) {
+			addresses.push_back(value);
+		}
+	}
+	if (addresses.empty()) {
 		LOG_ERROR(logger, "Base address of Aurora monitor not configured (Plugins->auroraMonitorBaseAddress)");
 		return;
 	}
 
-	SensorBean* sensor = new SensorBean("Aurora link", TYPE_STR, 82, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
-	sensor->setData((uint32_t)0);
-	sensor->setUpdateCallback(&SensorProviderZynq::updateLink);
-	mSensors["Aurora link"] = sensor;
-
-	sensor = new SensorBean("Aurora util.", TYPE_U8, 1, 1, UNIT_PERCENT, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
-	sensor->setData((uint32_t)0);
-	sensor->setUpdateCallback(&SensorProviderZynq::updateUtilization);
-	mSensors["Aurora util."] = sensor;
-
-	sensor = new SensorBean("Aurora frame err.", TYPE_U32, 4, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
-	sensor->setData((uint32_t)0);
-	sensor->setUpdateCallback(&SensorProviderZynq::updateFrameErr);
-	mSensors["Aurora frame err."] = sensor;
-
-	sensor = new SensorBean("Aurora soft err.", TYPE_U32, 4, 1, UNIT_DIMENSIONLESS, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
-	sensor->setData((uint32_t)0);
-	sensor->setUpdateCallback(&SensorProviderZynq::updateSoftErr);
-	mSensors["Aurora soft err."] = sensor;
-
-	if (mMemory == NULL) {
-		mapMemory();
-	}
-	if (mMemory != NULL) {
-		sensor = new SensorBean("Aurora bandw.", TYPE_U32, 1, 1, UNIT_BYTE_SECOND, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
-		uint32_t bus_frequency = *(uint32_t*)(mMemory + mMemoryPageOffset + OFFSET_BUS_FREQUENCY);
-		uint32_t bus_width = *(uint32_t*)(mMemory + mMemoryPageOffset + OFFSET_BUS_WITH);
-		LOG_INFO(logger, "Aurora is " << bus_width << " bits wide @ " << bus_frequency << " Hz");
-		sensor->setData((uint64_t)bus_frequency * (uint64_t)bus_width / 8); // /8 because of byte/s, not bit/s
-		mSensors["Aurora bandw."] = sensor;
+	for (size_t i = 0; i < addresses.size(); ++i) {
+		std::stringstream prefix;
+		prefix << "Aurora";
+		// Keep the single monitor names unchanged
+		if (addresses.size() > 1) {
+			prefix << " " << (i + 1);
+		}
+		AuroraMonitor* monitor = new AuroraMonitor(new DevMemMapping(addresses[i], REGISTERSPACE_SIZE));
+		addMonitor(monitor, prefix.str());
+		monitor->release();
 	}
 }
 
 SensorProviderZynq::~SensorProviderZynq() {
-	if (mMemoryFd > 0) {
-		close(mMemoryFd);
-		mMemoryFd = -1;
-	}
 }
 
 map<string, ISensor*> SensorProviderZynq::getSensors(void) {
 	return mSensors;
 }
 
-void SensorProviderZynq::updateLink(SensorBean* sensor) {
-	if (mMemory == NULL) {
-		mapMemory();
-	}
-	if (mMemory != NULL) {
-		//LOG_DEBUG(logger, "Reading address " << hex << ((uint32_t*)(mMemory + mMemoryPageOffset + OFFSET_STATUS)));
-		uint32_t status = *(uint32_t*)(mMemory + mMemoryPageOffset + OFFSET_STATUS);
-		//LOG_DEBUG(logger, "Got value 0x" << hex << status);
-
-		std::stringstream ss;
-		uint8_t channel = (status & 0x20) >> 5;
-		if (channel == 1) {
-			ss << "Channel up";
-		} else {
-			uint8_t lanes_avail = (status & 0xff000000) >> 24;
-			uint8_t lanes = (status & 0xff0000) >> 16;
-			if (lanes == lanes_avail) {
-				ss << "Channel down (all lanes up)";
-			} else if (lanes == 0x0) {
-				ss << "Channel down (all lanes down)";
-			} else {
-				ss << "Channel down (lanes "; // 20 + 19 + 4 = 43 characters max.
-				uint8_t first = 1;
-				for (uint8_t i = 0; i < 8; ++i) {
-					if ((lanes_avail & (1 << i)) && (lanes & (1 << i))) {
-						if (!first) {
-							ss << ", ";
-						}
-						ss << (i + 1);
-						first = 0;
-					}
-				}
-				ss << " up)";
-			}
-		}
-		uint8_t hard_err = (status & 0x10) >> 4;
-		if (hard_err) {
-			ss << ", HardErr"; // 9 characters max.
-		}
-		uint8_t pll_not_locked = (status & 0x8) >> 3;
-		if (pll_not_locked) {
-			ss << ", PLL not locked"; // 16 characters max.
-		}
-		ss << " (0x" << hex << status << ")"; // 5 + 8 = 13 characters max.
-		sensor->setData(ss.str());
-	}
-}
-
-void SensorProviderZynq::updateUtilization(SensorBean* sensor) {
-	if (mMemory == NULL) {
-		mapMemory();
-	}
-	if (mMemory != NULL) {
-		uint32_t bus_utilization = *(uint32_t*)(mMemory + mMemoryPageOffset + OFFSET_BUS_UTILIZATION);
-		uint32_t data_width = *(uint32_t*)(mMemory + mMemoryPageOffset + OFFSET_DATA_WITH);
-
-		double utilization = (double)bus_utilization / (double)(1 << data_width);
-		sensor->setData((uint32_t)(utilization * 100.0));
+void SensorProviderZynq::addMonitor(AuroraMonitor* monitor, const string& prefix) {
+	addAuroraSensor(monitor, prefix + " link", TYPE_STR, 82, UNIT_DIMENSIONLESS, AURORA_LINK);
+	addAuroraSensor(monitor, prefix + " util.", TYPE_U8, 1, UNIT_PERCENT, AURORA_UTILIZATION);
+	addAuroraSensor(monitor, prefix + " frame err.", TYPE_U32, 4, UNIT_DIMENSIONLESS, AURORA_FRAME_ERR);
+	addAuroraSensor(monitor, prefix + " soft err.", TYPE_U32, 4, UNIT_DIMENSIONLESS, AURORA_SOFT_ERR);
+
+	// Bandwidth is fixed by the hardware, only read once
+	uint32_t generation = 0;
+	if (monitor->update(generation)) {
+		LOG_INFO(logger, prefix << " is " << monitor->getRegister(AuroraMonitor::BUS_WIDTH) << " bits wide @ " << monitor->getRegister(AuroraMonitor::BUS_FREQUENCY) << " Hz");
+		SensorBean* sensor = new SensorBean(prefix + " bandw.", TYPE_U32, 4, 1, UNIT_BYTE_SECOND, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+		sensor->setData((uint32_t)monitor->getBandwidth());
+		mSensors[prefix + " bandw."] = sensor;
 	}
 }
 
-void SensorProviderZynq::updateFrameErr(SensorBean* sensor) {
-	if (mMemory == NULL) {
-		mapMemory();
-	}
-	if (mMemory != NULL) {
-		uint32_t frame_err = *(uint32_t*)(mMemory + mMemoryPageOffset + OFFSET_FRAME_ERRROR_COUNT);
+void SensorProviderZynq::addAuroraSensor(AuroraMonitor* monitor, const string& name, ISensorDataType dataType, size_t maxDataSize, ISensorUnit unit, AuroraKind kind) {
+	AuroraSensor* tag = new AuroraSensor();
+	tag->monitor = monitor;
+	tag->kind = kind;
+	tag->generation = 0;
+	monitor->acquire();
 
-		sensor->setData((uint32_t)frame_err);
-	}
+	SensorBean* sensor = new SensorBean(name, dataType, maxDataSize, 1, unit, false, false, 0, 0, 0, 0, "", RENDERING_TEXTUAL);
+	sensor->setData((uint32_t)0);
+	sensor->mTag = tag;
+	sensor->setUpdateCallback(&SensorProviderZynq::updateAuroraSensor);
+	sensor->setDestroyCallback(&SensorProviderZynq::destroyAuroraSensor);
+	mSensors[name] = sensor;
 }
 
-void SensorProviderZynq::updateSoftErr(SensorBean* sensor) {
-	if (mMemory == NULL) {
-		mapMemory();
+void SensorProviderZynq::updateAuroraSensor(SensorBean* sensor) {
+	AuroraSensor* tag = static_cast<AuroraSensor*>(sensor->mTag);
+	if (!tag->monitor->update(tag->generation)) {
+		return;
 	}
-	if (mMemory != NULL) {
-		uint32_t soft_err = *(uint32_t*)(mMemory + mMemoryPageOffset + OFFSET_SOFT_ERRROR_COUNT);
-
-		sensor->setData((uint32_t)soft_err);
+	switch (tag->kind) {
+		case AURORA_LINK:
+			sensor->setData(tag->monitor->getLinkStatus());
+			break;
+		case AURORA_UTILIZATION:
+			sensor->setData(tag->monitor->getUtilization());
+			break;
+		case AURORA_FRAME_ERR:
+			sensor->setData(tag->monitor->getRegister(AuroraMonitor::FRAME_ERROR_COUNT));
+			break;
+		case AURORA_SOFT_ERR:
+			sensor->setData(tag->monitor->getRegister(AuroraMonitor::SOFT_ERROR_COUNT));
+			break;
 	}
 }
 
-void SensorProviderZynq::mapMemory() {
-    // Truncate offset to a multiple of the page size, or mmap will fail.
-    size_t pagesize = sysconf(_SC_PAGE_SIZE);
-    off_t page_base = (mBaseAddress / pagesize) * pagesize;
-    mMemoryPageOffset = mBaseAddress - page_base;
-
-    mMemoryFd = open("/dev/mem", O_SYNC);
-    if (mMemoryFd < 0) {
-    	LOG_ERROR(logger, "Could not open /dev/mem: Error " << errno);
-    	mMemoryFd = -1;
-    	return;
-    }
-	//LOG_DEBUG(logger, "Mapping 0x" << hex << (mMemoryPageOffset + DATA_2_RO_SIZE) << " bytes from page 0x" << hex << page_base << " to read address 0x" << hex << offset );
-    mMemory = (uint8_t*)mmap(NULL, mMemoryPageOffset + REGISTERSPACE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE, mMemoryFd, page_base);
-	//LOG_DEBUG(logger, "Memory mapped to 0x" << hex << mMemory);
-    if (mMemory == MAP_FAILED) {
-    	LOG_ERROR(logger, "Could not mmap memory address 0x" << hex << mBaseAddress << " (page 0x" << hex << page_base << "): Error " << errno);
-        mMemory = NULL;
-    }
+void SensorProviderZynq::destroyAuroraSensor(SensorBean* sensor) {
+	AuroraSensor* tag = static_cast<AuroraSensor*>(sensor->mTag);
+	tag->monitor->release();
+	delete tag;
 }
@@ -34,6 +34,7 @@
 #include <IConfig.h>
 
 struct PF_ObjectParams;
+class AuroraMonitor;
 
 class SensorProviderZynq: public ISensorProvider {
 public:
@@ -49,19 +50,21 @@ public:
 	static LoggerPtr logger;
 	static IConfig* config;
 private:
+	enum AuroraKind { AURORA_LINK, AURORA_UTILIZATION, AURORA_FRAME_ERR, AURORA_SOFT_ERR };
+
+	struct AuroraSensor {
+		AuroraMonitor* monitor;
+		AuroraKind kind;
+		uint32_t generation;
+	};
+
 	SensorProviderZynq();
-	static void mapMemory();
-	static void updateLink(SensorBean* sensor);
-	static void updateUtilization(SensorBean* sensor);
-	static void updateFrameErr(SensorBean* sensor);
-	static void updateSoftErr(SensorBean* sensor);
+	void addMonitor(AuroraMonitor* monitor, const std::string& prefix);
+	void addAuroraSensor(AuroraMonitor* monitor, const std::string& name, ISensorDataType dataType, size_t maxDataSize, ISensorUnit unit, AuroraKind kind);
+	static void updateAuroraSensor(SensorBean* sensor);
+	static void destroyAuroraSensor(SensorBean* sensor);
 
 	std::map<std::string, ISensor*> mSensors;
-
-	static uint64_t mBaseAddress;
-	static int mMemoryFd;
-	static uint8_t* mMemory;
-	static off_t mMemoryPageOffset;
 };
 
 #endif
@@ -36,8 +36,14 @@
 #include <sys/signal.h>
 #endif
 #include <sys/types.h>
+#include <sys/time.h>
+#include <time.h>
 
-#define TIMEOUT_US	100000
+#define TIMEOUT_US			100000
+#define RESPONSE_TIMEOUT_MS	1000
+
+#define FRAME_MARKER		0xA5
+#define FRAME_HEADER_LENGTH	3
 
 using namespace std;
 
@@ -55,7 +61,16 @@ int32_t SensorProviderZynqModule::destroy(void * p) {
 	return 0;
 }
 
-SensorProviderZynqModule::SensorProviderZynqModule() {
+static uint64_t nowMs(void) {
+	// Monotonic, wall clock steps must not fire or stall the request timeouts
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+SensorProviderZynqModule::SensorProviderZynqModule() :
+	mBinary(false), mRecordSize(0), mReceived(0), mParsed(0), mLatestSeq(0), mReturnedSeq(0), mRequestInterval(100), mThreadStarted(false), mRunning(false) {
+	pthread_mutex_init(&mMutex, NULL);
 #ifndef WIN32
 	mComFileDescriptor = -1;
 	mOldComSettings.c_cflag = 0;
@@ -70,10 +85,17 @@ SensorProviderZynqModule::SensorProviderZynqModule() {
 		LOG_ERROR(logger, "No serial port configured (Plugins->zynqSerialPort)");
 		return;
 	}
+	mRequestInterval = config->GetInt("Plugins", "zynqRequestInterval", 100);
+	mBinary = config->GetBoolean("Plugins", "zynqBinaryMode", false);
 	InitComPort(comPort);
 }
 
 SensorProviderZynqModule::~SensorProviderZynqModule() {
+	if (mThreadStarted) {
+		mRunning = false;
+		pthread_join(mThread, NULL);
+	}
+	pthread_mutex_destroy(&mMutex);
 #ifndef WIN32
 	if (mComFileDescriptor >= 0) {
 		tcsetattr(mComFileDescriptor, TCSANOW, &mOldComSettings); // Restore old com port settings
@@ -188,7 +210,6 @@ void SensorProviderZynqModule::SendData(uint8_t* data, size_t size) {
 ssize_t SensorProviderZynqModule::ReadData(uint8_t* data, size_t maxSize) {
 #ifndef WIN32
 	fd_set setRead;
-	int notused = 63;
 	int cnt;
 
 	FD_ZERO(&setRead);
@@ -197,7 +218,7 @@ ssize_t SensorProviderZynqModule::ReadData(uint8_t* data, size_t maxSize) {
     struct timeval timeout;
     timeout.tv_usec = TIMEOUT_US;
     timeout.tv_sec  = 0;
-    cnt = select(notused, &setRead, NULL, NULL, &timeout);
+    cnt = select(mComFileDescriptor + 1, &setRead, NULL, NULL, &timeout);
     if (cnt > 0) {
         if (FD_ISSET(mComFileDescriptor, &setRead)) {
         	int res = read(mComFileDescriptor, (void*)data, maxSize);
@@ -245,6 +266,10 @@ size_t SensorProviderZynqModule::ReadUntilTerminator(uint8_t* data, size_t maxSi
 }
 
 const char* SensorProviderZynqModule::getSensorsDescription(void) {
+	if (mThreadStarted) {
+		// Serial line is owned by the I/O thread now
+		return mDescription.c_str();
+	}
 	uint8_t data[] = { 'd', '\r' };
 	SendData(data, sizeof(data));
 
@@ -265,7 +290,13 @@ const char* SensorProviderZynqModule::getSensorsDescription(void) {
 		} else {
 			LOG_WARN(logger, "Could not find terminator");
 		}
-		return start;
+		mDescription = start;
+		if (mBinary && !probeBinaryMode()) {
+			LOG_WARN(logger, "Module does not answer binary requests, using JSON");
+			mBinary = false;
+		}
+		startIoThread();
+		return mDescription.c_str();
 	}
 	return "";
 /*
@@ -296,29 +327,187 @@ const char* SensorProviderZynqModule::getSensorsDescription(void) {
 }
 
 const char* SensorProviderZynqModule::getSensorsData(void) {
-	uint8_t data[] = { 'm', '\r' };
+	pthread_mutex_lock(&mMutex);
+	if (mLatestSeq == mReturnedSeq || mBinary) {
+		// No new response, JSONSensorsParser keeps the last values
+		pthread_mutex_unlock(&mMutex);
+		return "";
+	}
+	mData = mLatestText;
+	mReturnedSeq = mLatestSeq;
+	pthread_mutex_unlock(&mMutex);
+	return mData.c_str();
+
+//	return "[ 1.0, 1.1, 1.5 ]";
+}
+
+size_t SensorProviderZynqModule::getRecordSize(void) {
+	return mBinary ? mRecordSize : 0;
+}
+
+uint64_t SensorProviderZynqModule::readLatest(uint8_t* buffer) {
+	pthread_mutex_lock(&mMutex);
+	uint64_t seq = mLatestSeq;
+	if (seq != 0) {
+		memcpy(buffer, &mLatestRecord[0], mRecordSize);
+	}
+	pthread_mutex_unlock(&mMutex);
+	return seq;
+}
+
+bool SensorProviderZynqModule::probeBinaryMode(void) {
+	// The size of the first frame defines the record size
+	sendRequest();
+	uint64_t start = nowMs();
+	while (nowMs() - start < RESPONSE_TIMEOUT_MS) {
+		if (receiveResponse()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void SensorProviderZynqModule::startIoThread(void) {
+#ifndef WIN32
+	if (mComFileDescriptor < 0) {
+		return;
+	}
+#else
+	if (INVALID_HANDLE_VALUE == mComFileDescriptor) {
+		return;
+	}
+#endif
+	mRunning = true;
+	if (pthread_create(&mThread, NULL, &SensorProviderZynqModule::ioThread, this) != 0) {
+		LOG_ERROR(logger, "Could not start serial I/O thread");
+		mRunning = false;
+		return;
+	}
+	mThreadStarted = true;
+}
+
+void* SensorProviderZynqModule::ioThread(void* arg) {
+	static_cast<SensorProviderZynqModule*>(arg)->ioLoop();
+	return NULL;
+}
+
+void SensorProviderZynqModule::ioLoop(void) {
+	// One request is always in flight, the next one is sent as soon as the
+	// response is complete, but not before the request interval elapsed
+	bool inFlight = false;
+	bool timeoutLogged = false;
+	uint64_t requestTime = 0;
+	while (mRunning) {
+		uint64_t now = nowMs();
+		if (!inFlight) {
+			if (now - requestTime < mRequestInterval) {
+				uint64_t wait = (mRequestInterval - (now - requestTime)) * 1000;
+				usleep(wait < TIMEOUT_US ? wait : TIMEOUT_US);
+				continue;
+			}
+			sendRequest();
+			requestTime = now;
+			inFlight = true;
+		}
+		if (receiveResponse()) {
+			inFlight = false;
+			timeoutLogged = false;
+		} else if (nowMs() - requestTime > RESPONSE_TIMEOUT_MS) {
+			if (!timeoutLogged) {
+				LOG_WARN(logger, "No response from module within " << RESPONSE_TIMEOUT_MS << " ms, retrying");
+				timeoutLogged = true;
+			}
+			inFlight = false;
+		}
+	}
+}
+
+void SensorProviderZynqModule::sendRequest(void) {
+	uint8_t data[] = { (uint8_t)(mBinary ? 'b' : 'm'), '\r' };
+	mReceived = 0;
+	mParsed = 0;
 	SendData(data, sizeof(data));
+}
 
-	ssize_t read = ReadUntilTerminator(mReceiveBuffer, MAX_RECEIVE_SIZE, '\n', 20);
-	if (read > 0) {
-		mReceiveBuffer[read] = '\0'; // Zero-terminate string
-		char* start = strstr((char*)mReceiveBuffer, "m\r\n");
-		if (start == NULL) {
-			start = (char*)mReceiveBuffer;
-			LOG_WARN(logger, "Could not find expected echo");
-		} else {
-			start += 3; // Skip echo
+bool SensorProviderZynqModule::receiveResponse(void) {
+	if (mReceived >= MAX_RECEIVE_SIZE) {
+		// Garbage or a response too large, drop it and wait for the next
+		LOG_WARN(logger, "Response exceeds " << MAX_RECEIVE_SIZE << " bytes, discarding");
+		mReceived = 0;
+		mParsed = 0;
+	}
+	ssize_t read = ReadData(&mReceiveBuffer[mReceived], MAX_RECEIVE_SIZE - mReceived);
+	if (read <= 0) {
+		return false;
+	}
+	mReceived += read;
+	return mBinary ? parseBinary() : parseText();
+}
+
+bool SensorProviderZynqModule::parseText(void) {
+	// Complete lines only, mParsed is the start of the first unparsed one
+	while (mParsed < mReceived) {
+		uint8_t* start = &mReceiveBuffer[mParsed];
+		uint8_t* end = (uint8_t*)memchr(start, '\n', mReceived - mParsed);
+		if (end == NULL) {
+			return false;
 		}
-		// Chop off after newline
-		char* ptr;
-		if( (ptr = strchr(start, '\r')) != NULL) {
-		    *ptr = '\0';
-		} else {
-			LOG_WARN(logger, "Could not find terminator");
+		mParsed = end - mReceiveBuffer + 1;
+		size_t length = end - start;
+		if (length > 0 && start[length - 1] == '\r') {
+			length--;
 		}
-		return start;
+		// Skip the echo of the request and empty lines
+		if (length == 0 || (length == 1 && start[0] == 'm')) {
+			continue;
+		}
+		pthread_mutex_lock(&mMutex);
+		mLatestText.assign((const char*)start, length);
+		mLatestSeq++;
+		pthread_mutex_unlock(&mMutex);
+		return true;
 	}
-	return "";
+	return false;
+}
 
-//	return "[ 1.0, 1.1, 1.5 ]";
+bool SensorProviderZynqModule::parseBinary(void) {
+	while (mParsed < mReceived) {
+		uint8_t* start = (uint8_t*)memchr(&mReceiveBuffer[mParsed], FRAME_MARKER, mReceived - mParsed);
+		if (start == NULL) {
+			mParsed = mReceived;
+			return false;
+		}
+		mParsed = start - mReceiveBuffer;
+		if (mReceived - mParsed < FRAME_HEADER_LENGTH) {
+			return false;
+		}
+		size_t length = ((size_t)start[1] << 8) | start[2];
+		if (mParsed + FRAME_HEADER_LENGTH + length + 1 > MAX_RECEIVE_SIZE) {
+			// Cannot be a frame, resynchronize behind the marker
+			mParsed++;
+			continue;
+		}
+		if (mReceived - mParsed < FRAME_HEADER_LENGTH + length + 1) {
+			return false;
+		}
+		uint8_t checksum = 0;
+		for (size_t i = 0; i < length; ++i) {
+			checksum ^= start[FRAME_HEADER_LENGTH + i];
+		}
+		if (length == 0 || checksum != start[FRAME_HEADER_LENGTH + length] || (mRecordSize != 0 && length != mRecordSize)) {
+			mParsed++;
+			continue;
+		}
+		mParsed += FRAME_HEADER_LENGTH + length + 1;
+		pthread_mutex_lock(&mMutex);
+		if (mRecordSize == 0) {
+			mRecordSize = length;
+			mLatestRecord.resize(length);
+		}
+		memcpy(&mLatestRecord[0], &start[FRAME_HEADER_LENGTH], length);
+		mLatestSeq++;
+		pthread_mutex_unlock(&mMutex);
+		return true;
+	}
+	return false;
 }
@@ -26,7 +26,10 @@
 #define SENSORPROVIDERZYNQMODULE_H
 
 #include <object_model.h>
+#include <RawSensorProvider.h>
 #include <string>
+#include <vector>
+#include <pthread.h>
 #include <logger.h>
 #include <c_object_model.h>
 #include <IConfig.h>
@@ -41,7 +44,16 @@
 
 struct PF_ObjectParams;
 
-class SensorProviderZynqModule: public IJSONSensorProvider {
+// Sensors of a module attached by serial line. After the description was
+// read, a dedicated I/O thread keeps requesting values and parses the
+// responses into a latest-value buffer, so fetching data never waits for
+// the module.
+//
+// Requests are 'm\r' (JSON array of values, terminated by \r\n) or, with
+// zynqBinaryMode=true and firmware support, 'b\r' answered by a frame:
+// 0xA5 | payload length u16 big endian | payload | XOR of payload bytes
+// The payload holds the values in message encoding in description order.
+class SensorProviderZynqModule: public RawSensorProvider {
 public:
 
 	// static plugin interface
@@ -53,17 +65,33 @@ public:
 	virtual const char* getSensorsDescription(void);
 	virtual const char* getSensorsData(void);
 
+	// RawSensorProvider methods, record size is 0 unless binary mode is active
+	virtual size_t getRecordSize(void);
+	virtual uint64_t readLatest(uint8_t* buffer);
+
 	static LoggerPtr logger;
 	static IConfig* config;
 
 private:
 	SensorProviderZynqModule();
+	//lint -e(1704)
+	SensorProviderZynqModule(const SensorProviderZynqModule& cSource);
+	SensorProviderZynqModule& operator=(const SensorProviderZynqModule& cSource);
 
 	bool InitComPort(std::string device);
 	void SendData(uint8_t* data, size_t size);
 	ssize_t ReadData(uint8_t* data, size_t maxSize);
 	size_t ReadUntilTerminator(uint8_t* data, size_t maxSize, uint8_t terminator, uint8_t ignoreFirstBytes);
 
+	bool probeBinaryMode(void);
+	void startIoThread(void);
+	static void* ioThread(void* arg);
+	void ioLoop(void);
+	void sendRequest(void);
+	bool receiveResponse(void);
+	bool parseText(void);
+	bool parseBinary(void);
+
 #ifdef WIN32
 	HANDLE mComFileDescriptor;
 #else
@@ -71,6 +99,26 @@ private:
 	struct termios mOldComSettings;
 #endif
 	uint8_t mReceiveBuffer[MAX_RECEIVE_SIZE];
+	std::string mDescription;
+
+	// Owned by the I/O thread: response being received
+	bool mBinary;
+	size_t mRecordSize;
+	size_t mReceived;
+	size_t mParsed;
+
+	// Last complete response, guarded by mMutex
+	pthread_mutex_t mMutex;
+	std::string mLatestText;
+	std::vector<uint8_t> mLatestRecord;
+	uint64_t mLatestSeq;
+
+	std::string mData; // Returned by getSensorsData
+	uint64_t mReturnedSeq;
+	uint32_t mRequestInterval; // ms
+	pthread_t mThread;
+	bool mThreadStarted;
+	volatile bool mRunning;
 };
 
 #endif